@@ -0,0 +1,825 @@
+/*
+ * File:   cache.c
+ * Author: Nathan Hernandez,
+ *         Alyssa Tyler
+ *
+ * LoginID: hernandeznp,
+ *          tylerae
+ *
+ * Cache core. See cache.h.
+ */
+
+/**
+ * Includes
+ */
+#include "cache.h"
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+#if defined(__AVX2__) || defined(__SSE4_1__)
+#include <immintrin.h>
+#endif
+
+/**
+ * Policy names indexed by cachePolicy_t.
+ */
+static const char *policyNames[CACHE_POLICIES] = {
+    [CACHE_LRU] = "lru",
+    [CACHE_FIFO] = "fifo",
+    [CACHE_RANDOM] = "random",
+    [CACHE_PLRU] = "plru",
+    [CACHE_SRRIP] = "srrip",
+    [CACHE_BRRIP] = "brrip",
+    [CACHE_LFU] = "lfu"
+};
+
+/**
+ * Index function names indexed by cacheIndex_t.
+ */
+static const char *indexNames[CACHE_INDEXES] = {
+    [CACHE_INDEX_MODULO] = "modulo",
+    [CACHE_INDEX_XOR] = "xor",
+    [CACHE_INDEX_PRIME] = "prime",
+    [CACHE_INDEX_SLICE] = "slice"
+};
+
+/**
+ * Allocates the tag store of a cache.
+ * <p>
+ * The tag and metadata arrays are allocated as single 32-byte aligned
+ * blocks and every set is padded to a multiple of CACHE_WAY_STRIDE ways.
+ */
+bool cacheCreate(Cache *cache, uint8_t setBits, uint8_t associativity,
+        uint8_t blockBits, cachePolicy_t policy) {
+    size_t lines;
+    uint32_t set;
+
+    if (associativity < 1 || associativity > CACHE_MAX_WAYS
+            || setBits > CACHE_MAX_SET_BITS || setBits + blockBits >= 64
+            || policy >= CACHE_POLICIES)
+        return false;
+
+    cache->policy = policy;
+    cache->index = CACHE_INDEX_MODULO;
+    cache->associativity = associativity;
+    cache->ways = (associativity + CACHE_WAY_STRIDE - 1)
+            / CACHE_WAY_STRIDE * CACHE_WAY_STRIDE;
+    cache->blockBits = blockBits;
+    cache->blockSize = 1u << blockBits;
+    cache->setBits = setBits;
+    cache->setSize = 1u << setBits;
+    cache->tagShift = setBits;
+    cache->sliceBits = 0;
+    cache->prime = 0;
+    cache->clock = 0;
+    cache->hits = 0;
+    cache->misses = 0;
+    cache->evictions = 0;
+    cache->victim = 0;
+    cache->writeBack = true;
+    cache->writeAllocate = true;
+    cache->fills = 0;
+    cache->writebacks = 0;
+    cache->writeBytes = 0;
+    cache->tags = NULL;
+    cache->meta = NULL;
+    cache->valid = NULL;
+    cache->dirty = NULL;
+    cache->setMeta = NULL;
+
+    lines = (size_t) cache->setSize * cache->ways;
+    if (posix_memalign((void **) &cache->tags, 32, lines * sizeof(uint64_t))
+            || posix_memalign((void **) &cache->meta, 32,
+                    lines * sizeof(uint64_t))
+            || !(cache->valid = calloc(cache->setSize, sizeof(uint16_t)))
+            || !(cache->dirty = calloc(cache->setSize, sizeof(uint16_t)))
+            || !(cache->setMeta = calloc(cache->setSize, sizeof(uint64_t)))) {
+        freeCacheTags(cache);
+        return false;
+    }
+    memset(cache->tags, 0, lines * sizeof(uint64_t));
+    memset(cache->meta, 0, lines * sizeof(uint64_t));
+    if (policy == CACHE_RANDOM || policy == CACHE_BRRIP)
+        for (set = 0; set < cache->setSize; set++)
+            cache->setMeta[set] = (set + 1) * 0x9e3779b97f4a7c15ull;
+    return true;
+}
+
+/**
+ * Looks up a replacement policy by name.
+ */
+cachePolicy_t cachePolicyByName(const char *name) {
+    cachePolicy_t policy;
+
+    for (policy = 0; policy < CACHE_POLICIES; policy++)
+        if (strcmp(name, policyNames[policy]) == 0)
+            break;
+    return policy;
+}
+
+/**
+ * Sets the write policy from a name.
+ */
+bool cacheSetWritePolicy(Cache *cache, const char *name) {
+    const char *option = strchr(name, ',');
+    size_t length = option ? (size_t) (option - name) : strlen(name);
+
+    if (length == 4 && strncmp(name, "back", 4) == 0)
+        cache->writeBack = true;
+    else if (length == 7 && strncmp(name, "through", 7) == 0)
+        cache->writeBack = false;
+    else
+        return false;
+
+    if (option == NULL || strcmp(option, ",allocate") == 0)
+        cache->writeAllocate = true;
+    else if (strcmp(option, ",noallocate") == 0)
+        cache->writeAllocate = false;
+    else
+        return false;
+    return true;
+}
+
+/**
+ * Returns the largest prime not above limit, or 1 if there is none.
+ */
+static uint32_t cachePrimeBelow(uint32_t limit) {
+    uint32_t candidate, divisor;
+
+    for (candidate = limit; candidate >= 2; candidate--) {
+        for (divisor = 2; (uint64_t) divisor * divisor <= candidate;
+                divisor++)
+            if (candidate % divisor == 0)
+                break;
+        if ((uint64_t) divisor * divisor > candidate)
+            return candidate;
+    }
+    return 1;
+}
+
+/**
+ * Sets the set index function from a name.
+ */
+bool cacheSetIndex(Cache *cache, const char *name) {
+    const char *option = strchr(name, ',');
+    size_t length = option ? (size_t) (option - name) : strlen(name);
+    cacheIndex_t index;
+    uint8_t bits = 0;
+    char *end;
+
+    for (index = 0; index < CACHE_INDEXES; index++)
+        if (strlen(indexNames[index]) == length
+                && strncmp(name, indexNames[index], length) == 0)
+            break;
+    if (index == CACHE_INDEXES || (option != NULL) != (index
+            == CACHE_INDEX_SLICE))
+        return false;
+
+    while (option != NULL) {
+        if (bits == CACHE_MAX_SLICE_BITS || bits == cache->setBits)
+            return false;
+        cache->sliceMasks[bits++] = strtoull(option + 1, &end, 0);
+        if (end == option + 1 || (*end != ',' && *end != '\0'))
+            return false;
+        option = *end ? end : NULL;
+    }
+
+    cache->index = index;
+    cache->sliceBits = bits;
+    cache->prime = index == CACHE_INDEX_PRIME
+            ? cachePrimeBelow(cache->setSize) : 0;
+    cache->tagShift = index == CACHE_INDEX_MODULO ? cache->setBits
+            : index == CACHE_INDEX_SLICE ? cache->setBits - bits : 0;
+    return true;
+}
+
+/**
+ * Returns the set of a block with the index function fixed at compile
+ * time.
+ */
+static inline __attribute__((always_inline)) uint32_t cacheIndexOf(
+        const Cache *cache, uint64_t address, const cacheIndex_t index) {
+    uint64_t block = address >> cache->blockBits;
+    uint32_t set;
+    uint8_t bit;
+
+    switch (index) {
+        case CACHE_INDEX_XOR:
+            return (block ^ block >> cache->setBits) & (cache->setSize - 1);
+        case CACHE_INDEX_PRIME:
+            return block % cache->prime;
+        case CACHE_INDEX_SLICE:
+            set = block & ((1u << cache->tagShift) - 1);
+            for (bit = 0; bit < cache->sliceBits; bit++)
+                set |= (uint32_t) __builtin_parityll(address
+                        & cache->sliceMasks[bit]) << (cache->tagShift + bit);
+            return set;
+        default:
+            return block & (cache->setSize - 1);
+    }
+}
+
+/**
+ * Returns the set that holds the block of address.
+ */
+uint32_t cacheSetOf(const Cache *cache, uint64_t address) {
+    return cacheIndexOf(cache, address, cache->index);
+}
+
+/**
+ * Rebuilds the address of the block a set holds under tag.
+ */
+static inline uint64_t cacheBlockAddress(const Cache *cache, uint32_t set,
+        uint64_t tag) {
+    return (tag << cache->tagShift | (set & ((1ull << cache->tagShift) - 1)))
+            << cache->blockBits;
+}
+
+/**
+ * Prints the traffic to the next level.
+ */
+void cachePrintTraffic(const Cache *cache, FILE *stream) {
+    uint64_t dirty = 0;
+    uint32_t set;
+
+    for (set = 0; set < cache->setSize; set++)
+        dirty += __builtin_popcount(cache->dirty[set] & cache->valid[set]);
+    fprintf(stream, "write-%s %s: read:%" PRIu64 " bytes written:%" PRIu64
+            " bytes fills:%" PRIu64 " writebacks:%" PRIu64 " dirty:%" PRIu64
+            "\n", cache->writeBack ? "back" : "through",
+            cache->writeAllocate ? "allocate" : "no-allocate",
+            cache->fills * cache->blockSize,
+            cache->writebacks * cache->blockSize + cache->writeBytes,
+            cache->fills, cache->writebacks, dirty);
+}
+
+/**
+ * Frees the tag store of a cache.
+ */
+void freeCacheTags(Cache *cache) {
+    free(cache->tags);
+    free(cache->meta);
+    free(cache->valid);
+    free(cache->dirty);
+    free(cache->setMeta);
+    cache->tags = NULL;
+    cache->meta = NULL;
+    cache->valid = NULL;
+    cache->dirty = NULL;
+    cache->setMeta = NULL;
+}
+
+/**
+ * Compares tag against every way of a set.
+ * <p>
+ * Uses AVX2 or SSE4.1 when the compiler targets them and a branch-free
+ * scalar loop otherwise. ways is always a multiple of CACHE_WAY_STRIDE.
+ *
+ * @param tags the first tag of the set
+ * @param ways the padded number of ways
+ * @param tag the tag to look for
+ * @return bitmask of the ways holding tag, valid or not
+ */
+static inline uint32_t cacheMatch(const uint64_t *tags, uint8_t ways,
+        uint64_t tag) {
+    uint32_t mask = 0;
+    uint8_t way;
+#if defined(__AVX2__)
+    __m256i key = _mm256_set1_epi64x((long long) tag);
+    for (way = 0; way < ways; way += 4) {
+        __m256i line = _mm256_load_si256((const __m256i *) (tags + way));
+        __m256i equal = _mm256_cmpeq_epi64(line, key);
+        mask |= (uint32_t) _mm256_movemask_pd(_mm256_castsi256_pd(equal))
+                << way;
+    }
+#elif defined(__SSE4_1__)
+    __m128i key = _mm_set1_epi64x((long long) tag);
+    for (way = 0; way < ways; way += 2) {
+        __m128i line = _mm_load_si128((const __m128i *) (tags + way));
+        __m128i equal = _mm_cmpeq_epi64(line, key);
+        mask |= (uint32_t) _mm_movemask_pd(_mm_castsi128_pd(equal)) << way;
+    }
+#else
+    for (way = 0; way < ways; way++)
+        mask |= (uint32_t) (tags[way] == tag) << way;
+#endif
+    return mask;
+}
+
+/**
+ * Advances a per-set xorshift state.
+ */
+static inline uint64_t cacheRandom(uint64_t *state) {
+    uint64_t x = *state;
+
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    *state = x;
+    return x;
+}
+
+/**
+ * Returns the way with the smallest metadata value.
+ */
+static inline uint32_t cacheMinimum(const uint64_t *meta,
+        uint8_t associativity) {
+    uint32_t victim = 0;
+    uint8_t way;
+
+    for (way = 1; way < associativity; way++)
+        victim = meta[way] < meta[victim] ? way : victim;
+    return victim;
+}
+
+/**
+ * Points the tree-PLRU bits of a set away from way.
+ * <p>
+ * The tree covers the next power of two of the associativity in heap order
+ * (node 1 is the root); a set bit sends the victim search right.
+ */
+static inline void cachePlruTouch(uint64_t *tree, uint8_t associativity,
+        uint32_t way) {
+    uint32_t size = associativity > 1
+            ? 1u << (32 - __builtin_clz(associativity - 1)) : 1;
+    uint32_t node = 1, low = 0, half;
+
+    while (size > 1) {
+        half = size / 2;
+        if (way < low + half) {
+            *tree |= 1ull << node;
+            node = 2 * node;
+        } else {
+            *tree &= ~(1ull << node);
+            node = 2 * node + 1;
+            low += half;
+        }
+        size = half;
+    }
+}
+
+/**
+ * Follows the tree-PLRU bits of a set to a victim, never leaving the ways
+ * that exist.
+ */
+static inline uint32_t cachePlruVictim(uint64_t tree, uint8_t associativity) {
+    uint32_t size = associativity > 1
+            ? 1u << (32 - __builtin_clz(associativity - 1)) : 1;
+    uint32_t node = 1, low = 0, half;
+    bool right;
+
+    while (size > 1) {
+        half = size / 2;
+        right = (tree >> node & 1) && low + half < associativity;
+        node = 2 * node + right;
+        low += right ? half : 0;
+        size = half;
+    }
+    return low;
+}
+
+/**
+ * Updates replacement state for a hit on way.
+ */
+static inline __attribute__((always_inline)) void cachePolicyHit(
+        Cache *cache, uint32_t set, size_t base, uint32_t way,
+        const cachePolicy_t policy) {
+    switch (policy) {
+        case CACHE_LRU:
+            cache->meta[base + way] = ++cache->clock;
+            break;
+        case CACHE_PLRU:
+            cachePlruTouch(&cache->setMeta[set], cache->associativity, way);
+            break;
+        case CACHE_SRRIP:
+        case CACHE_BRRIP:
+            cache->meta[base + way] = 0;
+            break;
+        case CACHE_LFU:
+            cache->meta[base + way]++;
+            break;
+        default:
+            break;
+    }
+}
+
+/**
+ * Initializes replacement state for a line just filled into way.
+ */
+static inline __attribute__((always_inline)) void cachePolicyFill(
+        Cache *cache, uint32_t set, size_t base, uint32_t way,
+        const cachePolicy_t policy) {
+    switch (policy) {
+        case CACHE_LRU:
+        case CACHE_FIFO:
+            cache->meta[base + way] = ++cache->clock;
+            break;
+        case CACHE_PLRU:
+            cachePlruTouch(&cache->setMeta[set], cache->associativity, way);
+            break;
+        case CACHE_SRRIP:
+            cache->meta[base + way] = CACHE_RRPV_MAX - 1;
+            break;
+        case CACHE_BRRIP:
+            cache->meta[base + way] = cacheRandom(&cache->setMeta[set])
+                    % CACHE_BRRIP_EPSILON ? CACHE_RRPV_MAX : CACHE_RRPV_MAX - 1;
+            break;
+        case CACHE_LFU:
+            cache->meta[base + way] = 1;
+            break;
+        default:
+            break;
+    }
+}
+
+/**
+ * Chooses the way to evict from a full set.
+ * <p>
+ * SRRIP/BRRIP age every line until one reaches CACHE_RRPV_MAX and evict the
+ * first such line.
+ */
+static inline __attribute__((always_inline)) uint32_t cachePolicyVictim(
+        Cache *cache, uint32_t set, size_t base, const cachePolicy_t policy) {
+    uint64_t *meta = cache->meta + base;
+    uint64_t oldest;
+    uint32_t way;
+
+    switch (policy) {
+        case CACHE_RANDOM:
+            return cacheRandom(&cache->setMeta[set]) % cache->associativity;
+        case CACHE_PLRU:
+            return cachePlruVictim(cache->setMeta[set], cache->associativity);
+        case CACHE_SRRIP:
+        case CACHE_BRRIP:
+            oldest = 0;
+            for (way = 0; way < cache->associativity; way++)
+                oldest = meta[way] > oldest ? meta[way] : oldest;
+            for (way = 0; way < cache->associativity; way++)
+                meta[way] += CACHE_RRPV_MAX - oldest;
+            for (way = 0; meta[way] != CACHE_RRPV_MAX; way++)
+                ;
+            return way;
+        default:
+            return cacheMinimum(meta, cache->associativity);
+    }
+}
+
+/**
+ * Performs one access to the cache with the replacement policy and index
+ * function fixed at compile time, so every specialization inlines only its
+ * own.
+ * <p>
+ * Reads always allocate. Writes mark the line dirty under write-back and
+ * send size bytes on under write-through; a write miss without
+ * write-allocate only sends the bytes on.
+ */
+static inline __attribute__((always_inline)) cacheResult_t cacheAccessPolicy(
+        Cache *cache, uint64_t address, uint8_t size,
+        const cacheOperation_t operation, const cachePolicy_t policy,
+        const cacheIndex_t index) {
+    uint32_t set = cacheIndexOf(cache, address, index);
+    uint64_t tag = address >> cache->blockBits >> cache->tagShift;
+    size_t base = (size_t) set * cache->ways;
+    uint32_t valid = cache->valid[set];
+    uint32_t full = (1u << cache->associativity) - 1;
+    uint32_t hit = cacheMatch(cache->tags + base, cache->ways, tag) & valid;
+    bool write = operation != CACHE_READ;
+    cacheResult_t result = CACHE_MISS;
+    uint32_t way;
+
+    if (write && !cache->writeBack)
+        cache->writeBytes += size;
+
+    if (hit) {
+        way = __builtin_ctz(hit);
+        cache->hits++;
+        cachePolicyHit(cache, set, base, way, policy);
+        if (write && cache->writeBack)
+            cache->dirty[set] |= 1u << way;
+        return CACHE_HIT;
+    }
+
+    cache->misses++;
+    if (operation == CACHE_WRITE && !cache->writeAllocate) {
+        if (cache->writeBack)
+            cache->writeBytes += size;
+        return CACHE_MISS;
+    }
+    if (valid != full) {
+        way = __builtin_ctz(~valid & full);
+    } else {
+        way = cachePolicyVictim(cache, set, base, policy);
+        cache->evictions++;
+        cache->victim = cacheBlockAddress(cache, set, cache->tags[base + way]);
+        cache->writebacks += cache->dirty[set] >> way & 1;
+        result = CACHE_MISS_EVICTION;
+    }
+    cache->fills++;
+    cache->tags[base + way] = tag;
+    cache->valid[set] = valid | (1u << way);
+    cache->dirty[set] = (cache->dirty[set] & ~(1u << way))
+            | (uint32_t) (write && cache->writeBack) << way;
+    cachePolicyFill(cache, set, base, way, policy);
+    return result;
+}
+
+/**
+ * Defines the access functions and batch loop of one replacement policy
+ * and index function.
+ * <p>
+ * The store half of a modify always hits the line its load just brought in.
+ * Unless the policy updates state on hits that a repeated hit would change
+ * (RRPV reset, LFU use count), the load is done as a CACHE_MODIFY, which
+ * allocates like a load and applies the store, and the store half is
+ * counted as a hit without a second lookup.
+ */
+#define CACHE_SPECIALIZE(name, policy, index) \
+static cacheResult_t cacheAccess_##name(Cache *cache, uint64_t address) { \
+    return cacheAccessPolicy(cache, address, 0, CACHE_READ, policy, index); \
+} \
+static cacheResult_t cacheWrite_##name(Cache *cache, uint64_t address, \
+        uint8_t size, cacheOperation_t operation) { \
+    return cacheAccessPolicy(cache, address, size, operation, policy, \
+            index); \
+} \
+static void cacheSimulateBatch_##name(Cache *cache, const trace_t *batch, \
+        size_t count) { \
+    size_t i; \
+    for (i = 0; i < count; i++) { \
+        switch (batch[i].operation) { \
+            case 'L': \
+                cacheAccessPolicy(cache, batch[i].address, 0, CACHE_READ, \
+                        policy, index); \
+                break; \
+            case 'S': \
+                cacheAccessPolicy(cache, batch[i].address, batch[i].size, \
+                        CACHE_WRITE, policy, index); \
+                break; \
+            case 'M': \
+                if (policy == CACHE_SRRIP || policy == CACHE_BRRIP \
+                        || policy == CACHE_LFU) { \
+                    cacheAccessPolicy(cache, batch[i].address, 0, \
+                            CACHE_READ, policy, index); \
+                    cacheAccessPolicy(cache, batch[i].address, \
+                            batch[i].size, CACHE_MODIFY, policy, index); \
+                } else { \
+                    cacheAccessPolicy(cache, batch[i].address, \
+                            batch[i].size, CACHE_MODIFY, policy, index); \
+                    cache->hits++; \
+                } \
+                break; \
+        } \
+    } \
+}
+
+/**
+ * Specializes every replacement policy for one index function.
+ */
+#define CACHE_SPECIALIZE_INDEX(name, index) \
+CACHE_SPECIALIZE(lru_##name, CACHE_LRU, index) \
+CACHE_SPECIALIZE(fifo_##name, CACHE_FIFO, index) \
+CACHE_SPECIALIZE(random_##name, CACHE_RANDOM, index) \
+CACHE_SPECIALIZE(plru_##name, CACHE_PLRU, index) \
+CACHE_SPECIALIZE(srrip_##name, CACHE_SRRIP, index) \
+CACHE_SPECIALIZE(brrip_##name, CACHE_BRRIP, index) \
+CACHE_SPECIALIZE(lfu_##name, CACHE_LFU, index)
+
+CACHE_SPECIALIZE_INDEX(modulo, CACHE_INDEX_MODULO)
+CACHE_SPECIALIZE_INDEX(xor, CACHE_INDEX_XOR)
+CACHE_SPECIALIZE_INDEX(prime, CACHE_INDEX_PRIME)
+CACHE_SPECIALIZE_INDEX(slice, CACHE_INDEX_SLICE)
+
+/**
+ * Row of specializations of one index function, indexed by cachePolicy_t.
+ */
+#define CACHE_POLICY_ROW(function, name) { \
+    [CACHE_LRU] = function##_lru_##name, \
+    [CACHE_FIFO] = function##_fifo_##name, \
+    [CACHE_RANDOM] = function##_random_##name, \
+    [CACHE_PLRU] = function##_plru_##name, \
+    [CACHE_SRRIP] = function##_srrip_##name, \
+    [CACHE_BRRIP] = function##_brrip_##name, \
+    [CACHE_LFU] = function##_lfu_##name \
+}
+
+/**
+ * Specializations indexed by cacheIndex_t and cachePolicy_t.
+ */
+static cacheResult_t (*const accessFunctions[CACHE_INDEXES][CACHE_POLICIES])(
+        Cache *, uint64_t) = {
+    [CACHE_INDEX_MODULO] = CACHE_POLICY_ROW(cacheAccess, modulo),
+    [CACHE_INDEX_XOR] = CACHE_POLICY_ROW(cacheAccess, xor),
+    [CACHE_INDEX_PRIME] = CACHE_POLICY_ROW(cacheAccess, prime),
+    [CACHE_INDEX_SLICE] = CACHE_POLICY_ROW(cacheAccess, slice)
+};
+
+static cacheResult_t (*const writeFunctions[CACHE_INDEXES][CACHE_POLICIES])(
+        Cache *, uint64_t, uint8_t, cacheOperation_t) = {
+    [CACHE_INDEX_MODULO] = CACHE_POLICY_ROW(cacheWrite, modulo),
+    [CACHE_INDEX_XOR] = CACHE_POLICY_ROW(cacheWrite, xor),
+    [CACHE_INDEX_PRIME] = CACHE_POLICY_ROW(cacheWrite, prime),
+    [CACHE_INDEX_SLICE] = CACHE_POLICY_ROW(cacheWrite, slice)
+};
+
+static void (*const batchFunctions[CACHE_INDEXES][CACHE_POLICIES])(Cache *,
+        const trace_t *, size_t) = {
+    [CACHE_INDEX_MODULO] = CACHE_POLICY_ROW(cacheSimulateBatch, modulo),
+    [CACHE_INDEX_XOR] = CACHE_POLICY_ROW(cacheSimulateBatch, xor),
+    [CACHE_INDEX_PRIME] = CACHE_POLICY_ROW(cacheSimulateBatch, prime),
+    [CACHE_INDEX_SLICE] = CACHE_POLICY_ROW(cacheSimulateBatch, slice)
+};
+
+/**
+ * Performs one access to the cache, updating its counters.
+ */
+cacheResult_t cacheAccess(Cache *cache, uint64_t address) {
+    return accessFunctions[cache->index][cache->policy](cache, address);
+}
+
+/**
+ * Performs one store to the cache under its write policy.
+ */
+cacheResult_t cacheWrite(Cache *cache, uint64_t address, uint8_t size,
+        cacheOperation_t operation) {
+    return writeFunctions[cache->index][cache->policy](cache, address, size,
+            operation);
+}
+
+/**
+ * Simulates a batch of trace records with the loop specialized for the
+ * cache's replacement policy and index function.
+ */
+void cacheSimulateBatch(Cache *cache, const trace_t *batch, size_t count) {
+    batchFunctions[cache->index][cache->policy](cache, batch, count);
+}
+
+/**
+ * Splits address into its set, the first line of the set and its tag.
+ * Unlike the specialized access paths, the index function is picked at
+ * run time here, as the replacement policy is by the callers below.
+ */
+static inline void cacheLocate(Cache *cache, uint64_t address, uint32_t *set,
+        size_t *base, uint64_t *tag) {
+    *set = cacheIndexOf(cache, address, cache->index);
+    *base = (size_t) *set * cache->ways;
+    *tag = address >> cache->blockBits >> cache->tagShift;
+}
+
+/**
+ * Returns the way of a set holding tag, or -1 if there is none.
+ */
+static inline int cacheFind(Cache *cache, uint32_t set, size_t base,
+        uint64_t tag) {
+    uint32_t hit = cacheMatch(cache->tags + base, cache->ways, tag)
+            & cache->valid[set];
+
+    return hit ? __builtin_ctz(hit) : -1;
+}
+
+/**
+ * Looks up the block holding address and, on a hit, updates its replacement
+ * state.
+ */
+bool cacheTouch(Cache *cache, uint64_t address) {
+    uint32_t set;
+    size_t base;
+    uint64_t tag;
+    int way;
+
+    cacheLocate(cache, address, &set, &base, &tag);
+    way = cacheFind(cache, set, base, tag);
+    if (way < 0)
+        return false;
+    cachePolicyHit(cache, set, base, way, cache->policy);
+    return true;
+}
+
+/**
+ * Checks whether the block holding address is present.
+ */
+bool cacheContains(Cache *cache, uint64_t address) {
+    uint32_t set;
+    size_t base;
+    uint64_t tag;
+
+    cacheLocate(cache, address, &set, &base, &tag);
+    return cacheFind(cache, set, base, tag) >= 0;
+}
+
+/**
+ * Fills the block holding address, evicting a line if the set is full.
+ */
+bool cacheInsert(Cache *cache, uint64_t address, bool dirty,
+        uint64_t *victim, bool *victimDirty) {
+    uint32_t set, way;
+    size_t base;
+    uint64_t tag;
+    uint32_t valid, full = (1u << cache->associativity) - 1;
+    bool evicted = false;
+
+    cacheLocate(cache, address, &set, &base, &tag);
+    valid = cache->valid[set];
+    if (valid != full) {
+        way = __builtin_ctz(~valid & full);
+    } else {
+        way = cachePolicyVictim(cache, set, base, cache->policy);
+        *victim = cacheBlockAddress(cache, set, cache->tags[base + way]);
+        *victimDirty = cache->dirty[set] >> way & 1;
+        evicted = true;
+    }
+    cache->tags[base + way] = tag;
+    cache->valid[set] = valid | (1u << way);
+    cache->dirty[set] = (cache->dirty[set] & ~(1u << way))
+            | (uint32_t) dirty << way;
+    cachePolicyFill(cache, set, base, way, cache->policy);
+    return evicted;
+}
+
+/**
+ * Removes the block holding address if it is present.
+ */
+bool cacheInvalidate(Cache *cache, uint64_t address, bool *dirty) {
+    uint32_t set;
+    size_t base;
+    uint64_t tag;
+    int way;
+
+    cacheLocate(cache, address, &set, &base, &tag);
+    way = cacheFind(cache, set, base, tag);
+    if (way < 0)
+        return false;
+    *dirty = cache->dirty[set] >> way & 1;
+    cache->valid[set] &= ~(1u << way);
+    cache->dirty[set] &= ~(1u << way);
+    return true;
+}
+
+/**
+ * Clears the dirty bit of the block holding address if it is present.
+ */
+bool cacheClean(Cache *cache, uint64_t address) {
+    uint32_t set;
+    size_t base;
+    uint64_t tag;
+    int way;
+    bool dirty;
+
+    cacheLocate(cache, address, &set, &base, &tag);
+    way = cacheFind(cache, set, base, tag);
+    if (way < 0)
+        return false;
+    dirty = cache->dirty[set] >> way & 1;
+    cache->dirty[set] &= ~(1u << way);
+    return dirty;
+}
+
+/**
+ * Marks the block holding address dirty if it is present.
+ */
+bool cacheMarkDirty(Cache *cache, uint64_t address) {
+    uint32_t set;
+    size_t base;
+    uint64_t tag;
+    int way;
+
+    cacheLocate(cache, address, &set, &base, &tag);
+    way = cacheFind(cache, set, base, tag);
+    if (way < 0)
+        return false;
+    cache->dirty[set] |= 1u << way;
+    return true;
+}
+
+/**
+ * Loads data from the cache.
+ */
+bool cacheLoad(trace_t *trace, Cache *cache) {
+    if(trace->operation != 'L')
+        return false;
+
+    cacheAccess(cache, trace->address);
+    return true;
+}
+
+/**
+ * Stores data into the cache.
+ */
+bool cacheStore(trace_t *trace, Cache *cache) {
+    if(trace->operation != 'S')
+        return false;
+
+    cacheWrite(cache, trace->address, trace->size, CACHE_WRITE);
+    return true;
+}
+
+/**
+ * Modifies data in the cache: a load followed by a store to the same block.
+ */
+bool cacheModify(trace_t *trace, Cache *cache) {
+    if(trace->operation != 'M')
+        return false;
+
+    cacheAccess(cache, trace->address);
+    cacheWrite(cache, trace->address, trace->size, CACHE_MODIFY);
+    return true;
+}
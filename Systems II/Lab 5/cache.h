@@ -0,0 +1,353 @@
+/*
+ * File:   cache.h
+ * Author: Nathan Hernandez,
+ *         Alyssa Tyler
+ *
+ * LoginID: hernandeznp,
+ *          tylerae
+ *
+ * Cache core. Tags live in one contiguous, aligned array with valid and
+ * replacement metadata kept in parallel arrays so a set lookup is a single
+ * vectorized compare. Every replacement policy gets its own specialized
+ * batch loop.
+ */
+
+#ifndef CACHE_H
+#define CACHE_H
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "trace.h"
+
+/**
+ * Largest supported associativity (one bit per way in the valid mask).
+ */
+#define CACHE_MAX_WAYS 16
+
+/**
+ * Largest number of set index bits; set indices and setSize are uint32_t.
+ */
+#define CACHE_MAX_SET_BITS 31
+
+/**
+ * Ways per set are padded to a multiple of this so lookups never need a
+ * partial vector.
+ */
+#define CACHE_WAY_STRIDE 4
+
+/**
+ * Largest re-reference prediction value of SRRIP/BRRIP (2-bit RRPV).
+ */
+#define CACHE_RRPV_MAX 3
+
+/**
+ * BRRIP inserts at CACHE_RRPV_MAX - 1 once every CACHE_BRRIP_EPSILON fills.
+ */
+#define CACHE_BRRIP_EPSILON 32
+
+/**
+ * Replacement policies.
+ */
+typedef enum cachePolicy_t {
+    CACHE_LRU,
+    CACHE_FIFO,
+    CACHE_RANDOM,
+    CACHE_PLRU,
+    CACHE_SRRIP,
+    CACHE_BRRIP,
+    CACHE_LFU,
+    CACHE_POLICIES
+} cachePolicy_t;
+
+/**
+ * Largest number of slice-hash masks, one per slice index bit.
+ */
+#define CACHE_MAX_SLICE_BITS 8
+
+/**
+ * Set index functions.
+ * <p>
+ * Modulo takes the low setBits bits of the block number. XOR folds the
+ * next setBits bits of the block number into them. Prime takes the block
+ * number modulo the largest prime not above 2^setBits, leaving the sets
+ * past it unused. Slice takes the parity of the byte address under each of
+ * sliceBits masks as the top bits of the set, like the slice hash of a
+ * sliced last-level cache, and the low block bits for the rest.
+ */
+typedef enum cacheIndex_t {
+    CACHE_INDEX_MODULO,
+    CACHE_INDEX_XOR,
+    CACHE_INDEX_PRIME,
+    CACHE_INDEX_SLICE,
+    CACHE_INDEXES
+} cacheIndex_t;
+
+/**
+ * Kinds of access. A modify is the store of an M record: it allocates on a
+ * miss like the load it follows, whatever the write policy.
+ */
+typedef enum cacheOperation_t {
+    CACHE_READ,
+    CACHE_WRITE,
+    CACHE_MODIFY
+} cacheOperation_t;
+
+/**
+ * Result of a single cache access.
+ */
+typedef enum cacheResult_t {
+    CACHE_HIT = 0,
+    CACHE_MISS = 1,
+    CACHE_MISS_EVICTION = 3
+} cacheResult_t;
+
+/**
+ * Cache definition
+ * <p>
+ * Set i occupies tags[i*ways .. i*ways+associativity-1]; meta is indexed the
+ * same way and valid and dirty hold one bitmask of ways per set. setMeta
+ * holds one word per set for policies with per-set state.
+ * <p>
+ * meta is the last use stamp for LRU, the fill stamp for FIFO, the RRPV for
+ * SRRIP/BRRIP and the use count for LFU. setMeta is the tree of tree-PLRU
+ * and the random number state of random and BRRIP, kept per set so sharded
+ * runs replace exactly like single-threaded ones.
+ * <p>
+ * Stores follow writeBack (dirty lines are written back on eviction) or
+ * write-through (every store is sent on), and writeAllocate (a store miss
+ * fills the line) or no-write-allocate (the store goes around the cache).
+ * Traffic to the next level is counted as fills and writebacks of whole
+ * blocks plus writeBytes of write-through and write-around stores.
+ * <p>
+ * victim is the address of the block evicted by the last access that
+ * returned CACHE_MISS_EVICTION.
+ * <p>
+ * index selects the set index function. Tags are the block number shifted
+ * right by tagShift: setBits for modulo, setBits - sliceBits for slice and
+ * 0 for XOR and prime, whose sets do not determine the low block bits.
+ */
+typedef struct Cache{
+    cachePolicy_t policy;
+    cacheIndex_t index;
+    uint8_t associativity;
+    uint8_t ways;
+    uint8_t blockBits;
+    uint32_t blockSize;
+    uint8_t setBits;
+    uint32_t setSize;
+    uint8_t tagShift;
+    uint8_t sliceBits;
+    uint32_t prime;
+    uint64_t sliceMasks[CACHE_MAX_SLICE_BITS];
+    uint64_t * tags;
+    uint64_t * meta;
+    uint16_t * valid;
+    uint16_t * dirty;
+    uint64_t * setMeta;
+    uint64_t clock;
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t evictions;
+    uint64_t victim;
+    bool writeBack;
+    bool writeAllocate;
+    uint64_t fills;
+    uint64_t writebacks;
+    uint64_t writeBytes;
+} Cache;
+
+/**
+ * Allocates the tag store of a cache with 2^setBits sets of associativity
+ * ways and 2^blockBits byte blocks. The cache is write-back and
+ * write-allocate.
+ * <p>
+ * Be sure to call freeCacheTags() to free memory and avoid memory leaks.
+ *
+ * @param cache the cache to initialize
+ * @param setBits number of set index bits (0-CACHE_MAX_SET_BITS)
+ * @param associativity number of lines per set (1-16)
+ * @param blockBits number of block offset bits
+ * @param policy the replacement policy
+ * @return true on success
+ */
+bool cacheCreate(Cache *cache, uint8_t setBits, uint8_t associativity,
+        uint8_t blockBits, cachePolicy_t policy);
+
+/**
+ * Looks up a replacement policy by name ("lru", "fifo", "random", "plru",
+ * "srrip", "brrip" or "lfu").
+ *
+ * @param name the name of the policy
+ * @return the policy, or CACHE_POLICIES if the name is unknown
+ */
+cachePolicy_t cachePolicyByName(const char *name);
+
+/**
+ * Sets the write policy from a name: "back" or "through", optionally
+ * followed by ",allocate" (the default) or ",noallocate".
+ *
+ * @param cache the cache to configure
+ * @param name the write policy
+ * @return true if the name is valid
+ */
+bool cacheSetWritePolicy(Cache *cache, const char *name);
+
+/**
+ * Sets the set index function from a name: "modulo", "xor", "prime", or
+ * "slice" followed by one ",mask" per slice index bit (e.g.
+ * "slice,0x1b5f575440,0x2eb5faa880"). The cache must still be empty.
+ *
+ * @param cache the cache to configure
+ * @param name the index function
+ * @return true if the name is valid for the geometry of the cache
+ */
+bool cacheSetIndex(Cache *cache, const char *name);
+
+/**
+ * Returns the set that holds the block of address.
+ *
+ * @param cache the cache to look in
+ * @param address any byte address of the block
+ * @return the set index
+ */
+uint32_t cacheSetOf(const Cache *cache, uint64_t address);
+
+/**
+ * Prints the traffic to the next level: bytes read by fills, bytes written
+ * by writebacks and stores, and the dirty lines still in the cache.
+ *
+ * @param cache the cache to report on
+ * @param stream the stream to print to
+ */
+void cachePrintTraffic(const Cache *cache, FILE *stream);
+
+/**
+ * Frees the tag store of a cache.
+ *
+ * @param cache the cache to manipulate
+ */
+void freeCacheTags(Cache *cache);
+
+/**
+ * Performs one access to the cache, updating its counters.
+ *
+ * @param cache the cache to access
+ * @param address the byte address being accessed
+ * @return whether the access hit, missed, or missed and evicted
+ */
+cacheResult_t cacheAccess(Cache *cache, uint64_t address);
+
+/**
+ * Performs one store to the cache under its write policy, updating its
+ * counters.
+ *
+ * @param cache the cache to access
+ * @param address the byte address being written
+ * @param size number of bytes written
+ * @param operation CACHE_WRITE, or CACHE_MODIFY for the store of an M
+ * @return whether the access hit, missed, or missed and evicted
+ */
+cacheResult_t cacheWrite(Cache *cache, uint64_t address, uint8_t size,
+        cacheOperation_t operation);
+
+/**
+ * Simulates a batch of trace records. Instruction loads are ignored.
+ *
+ * @param cache the cache to simulate
+ * @param batch the records to simulate
+ * @param count number of records in batch
+ */
+void cacheSimulateBatch(Cache *cache, const trace_t *batch, size_t count);
+
+/**
+ * Looks up the block holding address and, on a hit, updates its replacement
+ * state. Counters are left alone.
+ *
+ * @param cache the cache to look in
+ * @param address any byte address of the block
+ * @return true if the block is present
+ */
+bool cacheTouch(Cache *cache, uint64_t address);
+
+/**
+ * Checks whether the block holding address is present, without updating
+ * its replacement state.
+ *
+ * @param cache the cache to look in
+ * @param address any byte address of the block
+ * @return true if the block is present
+ */
+bool cacheContains(Cache *cache, uint64_t address);
+
+/**
+ * Fills the block holding address, which must not be present, evicting a
+ * line if the set is full. Counters are left alone.
+ *
+ * @param cache the cache to fill
+ * @param address any byte address of the block
+ * @param dirty whether the filled line starts out dirty
+ * @param victim receives the base address of the evicted block
+ * @param victimDirty receives whether the evicted block was dirty
+ * @return true if a valid line was evicted
+ */
+bool cacheInsert(Cache *cache, uint64_t address, bool dirty,
+        uint64_t *victim, bool *victimDirty);
+
+/**
+ * Removes the block holding address if it is present.
+ *
+ * @param cache the cache to invalidate in
+ * @param address any byte address of the block
+ * @param dirty receives whether the removed line was dirty
+ * @return true if the block was present
+ */
+bool cacheInvalidate(Cache *cache, uint64_t address, bool *dirty);
+
+/**
+ * Clears the dirty bit of the block holding address if it is present.
+ *
+ * @param cache the cache to update
+ * @param address any byte address of the block
+ * @return true if the block was present and dirty
+ */
+bool cacheClean(Cache *cache, uint64_t address);
+
+/**
+ * Marks the block holding address dirty if it is present, without updating
+ * its replacement state.
+ *
+ * @param cache the cache to update
+ * @param address any byte address of the block
+ * @return true if the block is present
+ */
+bool cacheMarkDirty(Cache *cache, uint64_t address);
+
+/**
+ * Loads data from the cache.
+ *
+ * @param trace valgrind data to be used
+ * @param cache the cache to load from
+ * @return true on success
+ */
+bool cacheLoad(trace_t *trace, Cache *cache);
+
+/**
+ * Stores data into the cache.
+ *
+ * @param trace valgrind  data to be used
+ * @param cache the cache to store into
+ * @return true on success
+ */
+bool cacheStore(trace_t *trace, Cache *cache);
+
+/**
+ * Modifies data in the cache.
+ *
+ * @param trace valgrind  data to be used
+ * @param cache the cache to modify
+ * @return true on success
+ */
+bool cacheModify(trace_t *trace, Cache *cache);
+
+#endif  /* CACHE_H */
@@ -0,0 +1,296 @@
+/*
+ * File:   checkpoint.c
+ * Author: Nathan Hernandez,
+ *         Alyssa Tyler
+ *
+ * LoginID: hernandeznp,
+ *          tylerae
+ *
+ * Simulation checkpoints. See checkpoint.h.
+ */
+
+/**
+ * Includes
+ */
+#include "checkpoint.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+_Static_assert(sizeof(checkpoint_t) == CHECKPOINT_HEADER_SIZE,
+        "checkpoint_t must match CHECKPOINT_HEADER_SIZE");
+
+/**
+ * Number of arrays in the tag store.
+ */
+#define CHECKPOINT_ARRAYS 5
+
+/**
+ * Parses a checkpoint option.
+ */
+bool checkpointParse(const char *spec, checkpointConfig_t *config) {
+    char *option, *value;
+
+    config->every = CHECKPOINT_EVERY;
+    config->warm = false;
+    if (strlen(spec) >= sizeof(config->path)) {
+        fprintf(stderr, "checkpoint: path too long\n");
+        return false;
+    }
+    strcpy(config->path, spec);
+
+    option = strchr(config->path, ',');
+    if (option != NULL)
+        *option++ = '\0';
+    while (option != NULL && *option != '\0') {
+        value = option;
+        option = strchr(option, ',');
+        if (option != NULL)
+            *option++ = '\0';
+        if (strcmp(value, "warm") == 0) {
+            config->warm = true;
+        } else if (strncmp(value, "every=", 6) == 0) {
+            config->every = strtoull(value + 6, NULL, 0);
+        } else {
+            fprintf(stderr, "checkpoint: bad option %s\n", value);
+            return false;
+        }
+    }
+    if (config->every == 0) {
+        fprintf(stderr, "checkpoint: every must be positive\n");
+        return false;
+    }
+    return config->path[0] != '\0';
+}
+
+/**
+ * Points iov at the arrays of the tag store, in file order.
+ */
+static void checkpointArrays(const Cache *cache, struct iovec *iov) {
+    size_t lines = (size_t) cache->setSize * cache->ways;
+
+    iov[0] = (struct iovec) { cache->tags, lines * sizeof(uint64_t) };
+    iov[1] = (struct iovec) { cache->meta, lines * sizeof(uint64_t) };
+    iov[2] = (struct iovec) { cache->setMeta,
+            cache->setSize * sizeof(uint64_t) };
+    iov[3] = (struct iovec) { cache->valid,
+            cache->setSize * sizeof(uint16_t) };
+    iov[4] = (struct iovec) { cache->dirty,
+            cache->setSize * sizeof(uint16_t) };
+}
+
+/**
+ * Reads or writes every buffer of iov, resuming after short transfers.
+ *
+ * @return true if every byte was transferred
+ */
+static bool checkpointTransfer(int fd, struct iovec *iov, int count,
+        bool write) {
+    ssize_t done;
+
+    while (count > 0) {
+        done = write ? writev(fd, iov, count) : readv(fd, iov, count);
+        if (done < 0 && errno == EINTR)
+            continue;
+        if (done <= 0)
+            return false;
+        for (; count > 0 && (size_t) done >= iov->iov_len; iov++, count--)
+            done -= iov->iov_len;
+        if (count > 0) {
+            iov->iov_base = (char *) iov->iov_base + done;
+            iov->iov_len -= done;
+        }
+    }
+    return true;
+}
+
+/**
+ * Folds length bytes of data into an FNV-1a hash.
+ */
+static uint64_t checkpointHash(uint64_t hash, const char *data,
+        size_t length) {
+    size_t i;
+
+    for (i = 0; i < length; i++)
+        hash = (hash ^ (uint8_t) data[i]) * 0x100000001b3ull;
+    return hash;
+}
+
+/**
+ * Fingerprints a mapped trace: its first and last bytes and the bytes that
+ * end at offset.
+ */
+static uint64_t checkpointFingerprint(const traceReader_t *reader,
+        uint64_t offset) {
+    size_t span = CHECKPOINT_FINGERPRINT_BYTES;
+    uint64_t hash = 0xcbf29ce484222325ull;
+
+    if (reader->data == NULL)
+        return hash;
+    hash = checkpointHash(hash, reader->data,
+            reader->length < span ? reader->length : span);
+    hash = checkpointHash(hash, reader->data + (offset < span
+            ? 0 : offset - span), offset < span ? offset : span);
+    return checkpointHash(hash, reader->data + (reader->length < span
+            ? 0 : reader->length - span),
+            reader->length < span ? reader->length : span);
+}
+
+/**
+ * Writes a checkpoint.
+ */
+bool checkpointSave(const char *path, const Cache *cache,
+        const traceReader_t *reader, uint64_t records) {
+    struct iovec iov[1 + CHECKPOINT_ARRAYS];
+    char temporary[PATH_MAX + 4];
+    checkpoint_t header;
+    bool success;
+    int fd;
+
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, CHECKPOINT_MAGIC, sizeof(header.magic));
+    header.version = CHECKPOINT_VERSION;
+    header.headerSize = CHECKPOINT_HEADER_SIZE;
+    header.policy = cache->policy;
+    header.setBits = cache->setBits;
+    header.associativity = cache->associativity;
+    header.ways = cache->ways;
+    header.blockBits = cache->blockBits;
+    header.packed = reader->packed;
+    header.writeBack = cache->writeBack;
+    header.writeAllocate = cache->writeAllocate;
+    header.clock = cache->clock;
+    header.hits = cache->hits;
+    header.misses = cache->misses;
+    header.evictions = cache->evictions;
+    header.fills = cache->fills;
+    header.writebacks = cache->writebacks;
+    header.writeBytes = cache->writeBytes;
+    header.records = records;
+    header.traceLength = reader->length;
+    header.offset = reader->offset;
+    header.lines = reader->lines;
+    header.blockEnd = reader->blockEnd;
+    header.previous = reader->previous;
+    header.blockRemaining = reader->blockRemaining;
+    header.fingerprint = checkpointFingerprint(reader, reader->offset);
+
+    iov[0] = (struct iovec) { &header, sizeof(header) };
+    checkpointArrays(cache, iov + 1);
+
+    snprintf(temporary, sizeof(temporary), "%s.tmp", path);
+    fd = open(temporary, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        perror("Error creating checkpoint");
+        return false;
+    }
+    success = checkpointTransfer(fd, iov, 1 + CHECKPOINT_ARRAYS, true)
+            && fsync(fd) == 0;
+    success = close(fd) == 0 && success;
+    if (success)
+        success = rename(temporary, path) == 0;
+    if (!success) {
+        perror("Error writing checkpoint");
+        unlink(temporary);
+    }
+    return success;
+}
+
+/**
+ * Reads and validates a checkpoint header.
+ */
+bool checkpointReadHeader(const char *path, checkpoint_t *header) {
+    bool success;
+    int fd = open(path, O_RDONLY);
+
+    if (fd < 0) {
+        perror("Error opening checkpoint");
+        return false;
+    }
+    success = read(fd, header, sizeof(checkpoint_t)) == sizeof(checkpoint_t);
+    close(fd);
+    if (!success || memcmp(header->magic, CHECKPOINT_MAGIC, 8) != 0
+            || header->version != CHECKPOINT_VERSION
+            || header->headerSize != CHECKPOINT_HEADER_SIZE
+            || header->policy >= CACHE_POLICIES) {
+        fprintf(stderr, "%s: not a checkpoint of this version\n", path);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Creates a cache from a checkpoint.
+ */
+bool checkpointLoad(const char *path, Cache *cache, checkpoint_t *header) {
+    struct iovec iov[CHECKPOINT_ARRAYS];
+    struct stat info;
+    size_t lines;
+    bool success;
+    int fd;
+
+    if (!checkpointReadHeader(path, header))
+        return false;
+    if (!cacheCreate(cache, header->setBits, header->associativity,
+            header->blockBits, header->policy)
+            || cache->ways != header->ways) {
+        fprintf(stderr, "%s: unsupported cache geometry\n", path);
+        freeCacheTags(cache);
+        return false;
+    }
+
+    lines = (size_t) cache->setSize * cache->ways;
+    fd = open(path, O_RDONLY);
+    success = fd >= 0 && fstat(fd, &info) == 0
+            && (size_t) info.st_size == CHECKPOINT_HEADER_SIZE
+                    + (2 * lines + cache->setSize) * sizeof(uint64_t)
+                    + 2 * cache->setSize * sizeof(uint16_t)
+            && lseek(fd, CHECKPOINT_HEADER_SIZE, SEEK_SET) >= 0;
+    if (success) {
+        checkpointArrays(cache, iov);
+        success = checkpointTransfer(fd, iov, CHECKPOINT_ARRAYS, false);
+    }
+    if (fd >= 0)
+        close(fd);
+    if (!success) {
+        fprintf(stderr, "%s: truncated checkpoint\n", path);
+        freeCacheTags(cache);
+        return false;
+    }
+
+    cache->clock = header->clock;
+    cache->hits = header->hits;
+    cache->misses = header->misses;
+    cache->evictions = header->evictions;
+    cache->writeBack = header->writeBack;
+    cache->writeAllocate = header->writeAllocate;
+    cache->fills = header->fills;
+    cache->writebacks = header->writebacks;
+    cache->writeBytes = header->writeBytes;
+    return true;
+}
+
+/**
+ * Moves a reader to the position saved in a checkpoint.
+ */
+bool checkpointSeek(const checkpoint_t *header, traceReader_t *reader) {
+    if (reader->stream || reader->length != header->traceLength
+            || reader->packed != header->packed
+            || header->offset > reader->length
+            || checkpointFingerprint(reader, header->offset)
+                    != header->fingerprint) {
+        fprintf(stderr, "checkpoint was taken on a different trace\n");
+        return false;
+    }
+    reader->offset = header->offset;
+    reader->lines = header->lines;
+    reader->blockEnd = header->blockEnd;
+    reader->previous = header->previous;
+    reader->blockRemaining = header->blockRemaining;
+    return true;
+}
@@ -0,0 +1,149 @@
+/*
+ * File:   checkpoint.h
+ * Author: Nathan Hernandez,
+ *         Alyssa Tyler
+ *
+ * LoginID: hernandeznp,
+ *          tylerae
+ *
+ * Checkpoints of a running simulation.
+ * <p>
+ * A checkpoint holds the full state of a Cache (geometry, policies,
+ * counters, tags, replacement metadata and dirty bits) and the position of
+ * the trace reader. The file is a 160 byte checkpoint_t header followed by
+ * the arrays of the tag store, each stored as in memory and at a naturally
+ * aligned offset:
+ * <pre>
+ *   tags     setSize * ways uint64
+ *   meta     setSize * ways uint64
+ *   setMeta  setSize uint64
+ *   valid    setSize uint16
+ *   dirty    setSize uint16
+ * </pre>
+ * so the file can be mapped as is. Everything is in host byte order;
+ * checkpoints are not portable between architectures.
+ * <p>
+ * The header also keeps a fingerprint of the trace: an FNV-1a hash of its
+ * first and last CHECKPOINT_FINGERPRINT_BYTES and of the same number of
+ * bytes before the saved offset. A resume on a trace with another
+ * fingerprint is refused, even if it has the same length.
+ * <p>
+ * A checkpoint is written to "<path>.tmp" and then renamed over path, so a
+ * run that dies while saving leaves the previous checkpoint intact.
+ */
+
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <limits.h>
+#include "cache.h"
+#include "trace.h"
+
+#define CHECKPOINT_MAGIC "CSIMCKPT"
+#define CHECKPOINT_VERSION 3
+#define CHECKPOINT_HEADER_SIZE 160
+
+/**
+ * Bytes of each of the three stretches of the trace fingerprinted.
+ */
+#define CHECKPOINT_FINGERPRINT_BYTES 4096
+
+/**
+ * Default number of records between checkpoints.
+ */
+#define CHECKPOINT_EVERY 100000000
+
+/**
+ * Checkpoint header definition
+ */
+typedef struct checkpoint_t {
+    char magic[8];
+    uint32_t version;
+    uint32_t headerSize;
+    uint8_t policy;
+    uint8_t setBits;
+    uint8_t associativity;
+    uint8_t ways;
+    uint8_t blockBits;
+    uint8_t packed;
+    uint8_t writeBack;
+    uint8_t writeAllocate;
+    uint64_t clock;
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t evictions;
+    uint64_t records;
+    uint64_t traceLength;
+    uint64_t offset;
+    uint64_t lines;
+    uint64_t blockEnd;
+    uint64_t previous;
+    uint32_t blockRemaining;
+    uint32_t reserved0;
+    uint64_t fills;
+    uint64_t writebacks;
+    uint64_t writeBytes;
+    uint64_t fingerprint;
+    uint8_t reserved1[16];
+} checkpoint_t;
+
+/**
+ * Parsed -k or -l option: "<path>[,every=N]" or "<path>[,warm]".
+ */
+typedef struct checkpointConfig_t {
+    char path[PATH_MAX];
+    uint64_t every;
+    bool warm;
+} checkpointConfig_t;
+
+/**
+ * Parses a checkpoint option.
+ *
+ * @param spec the option, e.g. "run.ckpt,every=1000000"
+ * @param config where the parsed option is stored
+ * @return true if the option is valid
+ */
+bool checkpointParse(const char *spec, checkpointConfig_t *config);
+
+/**
+ * Writes a checkpoint of a cache and the position of a trace reader.
+ *
+ * @param path path of the checkpoint
+ * @param cache the cache to save
+ * @param reader the reader whose position is saved
+ * @param records number of records simulated so far
+ * @return true on success
+ */
+bool checkpointSave(const char *path, const Cache *cache,
+        const traceReader_t *reader, uint64_t records);
+
+/**
+ * Reads and validates the header of a checkpoint.
+ *
+ * @param path path of the checkpoint
+ * @param header where the header is stored
+ * @return true if the file holds a valid checkpoint
+ */
+bool checkpointReadHeader(const char *path, checkpoint_t *header);
+
+/**
+ * Creates a cache from a checkpoint, reading the whole tag store in a
+ * single readv(). Be sure to call freeCacheTags() to free memory.
+ *
+ * @param path path of the checkpoint
+ * @param cache the cache to create
+ * @param header where the header is stored
+ * @return true on success
+ */
+bool checkpointLoad(const char *path, Cache *cache, checkpoint_t *header);
+
+/**
+ * Moves a freshly opened reader to the position saved in a checkpoint.
+ *
+ * @param header the checkpoint header
+ * @param reader the reader of the same trace the checkpoint was taken on
+ * @return true if the reader could be positioned
+ */
+bool checkpointSeek(const checkpoint_t *header, traceReader_t *reader);
+
+#endif  /* CHECKPOINT_H */
@@ -0,0 +1,317 @@
+/*
+ * File:   classify.c
+ * Author: Nathan Hernandez,
+ *         Alyssa Tyler
+ *
+ * LoginID: hernandeznp,
+ *          tylerae
+ *
+ * 3C miss classification. See classify.h.
+ */
+
+/**
+ * Includes
+ */
+#include "classify.h"
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * Initial number of chunks and of chunk table slots (a power of two).
+ */
+#define CLASSIFY_INITIAL_CHUNKS 64
+
+/**
+ * End of the LRU list.
+ */
+#define CLASSIFY_NONE UINT32_MAX
+
+/**
+ * Hashes a block for the open-addressing tables.
+ */
+static uint64_t classifyHash(uint64_t block) {
+    uint64_t hash = block * 0x9e3779b97f4a7c15ull;
+
+    return hash ^ hash >> 32;
+}
+
+/**
+ * Allocates a classifier for the misses of a cache.
+ */
+bool classifyCreate(classifier_t *classifier, Cache *cache) {
+    memset(classifier, 0, sizeof(classifier_t));
+    classifier->cache = cache;
+    classifier->lineCount = cache->setSize * cache->associativity;
+    classifier->shadowSize = 1;
+    while (classifier->shadowSize < 2 * (size_t) classifier->lineCount)
+        classifier->shadowSize *= 2;
+    classifier->chunkCapacity = CLASSIFY_INITIAL_CHUNKS;
+    classifier->chunkTableSize = CLASSIFY_INITIAL_CHUNKS;
+    classifier->head = CLASSIFY_NONE;
+    classifier->tail = CLASSIFY_NONE;
+
+    classifier->chunks = malloc(classifier->chunkCapacity
+            * sizeof(classifyChunk_t));
+    classifier->chunkTable = calloc(classifier->chunkTableSize,
+            sizeof(uint32_t));
+    classifier->shadowTable = malloc(classifier->shadowSize
+            * sizeof(uint32_t));
+    classifier->lines = malloc(classifier->lineCount
+            * sizeof(classifyLine_t));
+    if (classifier->shadowTable != NULL)
+        memset(classifier->shadowTable, 0xff,
+                classifier->shadowSize * sizeof(uint32_t));
+    return classifier->chunks && classifier->chunkTable
+            && classifier->shadowTable && classifier->lines;
+}
+
+/**
+ * Doubles the chunk table and rehashes every chunk.
+ *
+ * @return true on success
+ */
+static bool classifyGrowChunks(classifier_t *classifier) {
+    size_t size = classifier->chunkTableSize * 2, mask = size - 1;
+    uint32_t *table = calloc(size, sizeof(uint32_t));
+    size_t i, slot;
+
+    if (table == NULL)
+        return false;
+    for (i = 0; i < classifier->chunkCount; i++) {
+        slot = classifyHash(classifier->chunks[i].key) & mask;
+        while (table[slot] != 0)
+            slot = (slot + 1) & mask;
+        table[slot] = i + 1;
+    }
+    free(classifier->chunkTable);
+    classifier->chunkTable = table;
+    classifier->chunkTableSize = size;
+    return true;
+}
+
+/**
+ * Finds the chunk of a key, adding an empty one for a new key.
+ *
+ * @return the chunk, or NULL if out of memory
+ */
+static classifyChunk_t * classifyChunk(classifier_t *classifier,
+        uint64_t key) {
+    classifyChunk_t *chunks;
+    size_t mask, slot;
+
+    if ((classifier->chunkCount + 1) * 2 > classifier->chunkTableSize
+            && !classifyGrowChunks(classifier))
+        return NULL;
+
+    mask = classifier->chunkTableSize - 1;
+    slot = classifyHash(key) & mask;
+    while (classifier->chunkTable[slot] != 0) {
+        if (classifier->chunks[classifier->chunkTable[slot] - 1].key == key)
+            return &classifier->chunks[classifier->chunkTable[slot] - 1];
+        slot = (slot + 1) & mask;
+    }
+
+    if (classifier->chunkCount == classifier->chunkCapacity) {
+        chunks = realloc(classifier->chunks, classifier->chunkCapacity * 2
+                * sizeof(classifyChunk_t));
+        if (chunks == NULL)
+            return NULL;
+        classifier->chunks = chunks;
+        classifier->chunkCapacity *= 2;
+    }
+    memset(&classifier->chunks[classifier->chunkCount], 0,
+            sizeof(classifyChunk_t));
+    classifier->chunks[classifier->chunkCount].key = key;
+    classifier->chunkTable[slot] = ++classifier->chunkCount;
+    return &classifier->chunks[classifier->chunkCount - 1];
+}
+
+/**
+ * Marks a block as seen. The chunk of the previous block is tried first.
+ *
+ * @return true if the block was not seen before
+ */
+static bool classifyFirstTouch(classifier_t *classifier, uint64_t block) {
+    uint64_t key = block / CLASSIFY_CHUNK_BLOCKS;
+    uint32_t offset = block % CLASSIFY_CHUNK_BLOCKS;
+    classifyChunk_t *chunk;
+    uint64_t bit = 1ull << offset % 64;
+
+    if (classifier->lastChunk == 0
+            || classifier->chunks[classifier->lastChunk - 1].key != key) {
+        chunk = classifyChunk(classifier, key);
+        if (chunk == NULL) {
+            fprintf(stderr, "Out of memory growing the seen bitmap\n");
+            exit(EXIT_FAILURE);
+        }
+        classifier->lastChunk = chunk - classifier->chunks + 1;
+    }
+    chunk = &classifier->chunks[classifier->lastChunk - 1];
+    if (chunk->bits[offset / 64] & bit)
+        return false;
+    chunk->bits[offset / 64] |= bit;
+    classifier->blocks++;
+    return true;
+}
+
+/**
+ * Returns the bucket of a block in the shadow table.
+ */
+static size_t classifyBucket(classifier_t *classifier, uint64_t block) {
+    return classifyHash(block) & (classifier->shadowSize - 1);
+}
+
+/**
+ * Removes a line from the chain of its bucket.
+ */
+static void classifyUnchain(classifier_t *classifier, uint32_t line) {
+    uint32_t *link = &classifier->shadowTable[classifyBucket(classifier,
+            classifier->lines[line].block)];
+
+    while (*link != line)
+        link = &classifier->lines[*link].chain;
+    *link = classifier->lines[line].chain;
+}
+
+/**
+ * Unlinks a line from the LRU list.
+ */
+static void classifyUnlink(classifier_t *classifier, uint32_t line) {
+    classifyLine_t *lines = classifier->lines;
+
+    if (lines[line].previous != CLASSIFY_NONE)
+        lines[lines[line].previous].next = lines[line].next;
+    else
+        classifier->head = lines[line].next;
+    if (lines[line].next != CLASSIFY_NONE)
+        lines[lines[line].next].previous = lines[line].previous;
+    else
+        classifier->tail = lines[line].previous;
+}
+
+/**
+ * Links a line at the most recently used end of the LRU list.
+ */
+static void classifyPushFront(classifier_t *classifier, uint32_t line) {
+    classifier->lines[line].previous = CLASSIFY_NONE;
+    classifier->lines[line].next = classifier->head;
+    if (classifier->head != CLASSIFY_NONE)
+        classifier->lines[classifier->head].previous = line;
+    else
+        classifier->tail = line;
+    classifier->head = line;
+}
+
+/**
+ * Accesses a block in the shadow cache, replacing its least recently used
+ * line on a miss.
+ *
+ * @return true on a hit
+ */
+static bool classifyShadow(classifier_t *classifier, uint64_t block) {
+    size_t bucket = classifyBucket(classifier, block);
+    uint32_t line = classifier->shadowTable[bucket];
+
+    while (line != CLASSIFY_NONE && classifier->lines[line].block != block)
+        line = classifier->lines[line].chain;
+    if (line != CLASSIFY_NONE) {
+        if (line != classifier->head) {
+            classifyUnlink(classifier, line);
+            classifyPushFront(classifier, line);
+        }
+        return true;
+    }
+
+    if (classifier->linesUsed < classifier->lineCount) {
+        line = classifier->linesUsed++;
+    } else {
+        line = classifier->tail;
+        classifyUnlink(classifier, line);
+        classifyUnchain(classifier, line);
+    }
+    classifier->lines[line].block = block;
+    classifier->lines[line].chain = classifier->shadowTable[bucket];
+    classifier->shadowTable[bucket] = line;
+    classifyPushFront(classifier, line);
+    return false;
+}
+
+/**
+ * Updates the shadow state with one access and classifies it if the cache
+ * missed. A block in the shadow cache has been seen, so the seen bitmap is
+ * only probed on shadow misses.
+ */
+static void classifyAccess(classifier_t *classifier, uint64_t address,
+        cacheResult_t result) {
+    uint64_t block = address >> classifier->cache->blockBits;
+    bool shadowHit = classifyShadow(classifier, block);
+    bool first = !shadowHit && classifyFirstTouch(classifier, block);
+
+    if (result == CACHE_HIT)
+        return;
+    if (first)
+        classifier->compulsory++;
+    else if (!shadowHit)
+        classifier->capacity++;
+    else
+        classifier->conflict++;
+}
+
+/**
+ * Simulates a batch of trace records and classifies every miss.
+ */
+void classifySimulateBatch(classifier_t *classifier, const trace_t *batch,
+        size_t count) {
+    Cache *cache = classifier->cache;
+    size_t i;
+
+    for (i = 0; i < count; i++) {
+        switch (batch[i].operation) {
+            case 'L':
+                classifyAccess(classifier, batch[i].address,
+                        cacheAccess(cache, batch[i].address));
+                break;
+            case 'S':
+                classifyAccess(classifier, batch[i].address,
+                        cacheWrite(cache, batch[i].address, batch[i].size,
+                                CACHE_WRITE));
+                break;
+            case 'M':
+                classifyAccess(classifier, batch[i].address,
+                        cacheAccess(cache, batch[i].address));
+                classifyAccess(classifier, batch[i].address,
+                        cacheWrite(cache, batch[i].address, batch[i].size,
+                                CACHE_MODIFY));
+                break;
+        }
+    }
+}
+
+/**
+ * Prints the compulsory, capacity and conflict miss counts.
+ */
+void classifyPrint(classifier_t *classifier, FILE *stream) {
+    uint64_t misses = classifier->compulsory + classifier->capacity
+            + classifier->conflict;
+
+    fprintf(stream, "compulsory:%" PRIu64 " capacity:%" PRIu64
+            " conflict:%" PRIu64 " (%.1f%% conflict) blocks:%" PRIu64 "\n",
+            classifier->compulsory, classifier->capacity,
+            classifier->conflict,
+            misses ? 100.0 * classifier->conflict / misses : 0.0,
+            classifier->blocks);
+}
+
+/**
+ * Frees memory allocated by classifyCreate().
+ */
+void classifyFree(classifier_t *classifier) {
+    free(classifier->chunks);
+    free(classifier->chunkTable);
+    free(classifier->shadowTable);
+    free(classifier->lines);
+    classifier->chunks = NULL;
+    classifier->chunkTable = NULL;
+    classifier->shadowTable = NULL;
+    classifier->lines = NULL;
+}
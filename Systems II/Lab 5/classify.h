@@ -0,0 +1,124 @@
+/*
+ * File:   classify.h
+ * Author: Nathan Hernandez,
+ *         Alyssa Tyler
+ *
+ * LoginID: hernandeznp,
+ *          tylerae
+ *
+ * 3C miss classification: every miss of a Cache is compulsory, capacity or
+ * conflict.
+ * <p>
+ * A miss is compulsory if it is the first touch of its block. Blocks seen
+ * are kept in a bitmap of CLASSIFY_CHUNK_BLOCKS blocks per chunk, with the
+ * chunks in a hash table. Otherwise it is a capacity miss if it also misses
+ * in a shadow fully associative LRU cache with as many lines as the cache,
+ * and a conflict miss if the shadow hits. The shadow is a chained hash table
+ * of its lines over a doubly linked LRU list, so each access is O(1).
+ * <p>
+ * The three counts add up to the cache's misses. With a policy other than
+ * LRU, conflict misses also include the misses the policy adds over LRU.
+ */
+
+#ifndef CLASSIFY_H
+#define CLASSIFY_H
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include "cache.h"
+#include "trace.h"
+
+/**
+ * Blocks per chunk of the seen bitmap: one 64 byte line of bits.
+ */
+#define CLASSIFY_CHUNK_BLOCKS 512
+
+/**
+ * Chunk of the seen bitmap.
+ */
+typedef struct classifyChunk_t {
+    uint64_t key;
+    uint64_t bits[CLASSIFY_CHUNK_BLOCKS / 64];
+} classifyChunk_t;
+
+/**
+ * Line of the shadow cache, linked from most to least recently used and
+ * chained to the other lines of its bucket.
+ */
+typedef struct classifyLine_t {
+    uint64_t block;
+    uint32_t previous;
+    uint32_t next;
+    uint32_t chain;
+} classifyLine_t;
+
+/**
+ * Classifier definition
+ * <p>
+ * chunkTable holds the index + 1 of the chunk of a key (block divided by
+ * CLASSIFY_CHUNK_BLOCKS), 0 marking a free slot; lastChunk is the chunk of
+ * the previous first-touch check, likewise offset by one.
+ * shadowTable holds the first line of every bucket, chained through the
+ * lines, with UINT32_MAX ending a chain.
+ */
+typedef struct classifier_t {
+    Cache * cache;
+    classifyChunk_t * chunks;
+    size_t chunkCount;
+    size_t chunkCapacity;
+    uint32_t * chunkTable;
+    size_t chunkTableSize;
+    size_t lastChunk;
+    uint64_t blocks;
+    uint32_t * shadowTable;
+    size_t shadowSize;
+    classifyLine_t * lines;
+    uint32_t lineCount;
+    uint32_t linesUsed;
+    uint32_t head;
+    uint32_t tail;
+    uint64_t compulsory;
+    uint64_t capacity;
+    uint64_t conflict;
+} classifier_t;
+
+/**
+ * Allocates a classifier for the misses of a cache.
+ * <p>
+ * Be sure to call classifyFree() to free memory and avoid memory leaks.
+ *
+ * @param classifier the classifier to initialize
+ * @param cache the cache whose misses are classified
+ * @return true on success
+ */
+bool classifyCreate(classifier_t *classifier, Cache *cache);
+
+/**
+ * Simulates a batch of trace records in the cache and classifies every
+ * miss. A modify is a load followed by a store.
+ *
+ * @param classifier the classifier to simulate
+ * @param batch the records to simulate
+ * @param count number of records in batch
+ */
+void classifySimulateBatch(classifier_t *classifier, const trace_t *batch,
+        size_t count);
+
+/**
+ * Prints the compulsory, capacity and conflict miss counts.
+ *
+ * @param classifier the classifier to report on
+ * @param stream the stream to print to
+ */
+void classifyPrint(classifier_t *classifier, FILE *stream);
+
+/**
+ * Frees memory allocated by classifyCreate().
+ *
+ * @param classifier the classifier to free
+ */
+void classifyFree(classifier_t *classifier);
+
+#endif  /* CLASSIFY_H */
@@ -0,0 +1,381 @@
+/*
+ * File:   coherence.c
+ * Author: Nathan Hernandez,
+ *         Alyssa Tyler
+ *
+ * LoginID: hernandeznp,
+ *          tylerae
+ *
+ * MESI coherence between private per-core caches. See coherence.h.
+ */
+
+/**
+ * Includes
+ */
+#include "coherence.h"
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * Initial number of directory slots (a power of two).
+ */
+#define DIRECTORY_INITIAL_SIZE 4096
+
+/**
+ * Returns the home slot of a block in the directory.
+ */
+static size_t directoryHome(coherence_t *coherence, uint64_t block) {
+    uint64_t hash = block * 0x9e3779b97f4a7c15ull;
+
+    return (hash ^ hash >> 32) & (coherence->directorySize - 1);
+}
+
+/**
+ * Doubles the directory and rehashes every entry.
+ *
+ * @return true on success
+ */
+static bool directoryGrow(coherence_t *coherence) {
+    directoryEntry_t *old = coherence->directory;
+    size_t oldSize = coherence->directorySize;
+    size_t i, slot;
+
+    coherence->directory = calloc(oldSize * 2, sizeof(directoryEntry_t));
+    if (coherence->directory == NULL) {
+        coherence->directory = old;
+        return false;
+    }
+    coherence->directorySize = oldSize * 2;
+    for (i = 0; i < oldSize; i++) {
+        if (!old[i].used)
+            continue;
+        slot = directoryHome(coherence, old[i].block);
+        while (coherence->directory[slot].used)
+            slot = (slot + 1) & (coherence->directorySize - 1);
+        coherence->directory[slot] = old[i];
+    }
+    free(old);
+    return true;
+}
+
+/**
+ * Finds the directory entry of a block, creating it if asked to.
+ * <p>
+ * Creating an entry may move every other entry.
+ *
+ * @return the entry, or NULL if it does not exist and was not created
+ */
+static directoryEntry_t * directoryFind(coherence_t *coherence,
+        uint64_t block, bool create) {
+    directoryEntry_t *entry;
+    size_t slot;
+
+    if (create && (coherence->directoryUsed + 1) * 2 > coherence->directorySize
+            && !directoryGrow(coherence)) {
+        fprintf(stderr, "Out of memory growing the directory\n");
+        exit(EXIT_FAILURE);
+    }
+
+    slot = directoryHome(coherence, block);
+    while (coherence->directory[slot].used) {
+        if (coherence->directory[slot].block == block)
+            return &coherence->directory[slot];
+        slot = (slot + 1) & (coherence->directorySize - 1);
+    }
+    if (!create)
+        return NULL;
+
+    entry = &coherence->directory[slot];
+    memset(entry, 0, sizeof(directoryEntry_t));
+    entry->block = block;
+    entry->used = true;
+    coherence->directoryUsed++;
+    return entry;
+}
+
+/**
+ * Deletes an entry that no longer carries any information, shifting later
+ * entries of its probe chain back so lookups still find them.
+ */
+static void directoryRelease(coherence_t *coherence, directoryEntry_t *entry) {
+    size_t mask = coherence->directorySize - 1;
+    size_t hole = entry - coherence->directory;
+    size_t slot = hole, home;
+
+    if (entry->sharers || entry->invalidated || entry->bounces)
+        return;
+
+    for (;;) {
+        slot = (slot + 1) & mask;
+        if (!coherence->directory[slot].used)
+            break;
+        home = directoryHome(coherence, coherence->directory[slot].block);
+        if (((slot - home) & mask) >= ((slot - hole) & mask)) {
+            coherence->directory[hole] = coherence->directory[slot];
+            hole = slot;
+        }
+    }
+    coherence->directory[hole].used = false;
+    coherence->directoryUsed--;
+}
+
+/**
+ * Creates one private cache per core and an empty directory.
+ */
+bool coherenceCreate(coherence_t *coherence, unsigned cores, uint8_t setBits,
+        uint8_t associativity, uint8_t blockBits, cachePolicy_t policy) {
+    unsigned core;
+
+    memset(coherence, 0, sizeof(coherence_t));
+    if (cores < 1 || cores > COHERENCE_MAX_CORES)
+        return false;
+
+    coherence->directorySize = DIRECTORY_INITIAL_SIZE;
+    coherence->directory = calloc(coherence->directorySize,
+            sizeof(directoryEntry_t));
+    if (coherence->directory == NULL)
+        return false;
+
+    for (core = 0; core < cores; core++) {
+        if (!cacheCreate(&coherence->caches[core], setBits, associativity,
+                blockBits, policy)) {
+            coherenceFree(coherence);
+            return false;
+        }
+        coherence->cores++;
+    }
+    return true;
+}
+
+/**
+ * Returns the core of a thread id, handing out cores in order of first
+ * appearance.
+ */
+int coherenceCore(coherence_t *coherence, uint32_t thread) {
+    unsigned core;
+
+    for (core = 0; core < coherence->threadCount; core++)
+        if (coherence->threads[core] == thread)
+            return core;
+    if (coherence->threadCount == coherence->cores)
+        return -1;
+    coherence->threads[coherence->threadCount] = thread;
+    return coherence->threadCount++;
+}
+
+/**
+ * Fills a block into a core's cache and drops the core from the directory
+ * entry of the line it evicts.
+ */
+static void coherenceFill(coherence_t *coherence, unsigned core,
+        uint64_t address, bool dirty) {
+    Cache *cache = &coherence->caches[core];
+    directoryEntry_t *entry;
+    uint64_t victim;
+    bool victimDirty;
+
+    if (!cacheInsert(cache, address, dirty, &victim, &victimDirty))
+        return;
+    coherence->stats[core].evictions++;
+    if (victimDirty)
+        coherence->stats[core].writebacks++;
+
+    entry = directoryFind(coherence, victim >> cache->blockBits, false);
+    if (entry != NULL) {
+        entry->sharers &= ~(1ull << core);
+        directoryRelease(coherence, entry);
+    }
+}
+
+/**
+ * Counts a miss as a coherence miss if the core lost the block to another
+ * core's write.
+ */
+static void coherenceMiss(coherence_t *coherence, unsigned core,
+        directoryEntry_t *entry) {
+    coherence->stats[core].misses++;
+    if (entry->invalidated & (1ull << core)) {
+        coherence->stats[core].coherenceMisses++;
+        entry->invalidated &= ~(1ull << core);
+    }
+}
+
+/**
+ * Invalidates every copy of a block except the one of core. A modified
+ * copy is handed over cache to cache.
+ */
+static void coherenceInvalidateOthers(coherence_t *coherence, unsigned core,
+        directoryEntry_t *entry, uint64_t address) {
+    uint64_t others = entry->sharers & ~(1ull << core);
+    unsigned other;
+    bool dirty = false;
+
+    // A sharer may have evicted its copy since; only real copies count.
+    while (others) {
+        other = __builtin_ctzll(others);
+        others &= others - 1;
+        if (!cacheInvalidate(&coherence->caches[other], address, &dirty))
+            continue;
+        if (dirty)
+            coherence->interventions++;
+        coherence->stats[other].invalidations++;
+        entry->invalidated |= 1ull << other;
+        entry->bounces++;
+    }
+    entry->sharers &= 1ull << core;
+}
+
+/**
+ * Performs a read. A miss takes the block in E if no other core holds it,
+ * otherwise in S, downgrading a modified copy elsewhere to S.
+ */
+static void coherenceRead(coherence_t *coherence, unsigned core,
+        uint64_t address) {
+    Cache *cache = &coherence->caches[core];
+    directoryEntry_t *entry;
+    uint64_t others;
+    unsigned other;
+
+    if (cacheTouch(cache, address)) {
+        coherence->stats[core].hits++;
+        return;
+    }
+
+    entry = directoryFind(coherence, address >> cache->blockBits, true);
+    coherenceMiss(coherence, core, entry);
+
+    others = entry->sharers & ~(1ull << core);
+    entry->exclusive = others == 0;
+    while (others) {
+        other = __builtin_ctzll(others);
+        others &= others - 1;
+        if (cacheClean(&coherence->caches[other], address)) {
+            coherence->stats[other].writebacks++;
+            coherence->interventions++;
+            entry->bounces++;
+        }
+    }
+    entry->sharers |= 1ull << core;
+
+    coherenceFill(coherence, core, address, false);
+}
+
+/**
+ * Performs a write. A hit in M or E proceeds silently, a hit in S upgrades
+ * and a miss reads for ownership; both invalidate every other copy.
+ */
+static void coherenceWrite(coherence_t *coherence, unsigned core,
+        uint64_t address) {
+    Cache *cache = &coherence->caches[core];
+    uint64_t block = address >> cache->blockBits;
+    directoryEntry_t *entry;
+
+    if (cacheTouch(cache, address)) {
+        coherence->stats[core].hits++;
+        entry = directoryFind(coherence, block, false);
+        if (entry->sharers != 1ull << core || !entry->exclusive) {
+            coherence->stats[core].upgrades++;
+            coherenceInvalidateOthers(coherence, core, entry, address);
+            entry->exclusive = true;
+        }
+        cacheMarkDirty(cache, address);
+        return;
+    }
+
+    entry = directoryFind(coherence, block, true);
+    coherenceMiss(coherence, core, entry);
+    coherenceInvalidateOthers(coherence, core, entry, address);
+    entry->sharers = 1ull << core;
+    entry->exclusive = true;
+
+    coherenceFill(coherence, core, address, true);
+}
+
+/**
+ * Performs one trace record on behalf of a core.
+ */
+void coherenceAccess(coherence_t *coherence, unsigned core,
+        const trace_t *trace) {
+    switch (trace->operation) {
+        case 'L':
+            coherenceRead(coherence, core, trace->address);
+            break;
+        case 'M':
+            coherenceRead(coherence, core, trace->address);
+            /* fall through */
+        case 'S':
+            coherenceWrite(coherence, core, trace->address);
+            break;
+    }
+}
+
+/**
+ * Prints per-core counters, totals and the blocks that bounced the most.
+ */
+void coherencePrint(coherence_t *coherence, FILE *stream) {
+    directoryEntry_t *top[COHERENCE_TOP_BLOCKS];
+    directoryEntry_t *entry;
+    coreStats_t total;
+    coreStats_t *stats;
+    size_t found = 0, i, j;
+    unsigned core;
+
+    memset(&total, 0, sizeof(total));
+    for (core = 0; core < coherence->cores; core++) {
+        stats = &coherence->stats[core];
+        if (core < coherence->threadCount)
+            fprintf(stream, "thread %" PRIu32 " ", coherence->threads[core]);
+        fprintf(stream, "core %u hits:%" PRIu64 " misses:%" PRIu64
+                " evictions:%" PRIu64 " writebacks:%" PRIu64
+                " coherence-misses:%" PRIu64 " invalidations:%" PRIu64
+                " upgrades:%" PRIu64 "\n",
+                core, stats->hits, stats->misses, stats->evictions,
+                stats->writebacks, stats->coherenceMisses,
+                stats->invalidations, stats->upgrades);
+        total.hits += stats->hits;
+        total.misses += stats->misses;
+        total.evictions += stats->evictions;
+        total.writebacks += stats->writebacks;
+        total.coherenceMisses += stats->coherenceMisses;
+        total.invalidations += stats->invalidations;
+        total.upgrades += stats->upgrades;
+    }
+    fprintf(stream, "total hits:%" PRIu64 " misses:%" PRIu64
+            " evictions:%" PRIu64 " writebacks:%" PRIu64
+            " coherence-misses:%" PRIu64 " invalidations:%" PRIu64
+            " upgrades:%" PRIu64 " interventions:%" PRIu64 "\n",
+            total.hits, total.misses, total.evictions, total.writebacks,
+            total.coherenceMisses, total.invalidations, total.upgrades,
+            coherence->interventions);
+
+    for (i = 0; i < coherence->directorySize; i++) {
+        entry = &coherence->directory[i];
+        if (!entry->used || entry->bounces == 0)
+            continue;
+        if (found == COHERENCE_TOP_BLOCKS
+                && entry->bounces <= top[found - 1]->bounces)
+            continue;
+        if (found < COHERENCE_TOP_BLOCKS)
+            found++;
+        for (j = found - 1; j > 0 && top[j - 1]->bounces < entry->bounces; j--)
+            top[j] = top[j - 1];
+        top[j] = entry;
+    }
+    for (i = 0; i < found; i++)
+        fprintf(stream, "bouncing block 0x%" PRIx64 " bounces:%" PRIu64 "\n",
+                top[i]->block << coherence->caches[0].blockBits,
+                top[i]->bounces);
+}
+
+/**
+ * Frees the caches and directory.
+ */
+void coherenceFree(coherence_t *coherence) {
+    unsigned core;
+
+    for (core = 0; core < coherence->cores; core++)
+        freeCacheTags(&coherence->caches[core]);
+    free(coherence->directory);
+    coherence->directory = NULL;
+    coherence->cores = 0;
+}
@@ -0,0 +1,131 @@
+/*
+ * File:   coherence.h
+ * Author: Nathan Hernandez,
+ *         Alyssa Tyler
+ *
+ * LoginID: hernandeznp,
+ *          tylerae
+ *
+ * MESI coherence between private per-core caches. A directory keyed by
+ * block records which cores hold a block and whether the single holder got
+ * it exclusively, which together with the dirty bit of the private caches
+ * gives every line its M, E, S or I state.
+ */
+
+#ifndef COHERENCE_H
+#define COHERENCE_H
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include "cache.h"
+#include "trace.h"
+
+/**
+ * Largest number of cores (one bit per core in a sharer mask).
+ */
+#define COHERENCE_MAX_CORES 64
+
+/**
+ * Number of most frequently bouncing blocks reported.
+ */
+#define COHERENCE_TOP_BLOCKS 10
+
+/**
+ * Directory entry definition
+ * <p>
+ * invalidated holds the cores whose copy was taken away by another core's
+ * write, so their next miss on the block is a coherence miss. bounces
+ * counts invalidations and M to S interventions on the block.
+ */
+typedef struct directoryEntry_t {
+    uint64_t block;
+    uint64_t sharers;
+    uint64_t invalidated;
+    uint64_t bounces;
+    bool exclusive;
+    bool used;
+} directoryEntry_t;
+
+/**
+ * Per-core counters.
+ */
+typedef struct coreStats_t {
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t evictions;
+    uint64_t writebacks;
+    uint64_t coherenceMisses;
+    uint64_t invalidations;
+    uint64_t upgrades;
+} coreStats_t;
+
+/**
+ * Coherent multi-core definition
+ */
+typedef struct coherence_t {
+    unsigned cores;
+    uint32_t threads[COHERENCE_MAX_CORES];
+    unsigned threadCount;
+    Cache caches[COHERENCE_MAX_CORES];
+    coreStats_t stats[COHERENCE_MAX_CORES];
+    directoryEntry_t * directory;
+    size_t directorySize;
+    size_t directoryUsed;
+    uint64_t interventions;
+} coherence_t;
+
+/**
+ * Creates one private cache per core and an empty directory.
+ * <p>
+ * Be sure to call coherenceFree() to free memory and avoid memory leaks.
+ *
+ * @param coherence the system to initialize
+ * @param cores number of cores (1-COHERENCE_MAX_CORES)
+ * @param setBits number of set index bits of each cache
+ * @param associativity number of lines per set of each cache
+ * @param blockBits number of block offset bits of each cache
+ * @param policy replacement policy of each cache
+ * @return true on success
+ */
+bool coherenceCreate(coherence_t *coherence, unsigned cores, uint8_t setBits,
+        uint8_t associativity, uint8_t blockBits, cachePolicy_t policy);
+
+/**
+ * Returns the core of a thread id. Cores are handed to distinct thread ids
+ * in order of first appearance.
+ *
+ * @param coherence the system to simulate
+ * @param thread the thread id of a trace record
+ * @return the core, or -1 if every core already belongs to another thread
+ */
+int coherenceCore(coherence_t *coherence, uint32_t thread);
+
+/**
+ * Performs one trace record on behalf of a core. Instruction fetches are
+ * ignored and a modify is a load followed by a store.
+ *
+ * @param coherence the system to simulate
+ * @param core the core issuing the record
+ * @param trace the record to simulate
+ */
+void coherenceAccess(coherence_t *coherence, unsigned core,
+        const trace_t *trace);
+
+/**
+ * Prints per-core counters, totals and the blocks that bounced the most.
+ *
+ * @param coherence the system to report on
+ * @param stream the stream to print to
+ */
+void coherencePrint(coherence_t *coherence, FILE *stream);
+
+/**
+ * Frees the caches and directory.
+ *
+ * @param coherence the system to free
+ */
+void coherenceFree(coherence_t *coherence);
+
+#endif  /* COHERENCE_H */
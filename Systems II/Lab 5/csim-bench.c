@@ -0,0 +1,253 @@
+/*
+ * File:   csim-bench.c
+ * Author: Nathan Hernandez,
+ *         Alyssa Tyler
+ *
+ * LoginID: hernandeznp,
+ *          tylerae
+ *
+ * Throughput benchmark of the simulator. A synthetic trace is generated,
+ * written to a temporary valgrind trace and then timed three ways:
+ * <pre>
+ *   parse     traceNextBatch over the file, records discarded
+ *   simulate  cacheSimulateBatch over records already in memory
+ *   total     parse and simulate together, as csim does
+ * </pre>
+ * simulate and total are repeated for every combination of the -s/-E/-b
+ * lists. Every run is repeated and the fastest is kept.
+ */
+
+/**
+ * Includes
+ */
+#include "cache.h"
+#include "gen.h"
+#include "stackdist.h"
+#include "trace.h"
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+/**
+ * Prints the program usage to the screen.
+ */
+void printUsage(void) {
+    printf(
+            "\nUsage: ./csim-bench [-h] [-p <pattern>] [-n <records>] [-f <footprint>] [-R <repeats>] [-s <s>] [-E <E>] [-b <b>]\n"
+            "\t-h: Optional help flag that prints usage info\n"
+            "\t-p <pattern>: Optional csim-gen pattern (default random)\n"
+            "\t-n <records>: Optional number of records (default 4000000)\n"
+            "\t-f <footprint>: Optional bytes touched (default 16777216)\n"
+            "\t-R <repeats>: Optional runs per measurement, fastest kept\n"
+            "\t              (default 3)\n"
+            "\t-s <s>, -E <E>, -b <b>: Optional lists or ranges of cache\n"
+            "\t                        geometries (default 4,8,12 / 1,4,16 / 6)\n"
+    );
+}
+
+/**
+ * Returns the monotonic time in seconds.
+ */
+static double now(void) {
+    struct timespec time;
+
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return time.tv_sec + time.tv_nsec * 1e-9;
+}
+
+/**
+ * Times one parse of the trace file, optionally simulating every batch.
+ *
+ * @return the elapsed seconds, or a negative value on error
+ */
+static double benchParse(const char *path, Cache *cache) {
+    static trace_t batch[TRACE_BATCH_SIZE];
+    traceReader_t reader;
+    size_t count;
+    double start;
+    bool error;
+
+    if (!traceOpen(&reader, path))
+        return -1;
+    start = now();
+    while ((count = traceNextBatch(&reader, batch, TRACE_BATCH_SIZE)) > 0)
+        if (cache != NULL)
+            cacheSimulateBatch(cache, batch, count);
+    start = now() - start;
+    error = reader.error;
+    traceClose(&reader);
+    return error ? -1 : start;
+}
+
+/**
+ * Times one simulation of records already in memory, batch by batch.
+ *
+ * @return the elapsed seconds
+ */
+static double benchSimulate(const trace_t *records, size_t count,
+        Cache *cache) {
+    double start = now();
+    size_t done, n;
+
+    for (done = 0; done < count; done += n) {
+        n = count - done < TRACE_BATCH_SIZE ? count - done : TRACE_BATCH_SIZE;
+        cacheSimulateBatch(cache, records + done, n);
+    }
+    return now() - start;
+}
+
+/**
+ * Generates the records and writes them to a temporary trace file.
+ *
+ * @return true on success
+ */
+static bool benchPrepare(genConfig_t *config, trace_t *records, size_t count,
+        char *path) {
+    generator_t generator;
+    size_t i;
+    bool success;
+    FILE *out;
+    int fd;
+
+    if (!genCreate(&generator, config)) {
+        genFree(&generator);
+        return false;
+    }
+    genNextBatch(&generator, records, count);
+    genFree(&generator);
+
+    fd = mkstemp(path);
+    if (fd < 0) {
+        perror("Error creating temporary trace");
+        return false;
+    }
+    out = fdopen(fd, "w");
+    if (out == NULL) {
+        perror("Error creating temporary trace");
+        close(fd);
+        unlink(path);
+        return false;
+    }
+    success = true;
+    for (i = 0; success && i < count; i++)
+        success = fprintf(out, " %c %" PRIx64 ",%u\n", records[i].operation,
+                records[i].address, records[i].size) > 0;
+    success = fclose(out) == 0 && success;
+    if (!success) {
+        perror("Error writing temporary trace");
+        unlink(path);
+    }
+    return success;
+}
+
+/**
+ * Main body - runs the benchmark described on the command line.
+ *
+ * @param argc number of command-line options
+ * @param argv arguments of command-line options
+ * @return EXIT_FAILURE or EXIT_SUCCESS depending on runtime conditions
+ */
+int main(int argc, char * argv[])
+{
+    uint32_t setBits[STACKDIST_MAX_VALUES];
+    uint32_t associativities[STACKDIST_MAX_VALUES];
+    uint32_t blockBits[STACKDIST_MAX_VALUES];
+    const char *sets = "4,8,12", *ways = "1,4,16", *blocks = "6";
+    char path[] = "/tmp/csim-bench-XXXXXX";
+    genConfig_t config;
+    Cache cache;
+    trace_t *records;
+    size_t count = 4000000, setCount, wayCount, blockCount, i, j, k;
+    unsigned repeats = 3, run;
+    double best, seconds, simulate;
+    bool success = true;
+    int option;
+
+    genDefaults(&config, GEN_RANDOM);
+    config.footprint = 1 << 24;
+    while ((option = getopt(argc, argv, "hp:n:f:R:s:E:b:")) != -1)
+        switch (option) {
+            case 'p':
+                config.pattern = genPatternByName(optarg);
+                if (config.pattern == GEN_PATTERNS) {
+                    fprintf(stderr, "%s: unknown pattern %s\n", argv[0],
+                            optarg);
+                    return (EXIT_FAILURE);
+                }
+                break;
+            case 'n': count = strtoull(optarg, NULL, 0); break;
+            case 'f': config.footprint = strtoull(optarg, NULL, 0); break;
+            case 'R': repeats = atoi(optarg); break;
+            case 's': sets = optarg; break;
+            case 'E': ways = optarg; break;
+            case 'b': blocks = optarg; break;
+            default:
+                printUsage();
+                return (EXIT_FAILURE);
+        }
+
+    setCount = stackParseList(sets, setBits, STACKDIST_MAX_VALUES);
+    wayCount = stackParseList(ways, associativities, STACKDIST_MAX_VALUES);
+    blockCount = stackParseList(blocks, blockBits, STACKDIST_MAX_VALUES);
+    if (!setCount || !wayCount || !blockCount || count == 0 || repeats < 1) {
+        printUsage();
+        return (EXIT_FAILURE);
+    }
+
+    records = malloc(count * sizeof(trace_t));
+    if (records == NULL || !benchPrepare(&config, records, count, path)) {
+        fprintf(stderr, "%s: could not generate the trace\n", argv[0]);
+        free(records);
+        return (EXIT_FAILURE);
+    }
+
+    for (best = -1, run = 0; success && run < repeats; run++) {
+        seconds = benchParse(path, NULL);
+        success = seconds >= 0;
+        if (best < 0 || seconds < best)
+            best = seconds;
+    }
+    if (success)
+        printf("records:%zu parse:%.0f accesses/s\n", count, count / best);
+
+    printf("%3s %3s %3s %16s %16s\n", "s", "E", "b", "simulate/s", "total/s");
+    for (i = 0; success && i < setCount; i++)
+    for (j = 0; success && j < wayCount; j++)
+    for (k = 0; success && k < blockCount; k++) {
+        simulate = best = -1;
+        for (run = 0; success && run < repeats; run++) {
+            success = cacheCreate(&cache, setBits[i], associativities[j],
+                    blockBits[k], CACHE_LRU);
+            if (!success)
+                break;
+            seconds = benchSimulate(records, count, &cache);
+            if (simulate < 0 || seconds < simulate)
+                simulate = seconds;
+            freeCacheTags(&cache);
+
+            success = cacheCreate(&cache, setBits[i], associativities[j],
+                    blockBits[k], CACHE_LRU);
+            if (!success)
+                break;
+            seconds = benchParse(path, &cache);
+            success = seconds >= 0;
+            if (best < 0 || seconds < best)
+                best = seconds;
+            freeCacheTags(&cache);
+        }
+        if (success)
+            printf("%3u %3u %3u %16.0f %16.0f\n", setBits[i],
+                    associativities[j], blockBits[k], count / simulate,
+                    count / best);
+        else
+            fprintf(stderr, "%s: cannot simulate s=%u E=%u b=%u\n", argv[0],
+                    setBits[i], associativities[j], blockBits[k]);
+    }
+
+    unlink(path);
+    free(records);
+    return success ? (EXIT_SUCCESS) : (EXIT_FAILURE);
+}
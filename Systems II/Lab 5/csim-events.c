@@ -0,0 +1,54 @@
+/*
+ * File:   csim-events.c
+ * Author: Nathan Hernandez,
+ *         Alyssa Tyler
+ *
+ * LoginID: hernandeznp,
+ *          tylerae
+ *
+ * Prints an event log written by csim -L in the format of csim -v.
+ * See eventlog.h for the layout.
+ */
+
+/**
+ * Includes
+ */
+#include "eventlog.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * Prints the program usage to the screen.
+ */
+void printUsage(void) {
+    printf(
+            "\nUsage: ./csim-events [-e] <eventlog>\n"
+            "\t-e: Optional flag that appends the address of every evicted\n"
+            "\t    block\n"
+            "\t<eventlog>: Name of the event log to print\n"
+    );
+}
+
+/**
+ * Main body - prints the event log given on the command line.
+ *
+ * @param argc number of command-line options
+ * @param argv arguments of command-line options
+ * @return EXIT_FAILURE or EXIT_SUCCESS depending on runtime conditions
+ */
+int main(int argc, char * argv[])
+{
+    static char buffer[1 << 20];
+    bool victims = argc == 3 && strcmp(argv[1], "-e") == 0;
+
+    if (argc != 2 && !victims) {
+        printUsage();
+        return (EXIT_FAILURE);
+    }
+
+    setvbuf(stdout, buffer, _IOFBF, sizeof(buffer));
+    if (!eventLogPrint(argv[argc - 1], victims, stdout))
+        return (EXIT_FAILURE);
+    return fflush(stdout) == 0 ? (EXIT_SUCCESS) : (EXIT_FAILURE);
+}
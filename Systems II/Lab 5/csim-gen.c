@@ -0,0 +1,134 @@
+/*
+ * File:   csim-gen.c
+ * Author: Nathan Hernandez,
+ *         Alyssa Tyler
+ *
+ * LoginID: hernandeznp,
+ *          tylerae
+ *
+ * Writes a reproducible synthetic trace, as a valgrind trace or, if the
+ * output file ends in ".pack", in the packed format. See gen.h for the
+ * patterns.
+ */
+
+/**
+ * Includes
+ */
+#include "gen.h"
+#include "pack.h"
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * Prints the program usage to the screen.
+ */
+void printUsage(void) {
+    printf(
+            "\nUsage: ./csim-gen [-h] -p <pattern> [-n <records>] [-f <footprint>] [-S <stride>] [-a <alpha>] [-M <M>] [-N <N>] [-r <seed>] [-o <output>]\n"
+            "\t-h: Optional help flag that prints usage info\n"
+            "\t-p <pattern>: sequential, strided, random, chase, zipf or\n"
+            "\t              transpose\n"
+            "\t-n <records>: Optional number of records (default 1000000)\n"
+            "\t-f <footprint>: Optional bytes touched (default 1048576)\n"
+            "\t-S <stride>: Optional stride of strided in bytes (default 64)\n"
+            "\t-a <alpha>: Optional Zipf exponent of zipf (default 0.99)\n"
+            "\t-M <M>, -N <N>: Optional transpose of an N x M matrix\n"
+            "\t                (default 32 x 32)\n"
+            "\t-r <seed>: Optional random seed (default 1)\n"
+            "\t-o <output>: Optional trace to write (default stdout); packed\n"
+            "\t             if it ends in \".pack\"\n"
+    );
+}
+
+/**
+ * Main body - writes the trace described on the command line.
+ *
+ * @param argc number of command-line options
+ * @param argv arguments of command-line options
+ * @return EXIT_FAILURE or EXIT_SUCCESS depending on runtime conditions
+ */
+int main(int argc, char * argv[])
+{
+    static trace_t batch[TRACE_BATCH_SIZE];
+    genConfig_t config;
+    generator_t generator;
+    packWriter_t *writer = NULL;
+    const char *output = NULL, *pattern = NULL;
+    uint64_t records = 1000000, done;
+    size_t count, i, length;
+    bool success = true;
+    FILE *out = stdout;
+    int option;
+
+    genDefaults(&config, GEN_PATTERNS);
+    while ((option = getopt(argc, argv, "hp:n:f:S:a:M:N:r:o:")) != -1)
+        switch (option) {
+            case 'p': pattern = optarg; break;
+            case 'n': records = strtoull(optarg, NULL, 0); break;
+            case 'f': config.footprint = strtoull(optarg, NULL, 0); break;
+            case 'S': config.stride = strtoull(optarg, NULL, 0); break;
+            case 'a': config.alpha = atof(optarg); break;
+            case 'M': config.columns = atoi(optarg); break;
+            case 'N': config.rows = atoi(optarg); break;
+            case 'r': config.seed = strtoull(optarg, NULL, 0); break;
+            case 'o': output = optarg; break;
+            default:
+                printUsage();
+                return (EXIT_FAILURE);
+        }
+
+    if (pattern == NULL
+            || (config.pattern = genPatternByName(pattern)) == GEN_PATTERNS) {
+        fprintf(stderr, "%s: missing or unknown -p pattern\n", argv[0]);
+        printUsage();
+        return (EXIT_FAILURE);
+    }
+    if (!genCreate(&generator, &config)) {
+        fprintf(stderr, "%s: invalid parameters for %s\n", argv[0], pattern);
+        genFree(&generator);
+        return (EXIT_FAILURE);
+    }
+
+    length = output ? strlen(output) : 0;
+    if (length >= 5 && strcmp(output + length - 5, ".pack") == 0) {
+        writer = malloc(sizeof(packWriter_t));
+        if (writer == NULL || !packOpen(writer, output)) {
+            free(writer);
+            genFree(&generator);
+            return (EXIT_FAILURE);
+        }
+    } else if (output != NULL && (out = fopen(output, "w")) == NULL) {
+        perror("Error creating file");
+        genFree(&generator);
+        return (EXIT_FAILURE);
+    }
+
+    for (done = 0; success && done < records; done += count) {
+        count = records - done < TRACE_BATCH_SIZE
+                ? records - done : TRACE_BATCH_SIZE;
+        genNextBatch(&generator, batch, count);
+        for (i = 0; success && i < count; i++)
+            if (writer != NULL)
+                success = packAppend(writer, &batch[i]);
+            else
+                success = fprintf(out, " %c %" PRIx64 ",%u\n",
+                        batch[i].operation, batch[i].address,
+                        batch[i].size) > 0;
+    }
+
+    if (writer != NULL) {
+        success = packClose(writer) && success;
+        free(writer);
+    } else if (out != stdout) {
+        success = fclose(out) == 0 && success;
+    } else {
+        success = fflush(out) == 0 && success;
+    }
+    if (!success)
+        fprintf(stderr, "Error writing %s\n", output ? output : "stdout");
+
+    genFree(&generator);
+    return success ? (EXIT_SUCCESS) : (EXIT_FAILURE);
+}
@@ -0,0 +1,96 @@
+/*
+ * File:   csim-pack.c
+ * Author: Nathan Hernandez,
+ *         Alyssa Tyler
+ *
+ * LoginID: hernandeznp,
+ *          tylerae
+ *
+ * Converts a valgrind trace into the packed binary format read by csim.
+ * See pack.h for the layout. The packed format has no thread ids, so
+ * traces for -m with a thread column are refused rather than collapsed
+ * onto one core.
+ */
+
+/**
+ * Includes
+ */
+#include "pack.h"
+#include "trace.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+/**
+ * Prints the program usage to the screen.
+ */
+void printUsage(void) {
+    printf(
+            "\nUsage: ./csim-pack <tracefile> <packedfile>\n"
+            "\t<tracefile>: Name of the valgrind trace to convert\n"
+            "\t<packedfile>: Name of the packed trace to write\n"
+    );
+}
+
+/**
+ * Main body - converts the trace given on the command line.
+ *
+ * @param argc number of command-line options
+ * @param argv arguments of command-line options
+ * @return EXIT_FAILURE or EXIT_SUCCESS depending on runtime conditions
+ */
+int main(int argc, char * argv[])
+{
+    static trace_t batch[TRACE_BATCH_SIZE];
+    traceReader_t reader;
+    packWriter_t *writer;
+    size_t count, i;
+    bool success = true;
+
+    if (argc != 3) {
+        printUsage();
+        return (EXIT_FAILURE);
+    }
+
+    writer = malloc(sizeof(packWriter_t));
+    if (writer == NULL || !traceOpen(&reader, argv[1])) {
+        free(writer);
+        return (EXIT_FAILURE);
+    }
+    if (!packOpen(writer, argv[2])) {
+        traceClose(&reader);
+        free(writer);
+        return (EXIT_FAILURE);
+    }
+
+    while (success
+            && (count = traceNextBatch(&reader, batch, TRACE_BATCH_SIZE)) > 0)
+        for (i = 0; success && i < count; i++) {
+            if (batch[i].thread != 0) {
+                fprintf(stderr, "%s: line %" PRIu64 " has thread id %u; "
+                        "packed traces cannot store thread ids\n", argv[1],
+                        reader.lines - count + i + 1, batch[i].thread);
+                success = false;
+                break;
+            }
+            success = packAppend(writer, &batch[i]);
+        }
+
+    // A failed conversion leaves no partial file behind.
+    if (!packClose(writer) || !success || reader.error) {
+        fprintf(stderr, "Error writing %s\n", argv[2]);
+        unlink(argv[2]);
+        success = false;
+    } else {
+        printf("%" PRIu64 " records, %zu -> %" PRIu64 " bytes "
+                "(%.2f bytes/record)\n",
+                writer->totalRecords, reader.length, writer->totalBytes,
+                writer->totalRecords
+                        ? (double) writer->totalBytes / writer->totalRecords
+                        : 0.0);
+    }
+
+    traceClose(&reader);
+    free(writer);
+    return success ? (EXIT_SUCCESS) : (EXIT_FAILURE);
+}
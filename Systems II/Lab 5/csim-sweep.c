@@ -0,0 +1,413 @@
+/*
+ * File:   csim-sweep.c
+ * Author: Nathan Hernandez,
+ *         Alyssa Tyler
+ *
+ * LoginID: hernandeznp,
+ *          tylerae
+ *
+ * Runs a manifest of cache simulations in one process. Every trace named by
+ * the manifest is parsed once into memory and shared read-only by all of
+ * its jobs, and jobs run on a work-stealing pool with one thread per core.
+ * <p>
+ * The manifest has one job per line, in the style of the csim -c config:
+ * <pre>
+ *   # trace           geometry          [policy]
+ *   traces/yi.trace   s=4 E=1 b=4
+ *   traces/long.trace s=10 E=8 b=6     p=srrip
+ * </pre>
+ * Results are written as one CSV table in manifest order.
+ */
+
+/**
+ * Includes
+ */
+#include "cache.h"
+#include "pool.h"
+#include "trace.h"
+#include <errno.h>
+#include <getopt.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/**
+ * Defines
+ */
+#define LINE_SIZE 1024
+
+/**
+ * Trace shared by jobs: its data records, parsed once.
+ */
+typedef struct sweepTrace_t {
+    char *path;
+    trace_t *records;
+    size_t count;
+    bool loaded;
+} sweepTrace_t;
+
+/**
+ * Job definition
+ */
+typedef struct sweepJob_t {
+    size_t trace;
+    uint8_t setBits;
+    uint8_t associativity;
+    uint8_t blockBits;
+    cachePolicy_t policy;
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t evictions;
+    double seconds;
+    bool done;
+} sweepJob_t;
+
+/**
+ * Manifest definition
+ */
+typedef struct sweep_t {
+    sweepTrace_t *traces;
+    size_t traceCount;
+    sweepJob_t *jobs;
+    size_t jobCount;
+} sweep_t;
+
+/**
+ * Prints the program usage to the screen.
+ */
+void printUsage(void) {
+    printf(
+            "\nUsage: ./csim-sweep [-h] [-j <threads>] [-o <results>] <manifest>\n"
+            "\t-h: Optional help flag that prints usage info\n"
+            "\t-j <threads>: Optional number of worker threads (default: one\n"
+            "\t              per core)\n"
+            "\t-o <results>: Optional CSV file to write (default: stdout)\n"
+            "\t<manifest>: File with one \"<trace> s=<s> E=<E> b=<b> [p=<policy>]\"\n"
+            "\t            job per line\n"
+    );
+}
+
+/**
+ * Returns the monotonic time in seconds.
+ */
+static double now(void) {
+    struct timespec time;
+
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return time.tv_sec + time.tv_nsec * 1e-9;
+}
+
+/**
+ * Returns the index of the trace with the given path, adding it if it is
+ * new.
+ *
+ * @return the index, or (size_t) -1 if out of memory
+ */
+static size_t sweepAddTrace(sweep_t *sweep, const char *path) {
+    sweepTrace_t *grown;
+    size_t i;
+
+    for (i = 0; i < sweep->traceCount; i++)
+        if (strcmp(sweep->traces[i].path, path) == 0)
+            return i;
+
+    grown = realloc(sweep->traces, (i + 1) * sizeof(sweepTrace_t));
+    if (grown == NULL)
+        return (size_t) -1;
+    sweep->traces = grown;
+    memset(&grown[i], 0, sizeof(sweepTrace_t));
+    grown[i].path = strdup(path);
+    if (grown[i].path == NULL)
+        return (size_t) -1;
+    sweep->traceCount++;
+    return i;
+}
+
+/**
+ * Parses the decimal value of a geometry option of a job line.
+ *
+ * @return true if value is a whole non-negative number
+ */
+static bool sweepParseNumber(const char *option, const char *value,
+        unsigned number, int *result) {
+    char *end;
+    long parsed;
+
+    errno = 0;
+    parsed = strtol(value, &end, 10);
+    if (end == value || *end != '\0' || errno != 0 || parsed < 0
+            || parsed > INT_MAX) {
+        fprintf(stderr, "line %u: %s takes a number, not %s\n", number,
+                option, value);
+        return false;
+    }
+    *result = (int) parsed;
+    return true;
+}
+
+/**
+ * Parses one job line of the manifest.
+ *
+ * @return true if the line is valid
+ */
+static bool sweepParseJob(sweep_t *sweep, char *line, unsigned number) {
+    char *path = strtok(line, " \t\r\n");
+    char *option, *value;
+    int setBits = -1, associativity = -1, blockBits = -1;
+    sweepJob_t job, *grown;
+
+    if (path == NULL)
+        return true;
+
+    memset(&job, 0, sizeof(job));
+    job.policy = CACHE_LRU;
+    while ((option = strtok(NULL, " \t\r\n")) != NULL) {
+        value = strchr(option, '=');
+        if (value == NULL) {
+            fprintf(stderr, "line %u: expected key=value, got %s\n", number,
+                    option);
+            return false;
+        }
+        *value++ = '\0';
+        if (strcmp(option, "s") == 0) {
+            if (!sweepParseNumber(option, value, number, &setBits))
+                return false;
+        } else if (strcmp(option, "E") == 0) {
+            if (!sweepParseNumber(option, value, number, &associativity))
+                return false;
+        } else if (strcmp(option, "b") == 0) {
+            if (!sweepParseNumber(option, value, number, &blockBits))
+                return false;
+        } else if (strcmp(option, "p") == 0) {
+            job.policy = cachePolicyByName(value);
+            if (job.policy == CACHE_POLICIES) {
+                fprintf(stderr, "line %u: unknown policy %s\n", number,
+                        value);
+                return false;
+            }
+        } else {
+            fprintf(stderr, "line %u: bad option %s=%s\n", number, option,
+                    value);
+            return false;
+        }
+    }
+
+    if (setBits < 0 || setBits > CACHE_MAX_SET_BITS || blockBits < 0
+            || blockBits > 63 || setBits + blockBits > 63 || associativity < 1
+            || associativity > CACHE_MAX_WAYS) {
+        fprintf(stderr, "line %u: needs s (0-%d), E (1-%d) and b with "
+                "s + b < 64\n", number, CACHE_MAX_SET_BITS, CACHE_MAX_WAYS);
+        return false;
+    }
+    job.setBits = setBits;
+    job.associativity = associativity;
+    job.blockBits = blockBits;
+
+    job.trace = sweepAddTrace(sweep, path);
+    if (job.trace == (size_t) -1) {
+        fprintf(stderr, "Out of memory reading the manifest\n");
+        return false;
+    }
+    grown = realloc(sweep->jobs, (sweep->jobCount + 1) * sizeof(sweepJob_t));
+    if (grown == NULL) {
+        fprintf(stderr, "Out of memory reading the manifest\n");
+        return false;
+    }
+    sweep->jobs = grown;
+    sweep->jobs[sweep->jobCount++] = job;
+    return true;
+}
+
+/**
+ * Reads the manifest.
+ *
+ * @return true on success
+ */
+static bool sweepReadManifest(sweep_t *sweep, const char *path) {
+    char line[LINE_SIZE];
+    char *comment;
+    unsigned number = 0;
+    bool success = true;
+    FILE *manifest = fopen(path, "r");
+
+    if (manifest == NULL) {
+        perror("Error opening manifest");
+        return false;
+    }
+    while (success && fgets(line, LINE_SIZE, manifest) != NULL) {
+        number++;
+        if ((comment = strchr(line, '#')) != NULL)
+            *comment = '\0';
+        success = sweepParseJob(sweep, line, number);
+    }
+    fclose(manifest);
+    return success;
+}
+
+/**
+ * Pool task: parses one trace into memory, keeping its data records.
+ */
+static void sweepLoadTrace(void *context, size_t index) {
+    sweepTrace_t *trace = &((sweep_t *) context)->traces[index];
+    static _Thread_local trace_t batch[TRACE_BATCH_SIZE];
+    traceReader_t reader;
+    size_t capacity = 0, count, i;
+    trace_t *grown;
+
+    if (!traceOpen(&reader, trace->path))
+        return;
+    while ((count = traceNextBatch(&reader, batch, TRACE_BATCH_SIZE)) > 0) {
+        if (trace->count + count > capacity) {
+            capacity = capacity ? capacity * 2 : 1 << 20;
+            grown = realloc(trace->records, capacity * sizeof(trace_t));
+            if (grown == NULL) {
+                fprintf(stderr, "Out of memory loading %s\n", trace->path);
+                traceClose(&reader);
+                return;
+            }
+            trace->records = grown;
+        }
+        for (i = 0; i < count; i++)
+            if (batch[i].operation != 'I')
+                trace->records[trace->count++] = batch[i];
+    }
+    trace->loaded = !reader.error;
+    traceClose(&reader);
+}
+
+/**
+ * Pool task: simulates one job over its shared trace.
+ */
+static void sweepRunJob(void *context, size_t index) {
+    sweep_t *sweep = context;
+    sweepJob_t *job = &sweep->jobs[index];
+    sweepTrace_t *trace = &sweep->traces[job->trace];
+    Cache cache;
+    double start = now();
+
+    if (!trace->loaded || !cacheCreate(&cache, job->setBits,
+            job->associativity, job->blockBits, job->policy))
+        return;
+    cacheSimulateBatch(&cache, trace->records, trace->count);
+    job->hits = cache.hits;
+    job->misses = cache.misses;
+    job->evictions = cache.evictions;
+    job->seconds = now() - start;
+    job->done = true;
+    freeCacheTags(&cache);
+}
+
+/**
+ * Writes one CSV row per job, in manifest order. Jobs that could not run
+ * have empty counters.
+ */
+static void sweepWriteResults(sweep_t *sweep, FILE *out) {
+    static const char *policyNames[CACHE_POLICIES] = {
+        [CACHE_LRU] = "lru",
+        [CACHE_FIFO] = "fifo",
+        [CACHE_RANDOM] = "random",
+        [CACHE_PLRU] = "plru",
+        [CACHE_SRRIP] = "srrip",
+        [CACHE_BRRIP] = "brrip",
+        [CACHE_LFU] = "lfu"
+    };
+    sweepJob_t *job;
+    size_t i;
+
+    fprintf(out, "trace,s,E,b,policy,hits,misses,evictions,miss_rate,"
+            "seconds\n");
+    for (i = 0; i < sweep->jobCount; i++) {
+        job = &sweep->jobs[i];
+        fprintf(out, "%s,%u,%u,%u,%s,", sweep->traces[job->trace].path,
+                job->setBits, job->associativity, job->blockBits,
+                policyNames[job->policy]);
+        if (job->done)
+            fprintf(out, "%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%.6f,%.3f\n",
+                    job->hits, job->misses, job->evictions,
+                    job->hits + job->misses
+                            ? (double) job->misses / (job->hits + job->misses)
+                            : 0.0,
+                    job->seconds);
+        else
+            fprintf(out, ",,,,\n");
+    }
+}
+
+/**
+ * Main body - runs the manifest given on the command line.
+ *
+ * @param argc number of command-line options
+ * @param argv arguments of command-line options
+ * @return EXIT_FAILURE or EXIT_SUCCESS depending on runtime conditions
+ */
+int main(int argc, char * argv[])
+{
+    sweep_t sweep = { NULL, 0, NULL, 0 };
+    unsigned threads = poolDefaultThreads();
+    const char *results = NULL;
+    double start;
+    bool success;
+    FILE *out = stdout;
+    size_t i;
+    int option;
+
+    while ((option = getopt(argc, argv, "hj:o:")) != -1)
+        switch (option) {
+            case 'j':
+                threads = atoi(optarg);
+                if (threads < 1 || threads > POOL_MAX_THREADS) {
+                    fprintf(stderr, "%s: -j must be 1-%d\n", argv[0],
+                            POOL_MAX_THREADS);
+                    return (EXIT_FAILURE);
+                }
+                break;
+            case 'o':
+                results = optarg;
+                break;
+            default:
+                printUsage();
+                return (EXIT_FAILURE);
+        }
+    if (optind != argc - 1) {
+        printUsage();
+        return (EXIT_FAILURE);
+    }
+
+    success = sweepReadManifest(&sweep, argv[optind]);
+    if (success && results != NULL && (out = fopen(results, "w")) == NULL) {
+        perror("Error creating results");
+        success = false;
+    }
+
+    if (success) {
+        start = now();
+        success = poolRun(threads, sweep.traceCount, sweepLoadTrace, &sweep);
+        fprintf(stderr, "Loaded %zu traces in %.3f s\n", sweep.traceCount,
+                now() - start);
+        for (i = 0; i < sweep.traceCount; i++)
+            if (!sweep.traces[i].loaded)
+                success = false;
+    }
+    if (success) {
+        start = now();
+        success = poolRun(threads, sweep.jobCount, sweepRunJob, &sweep);
+        fprintf(stderr, "Ran %zu jobs on %u threads in %.3f s\n",
+                sweep.jobCount, threads, now() - start);
+        sweepWriteResults(&sweep, out);
+        for (i = 0; i < sweep.jobCount; i++)
+            if (!sweep.jobs[i].done)
+                success = false;
+    }
+
+    if (out != stdout && out != NULL && fclose(out) != 0)
+        success = false;
+    for (i = 0; i < sweep.traceCount; i++) {
+        free(sweep.traces[i].path);
+        free(sweep.traces[i].records);
+    }
+    free(sweep.traces);
+    free(sweep.jobs);
+    return success ? (EXIT_SUCCESS) : (EXIT_FAILURE);
+}
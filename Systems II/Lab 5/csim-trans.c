@@ -0,0 +1,121 @@
+/*
+ * File:   csim-trans.c
+ * Author: Nathan Hernandez,
+ *         Alyssa Tyler
+ *
+ * LoginID: hernandeznp,
+ *          tylerae
+ *
+ * Scores every transpose function registered by registerFunctions() in
+ * trans.c on a list of matrix sizes, in process. See transeval.h.
+ */
+
+/**
+ * Includes
+ */
+#include "transeval.h"
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * Functions registered with registerTransFunction(), in cachelab.c.
+ */
+extern trans_func_t func_list[MAX_TRANS_FUNCS];
+extern int func_counter;
+
+/**
+ * Registers the transpose functions, in trans.c.
+ */
+void registerFunctions(void);
+
+/**
+ * Prints the program usage to the screen.
+ */
+void printUsage(void) {
+    printf(
+            "\nUsage: ./csim-trans [-h] [-z <sizes>] [-p <policy>] [-s <s>] [-E <E>] [-b <b>]\n"
+            "\t-h: Optional help flag that prints usage info\n"
+            "\t-z <sizes>: Optional comma separated MxN sizes, at most\n"
+            "\t            256x256 (default 32x32,64x64,61x67)\n"
+            "\t-p <policy>: Optional replacement policy (default lru)\n"
+            "\t-s <s>, -E <E>, -b <b>: Optional cache geometry (default 5, 1, 5)\n"
+    );
+}
+
+/**
+ * Main body - evaluates the registered functions on every size.
+ *
+ * @param argc number of command-line options
+ * @param argv arguments of command-line options
+ * @return EXIT_FAILURE or EXIT_SUCCESS depending on runtime conditions
+ */
+int main(int argc, char * argv[])
+{
+    int columns[TRANS_MAX_SIZES], rows[TRANS_MAX_SIZES];
+    const char *sizes = "32x32,64x64,61x67";
+    cachePolicy_t policy = CACHE_LRU;
+    uint8_t setBits = 5, associativity = 1, blockBits = 5;
+    size_t count, i;
+    bool success = true;
+    int option, f;
+
+    while ((option = getopt(argc, argv, "hz:p:s:E:b:")) != -1)
+        switch (option) {
+            case 'z': sizes = optarg; break;
+            case 'p':
+                policy = cachePolicyByName(optarg);
+                if (policy == CACHE_POLICIES) {
+                    fprintf(stderr, "%s: unknown policy %s\n", argv[0], optarg);
+                    return (EXIT_FAILURE);
+                }
+                break;
+            case 's':
+            case 'E':
+            case 'b':
+                if (!transParseGeometry(argv[0], option, optarg, &setBits,
+                        &associativity, &blockBits))
+                    return (EXIT_FAILURE);
+                break;
+            default:
+                printUsage();
+                return (EXIT_FAILURE);
+        }
+
+    if (!transCheckGeometry(argv[0], setBits, blockBits))
+        return (EXIT_FAILURE);
+    count = transParseSizes(sizes, columns, rows, TRANS_MAX_SIZES);
+    if (count == 0) {
+        fprintf(stderr, "%s: invalid sizes %s\n", argv[0], sizes);
+        printUsage();
+        return (EXIT_FAILURE);
+    }
+    for (i = 0; i < count; i++)
+        if (columns[i] > TRANS_MAX_DIM || rows[i] > TRANS_MAX_DIM) {
+            fprintf(stderr, "%s: %dx%d is larger than the %dx%d that can be "
+                    "simulated\n", argv[0], columns[i], rows[i],
+                    TRANS_MAX_DIM, TRANS_MAX_DIM);
+            return (EXIT_FAILURE);
+        }
+
+    registerFunctions();
+    for (i = 0; i < count; i++) {
+        printf("M=%d N=%d s=%u E=%u b=%u\n", columns[i], rows[i], setBits,
+                associativity, blockBits);
+        for (f = 0; f < func_counter; f++) {
+            if (!transEvaluate(&func_list[f], columns[i], rows[i], setBits,
+                    associativity, blockBits, policy)) {
+                fprintf(stderr, "%s: cannot evaluate func %d (%s)\n", argv[0],
+                        f, func_list[f].description);
+                success = false;
+                continue;
+            }
+            printf("  func %d (%s): correctness: %d hits:%u misses:%u "
+                    "evictions:%u\n", f, func_list[f].description,
+                    func_list[f].correct, func_list[f].num_hits,
+                    func_list[f].num_misses, func_list[f].num_evictions);
+        }
+    }
+    return success ? (EXIT_SUCCESS) : (EXIT_FAILURE);
+}
@@ -0,0 +1,175 @@
+/*
+ * File:   csim-transbench.c
+ * Author: Nathan Hernandez,
+ *         Alyssa Tyler
+ *
+ * LoginID: hernandeznp,
+ *          tylerae
+ *
+ * Native benchmark of the transpose kernels in transkernels.h. For every
+ * size and kernel it prints the wall-clock bandwidth (bytes read plus
+ * bytes written per second) next to the misses the cache model gives the
+ * same kernel, so the two can be compared side by side. Sizes above
+ * TRANS_MAX_DIM are only timed.
+ */
+
+/**
+ * Includes
+ */
+#include "transeval.h"
+#include "transkernels.h"
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/**
+ * Shortest time a measurement runs for, in seconds.
+ */
+#define BENCH_MIN_SECONDS 0.05
+
+/**
+ * Prints the program usage to the screen.
+ */
+void printUsage(void) {
+    printf(
+            "\nUsage: ./csim-transbench [-h] [-z <sizes>] [-R <repeats>] [-p <policy>] [-s <s>] [-E <E>] [-b <b>]\n"
+            "\t-h: Optional help flag that prints usage info\n"
+            "\t-z <sizes>: Optional comma separated MxN sizes\n"
+            "\t            (default 64x64,256x256,1024x1024,4096x4096)\n"
+            "\t-R <repeats>: Optional runs per measurement, fastest kept\n"
+            "\t              (default 3)\n"
+            "\t-p <policy>: Optional replacement policy (default lru)\n"
+            "\t-s <s>, -E <E>, -b <b>: Optional simulated cache geometry\n"
+            "\t                        (default 5, 1, 5)\n"
+    );
+}
+
+/**
+ * Returns the monotonic time in seconds.
+ */
+static double now(void) {
+    struct timespec time;
+
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return time.tv_sec + time.tv_nsec * 1e-9;
+}
+
+/**
+ * Times a kernel, repeating it until it runs for BENCH_MIN_SECONDS.
+ *
+ * @return the seconds of one transpose
+ */
+static double benchKernel(const transKernel_t *kernel, int M, int N, int *A,
+        int *B) {
+    double start = now(), elapsed;
+    unsigned runs = 0;
+
+    do {
+        kernel->func_ptr(M, N, (int (*)[M]) A, (int (*)[N]) B);
+        runs++;
+    } while ((elapsed = now() - start) < BENCH_MIN_SECONDS);
+    return elapsed / runs;
+}
+
+/**
+ * Main body - benchmarks every kernel on every size.
+ *
+ * @param argc number of command-line options
+ * @param argv arguments of command-line options
+ * @return EXIT_FAILURE or EXIT_SUCCESS depending on runtime conditions
+ */
+int main(int argc, char * argv[])
+{
+    int columns[TRANS_MAX_SIZES], rows[TRANS_MAX_SIZES];
+    const char *sizes = "64x64,256x256,1024x1024,4096x4096";
+    cachePolicy_t policy = CACHE_LRU;
+    uint8_t setBits = 5, associativity = 1, blockBits = 5;
+    trans_func_t func;
+    unsigned repeats = 3, run;
+    size_t count, i, k, elements;
+    double best, seconds;
+    bool success = true, correct;
+    int *A, *B, *reference, option;
+
+    while ((option = getopt(argc, argv, "hz:R:p:s:E:b:")) != -1)
+        switch (option) {
+            case 'z': sizes = optarg; break;
+            case 'R': repeats = atoi(optarg); break;
+            case 'p':
+                policy = cachePolicyByName(optarg);
+                if (policy == CACHE_POLICIES) {
+                    fprintf(stderr, "%s: unknown policy %s\n", argv[0], optarg);
+                    return (EXIT_FAILURE);
+                }
+                break;
+            case 's':
+            case 'E':
+            case 'b':
+                if (!transParseGeometry(argv[0], option, optarg, &setBits,
+                        &associativity, &blockBits))
+                    return (EXIT_FAILURE);
+                break;
+            default:
+                printUsage();
+                return (EXIT_FAILURE);
+        }
+
+    if (!transCheckGeometry(argv[0], setBits, blockBits))
+        return (EXIT_FAILURE);
+    count = transParseSizes(sizes, columns, rows, TRANS_MAX_SIZES);
+    if (count == 0 || repeats < 1) {
+        fprintf(stderr, "%s: invalid sizes %s\n", argv[0], sizes);
+        printUsage();
+        return (EXIT_FAILURE);
+    }
+
+    printf("%-11s %-10s %8s %10s %10s\n", "size", "kernel", "GB/s", "misses",
+            "correct");
+    for (i = 0; success && i < count; i++) {
+        int M = columns[i], N = rows[i];
+        char size[32];
+
+        elements = (size_t) M * N;
+        A = aligned_alloc(64, (elements * sizeof(int) + 63) & ~(size_t) 63);
+        B = aligned_alloc(64, (elements * sizeof(int) + 63) & ~(size_t) 63);
+        reference = malloc(elements * sizeof(int));
+        if (A == NULL || B == NULL || reference == NULL) {
+            fprintf(stderr, "%s: out of memory for %dx%d\n", argv[0], M, N);
+            success = false;
+        }
+        snprintf(size, sizeof(size), "%dx%d", M, N);
+
+        if (success) {
+            initMatrix(M, N, (int (*)[M]) A, (int (*)[N]) B);
+            correctTrans(M, N, (int (*)[M]) A, (int (*)[N]) reference);
+        }
+        for (k = 0; success && k < transKernelCount; k++) {
+            memset(B, 0, elements * sizeof(int));
+            for (best = -1, run = 0; run < repeats; run++) {
+                seconds = benchKernel(&transKernels[k], M, N, A, B);
+                if (best < 0 || seconds < best)
+                    best = seconds;
+            }
+            correct = memcmp(B, reference, elements * sizeof(int)) == 0;
+
+            printf("%-11s %-10s %8.2f ", size, transKernels[k].name,
+                    2.0 * elements * sizeof(int) / best * 1e-9);
+            func = (trans_func_t) { transKernels[k].func_ptr,
+                    transKernels[k].name, 0, 0, 0, 0 };
+            if (M <= TRANS_MAX_DIM && N <= TRANS_MAX_DIM
+                    && transEvaluate(&func, M, N, setBits, associativity,
+                    blockBits, policy))
+                printf("%10u ", func.num_misses);
+            else
+                printf("%10s ", "-");
+            printf("%10s\n", correct ? "yes" : "NO");
+            success = correct;
+        }
+        free(A);
+        free(B);
+        free(reference);
+    }
+    return success ? (EXIT_SUCCESS) : (EXIT_FAILURE);
+}
@@ -0,0 +1,121 @@
+/*
+ * File:   csim-tune.c
+ * Author: Nathan Hernandez,
+ *         Alyssa Tyler
+ *
+ * LoginID: hernandeznp,
+ *          tylerae
+ *
+ * Tunes the blocked transpose kernel for a cache geometry and prints the
+ * variant with the fewest misses for every matrix shape. See transtune.h.
+ */
+
+/**
+ * Includes
+ */
+#include "transtune.h"
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/**
+ * Prints the program usage to the screen.
+ */
+void printUsage(void) {
+    printf(
+            "\nUsage: ./csim-tune [-hv] [-z <sizes>] [-p <policy>] [-s <s>] [-E <E>] [-b <b>]\n"
+            "\t-h: Optional help flag that prints usage info\n"
+            "\t-v: Optional verbose flag that prints every variant\n"
+            "\t-z <sizes>: Optional comma separated MxN sizes, at most\n"
+            "\t            256x256 (default 32x32,64x64,61x67)\n"
+            "\t-p <policy>: Optional replacement policy (default lru)\n"
+            "\t-s <s>, -E <E>, -b <b>: Optional cache geometry (default 5, 1, 5)\n"
+    );
+}
+
+/**
+ * Prints one scored variant.
+ */
+static void printVariant(const transVariant_t *variant) {
+    char name[64];
+
+    transVariantName(variant, name, sizeof(name));
+    printf("  %-24s hits:%u misses:%u evictions:%u\n", name, variant->hits,
+            variant->misses, variant->evictions);
+}
+
+/**
+ * Main body - tunes the kernel for every size.
+ *
+ * @param argc number of command-line options
+ * @param argv arguments of command-line options
+ * @return EXIT_FAILURE or EXIT_SUCCESS depending on runtime conditions
+ */
+int main(int argc, char * argv[])
+{
+    int columns[TRANS_MAX_SIZES], rows[TRANS_MAX_SIZES];
+    const char *sizes = "32x32,64x64,61x67";
+    cachePolicy_t policy = CACHE_LRU;
+    uint8_t setBits = 5, associativity = 1, blockBits = 5;
+    transVariant_t best;
+    char name[64];
+    size_t count, i;
+    bool verbose = false, success = true;
+    int option;
+
+    while ((option = getopt(argc, argv, "hvz:p:s:E:b:")) != -1)
+        switch (option) {
+            case 'v': verbose = true; break;
+            case 'z': sizes = optarg; break;
+            case 'p':
+                policy = cachePolicyByName(optarg);
+                if (policy == CACHE_POLICIES) {
+                    fprintf(stderr, "%s: unknown policy %s\n", argv[0], optarg);
+                    return (EXIT_FAILURE);
+                }
+                break;
+            case 's':
+            case 'E':
+            case 'b':
+                if (!transParseGeometry(argv[0], option, optarg, &setBits,
+                        &associativity, &blockBits))
+                    return (EXIT_FAILURE);
+                break;
+            default:
+                printUsage();
+                return (EXIT_FAILURE);
+        }
+
+    if (!transCheckGeometry(argv[0], setBits, blockBits))
+        return (EXIT_FAILURE);
+    count = transParseSizes(sizes, columns, rows, TRANS_MAX_SIZES);
+    if (count == 0) {
+        fprintf(stderr, "%s: invalid sizes %s\n", argv[0], sizes);
+        printUsage();
+        return (EXIT_FAILURE);
+    }
+    for (i = 0; i < count; i++)
+        if (columns[i] > TRANS_MAX_DIM || rows[i] > TRANS_MAX_DIM) {
+            fprintf(stderr, "%s: %dx%d is larger than the %dx%d that can be "
+                    "simulated\n", argv[0], columns[i], rows[i],
+                    TRANS_MAX_DIM, TRANS_MAX_DIM);
+            return (EXIT_FAILURE);
+        }
+
+    for (i = 0; i < count; i++) {
+        if (verbose)
+            printf("M=%d N=%d s=%u E=%u b=%u\n", columns[i], rows[i], setBits,
+                    associativity, blockBits);
+        if (!transTune(columns[i], rows[i], setBits, associativity, blockBits,
+                policy, verbose ? printVariant : NULL, &best)) {
+            fprintf(stderr, "%s: cannot tune %dx%d\n", argv[0], columns[i],
+                    rows[i]);
+            success = false;
+            continue;
+        }
+        transVariantName(&best, name, sizeof(name));
+        printf("%dx%d best %s hits:%u misses:%u evictions:%u\n", columns[i],
+                rows[i], name, best.hits, best.misses, best.evictions);
+    }
+    return success ? (EXIT_SUCCESS) : (EXIT_FAILURE);
+}
@@ -14,17 +14,27 @@
  */
 #include "cachelab.h"
 #include "csim.h"
+#include "checkpoint.h"
+#include "coherence.h"
+#include "classify.h"
+#include "eventlog.h"
+#include "hierarchy.h"
+#include "optimal.h"
+#include "prefetch.h"
+#include "profile.h"
+#include "reuse.h"
+#include "sample.h"
+#include "shard.h"
+#include "stackdist.h"
+#include "stream.h"
+#include <errno.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <math.h>
 #include <unistd.h>
 #include <getopt.h>
 #include <ctype.h>
-
-/**
- * Defines
- */
-#define BUFFER_SIZE 80
+#include <string.h>
 
 void debugArgs(argument_t *args) {
     printf(
@@ -100,12 +110,40 @@ int main(int argc, char * argv[])
     flags.associativity = false;
     flags.blockBits = false;
     flags.traceFile = false;
+    flags.threads = false;
+    flags.policy = false;
+    flags.config = false;
+    flags.cores = false;
+    flags.prefetch = false;
+    flags.profile = false;
+    flags.regions = false;
+    flags.reuse = false;
+    flags.sample = false;
+    flags.checkpoint = false;
+    flags.restore = false;
+    flags.write = false;
+    flags.classify = false;
+    flags.eventLog = false;
+    flags.index = false;
 
     argument_t args;	
     args.setBits = NULL;
     args.associativity = NULL;
     args.blockBits = NULL;
     args.traceFile = NULL;
+    args.threads = NULL;
+    args.policy = NULL;
+    args.config = NULL;
+    args.cores = NULL;
+    args.prefetch = NULL;
+    args.profile = NULL;
+    args.regions = NULL;
+    args.sample = NULL;
+    args.checkpoint = NULL;
+    args.restore = NULL;
+    args.write = NULL;
+    args.eventLog = NULL;
+    args.index = NULL;
 
     Cache cache;
     cache.associativity = 0;
@@ -114,11 +152,49 @@ int main(int argc, char * argv[])
     cache.setBits = 0;
     cache.setSize = 0;
     cache.tags = NULL;
+    cache.meta = NULL;
+    cache.valid = NULL;
+    cache.dirty = NULL;
+    cache.setMeta = NULL;
         
     printf("Reading options...\n");
     
     if(!getOptions(argc, argv, &flags, &args))
             return (EXIT_FAILURE);
+
+    if(flags.config)
+        return readAndSimulateHierarchy(&args) ? EXIT_SUCCESS : EXIT_FAILURE;
+
+    if(flags.reuse)
+        return readAndProfileReuse(&args) ? EXIT_SUCCESS : EXIT_FAILURE;
+
+    if(flags.policy && strcmp(args.policy, "opt") == 0
+            && !strpbrk(args.setBits, ",-")
+            && !strpbrk(args.associativity, ",-")
+            && !strpbrk(args.blockBits, ",-"))
+        return readAndSimulateOptimal(&args) ? EXIT_SUCCESS : EXIT_FAILURE;
+
+    // Lists or ranges in -s/-E/-b select the single-pass sweep.
+    if(!flags.restore && (strpbrk(args.setBits, ",-")
+            || strpbrk(args.associativity, ",-")
+            || strpbrk(args.blockBits, ",-")))
+    {
+        if(flags.policy && cachePolicyByName(args.policy) != CACHE_LRU) {
+            fprintf(stderr, "%s: lists in -s/-E/-b require -p lru\n", argv[0]);
+            return (EXIT_FAILURE);
+        }
+        // The sweep only counts hits, misses and evictions.
+        if(flags.verbose || flags.threads || flags.cores || flags.prefetch
+                || flags.profile || flags.regions || flags.sample
+                || flags.checkpoint || flags.write || flags.eventLog
+                || flags.index || flags.classify) {
+            fprintf(stderr, "%s: lists in -s/-E/-b cannot be combined with "
+                    "-v, -j, -m, -P, -H, -R, -S, -k, -w, -L, -i or -C\n",
+                    argv[0]);
+            return (EXIT_FAILURE);
+        }
+        return readAndSweepTraceFile(&args) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
     
     printf(
             "Options read.\n"
@@ -126,14 +202,22 @@ int main(int argc, char * argv[])
     );
        
     // We now MUST make sure we free the memory we've dynamically allocated.
-    optionsToCache(&args, &cache);
+    if(!optionsToCache(&args, &cache))
+            return (EXIT_FAILURE);
+
+    if(flags.cores)
+    {
+        bool success = readAndSimulateCoherence(&args, &cache);
+        freeCacheTags(&cache);
+        return success ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
     
     printf(
             "Cache created.\n"
             "Parsing trace file...\n"
     );
     
-    if(!readAndParseTraceFile(&args,&cache)) 
+    if(!readAndParseTraceFile(&flags,&args,&cache)) 
     {
         freeCacheTags(&cache);
         return (EXIT_FAILURE);
@@ -141,8 +225,13 @@ int main(int argc, char * argv[])
 
     printf(
             "Trace file parsed.\n"
-            "Freeing cache memory...\n"
     );
+
+    // -P, -H and -S count their own accesses and leave the write state.
+    if(!flags.prefetch && !flags.profile && !flags.sample)
+        cachePrintTraffic(&cache, stdout);
+
+    printf("Freeing cache memory...\n");
     
     freeCacheTags(&cache);
 
@@ -150,64 +239,199 @@ int main(int argc, char * argv[])
 
     
     // pass to printSummary the number of hits, misses and evictions
-    //printSummary(0, 0, 0);
+    printSummary(cache.hits, cache.misses, cache.evictions);
     return (EXIT_SUCCESS);
 }
 
 /**
- * Creates a Cache based on options and arguments gathered by getOptions().
- * <p>
- * This function dynamically allocates data onto the heap. Be sure to call
- * freeCacheTags() to free memory and avoid memory leaks.
+ * Parses a whole decimal number that must lie in [min, max].
+ *
+ * @return true if text is such a number
  */
-void optionsToCache(argument_t *args, Cache *cache) {
-    cache->associativity = atoi(args->associativity);
-    cache->blockBits = atoi(args->blockBits);
-    cache->blockSize = pow(2,cache->blockBits);
-    cache->setBits = atoi(args->setBits);
-    cache->setSize = pow(2,cache->setBits);
-    cache->tags = (uint64_t **) malloc(cache->setSize*sizeof(uint64_t *));
-    uint64_t set;
-    for(set=0; set<cache->setSize; set++)
-        cache->tags[set] = (uint64_t *) malloc(cache->associativity*sizeof(uint64_t));
-    
-    uint8_t associativity;
-    for(set=0; set<cache->setSize; set++)
-        for(associativity=0; associativity<cache->associativity; associativity++)
-            cache->tags[set][associativity]=-1;
+static bool parseNumber(const char *text, long min, long max, long *value) {
+    char *end;
+
+    errno = 0;
+    *value = strtol(text, &end, 10);
+    return end != text && *end == '\0' && errno == 0 && *value >= min
+            && *value <= max;
 }
 
 /**
- * Frees the dynamically allocated data from the heap that was created when
- * calling optionsToCache().
+ * Parses the -s, -E and -b command-line options of a single cache.
  */
-void freeCacheTags(Cache *cache) {
-    uint64_t set;
-    for(set=0; set<cache->setSize; set++)
-        free(cache->tags[set]);
-    free(cache->tags);
+bool optionsToGeometry(argument_t *args, long maxWays, long *setBits,
+        long *associativity, long *blockBits) {
+    if(!parseNumber(args->setBits, 0, CACHE_MAX_SET_BITS, setBits)
+            || !parseNumber(args->associativity, 1, maxWays, associativity)
+            || !parseNumber(args->blockBits, 0, 63 - *setBits, blockBits)) {
+        fprintf(stderr, "Unsupported cache geometry -s %s -E %s -b %s (s "
+                "must be 0-%d, E 1-%ld and s + b below 64)\n",
+                args->setBits, args->associativity, args->blockBits,
+                CACHE_MAX_SET_BITS, maxWays);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Creates a Cache based on options and arguments gathered by getOptions(),
+ * or restores it from the checkpoint of the -l command-line option.
+ * <p>
+ * This function dynamically allocates data onto the heap. Be sure to call
+ * freeCacheTags() to free memory and avoid memory leaks.
+ */
+bool optionsToCache(argument_t *args, Cache *cache) {
+    cachePolicy_t policy = args->policy
+            ? cachePolicyByName(args->policy) : CACHE_LRU;
+    long setBits, associativity, blockBits;
+
+    if(args->restore) {
+        checkpointConfig_t config;
+        checkpoint_t header;
+
+        if(!checkpointParse(args->restore, &config)
+                || !checkpointLoad(config.path, cache, &header))
+            return false;
+        // A warm start keeps the contents but counts from zero.
+        if(config.warm) {
+            cache->hits = cache->misses = cache->evictions = 0;
+            cache->fills = cache->writebacks = cache->writeBytes = 0;
+        }
+        return true;
+    }
+
+    // Range-check before the values are narrowed to uint8_t.
+    if(!optionsToGeometry(args, CACHE_MAX_WAYS, &setBits, &associativity,
+            &blockBits))
+        return false;
+    if(!cacheCreate(cache, setBits, associativity, blockBits, policy)) {
+        fprintf(stderr, "Out of memory creating the cache\n");
+        return false;
+    }
+    // getOptions() has already checked the name.
+    if(args->write)
+        cacheSetWritePolicy(cache, args->write);
+    if(args->index && !cacheSetIndex(cache, args->index)) {
+        fprintf(stderr, "Unknown index function %s (slice takes 1-%d masks, "
+                "at most s)\n", args->index, CACHE_MAX_SLICE_BITS);
+        freeCacheTags(cache);
+        return false;
+    }
+    return true;
 }
 
 /**
  * Prints the program usage to the screen.
  * <p>
- * Usage: ./csim-ref [-hv] -s <s> -E <E> -b <b> -t <tracefile>
+ * Usage: ./csim-ref [-hvrC] [-j <threads>] [-p <policy>] [-c <config>] [-m <cores>] [-P <prefetcher>] [-H <output> [-R <regions>]] [-S <sampling>] [-k <checkpoint>] [-l <checkpoint>] [-w <write>] [-L <eventlog>] [-i <index>] -s <s> -E <E> -b <b> -t <tracefile>
  * -h: Optional help flag that prints usage info
  * -v: Optional verbose flag that displays trace info
+ * -r: Optional reuse distance histogram at the -b block size; -s and -E
+ *     are not needed
+ * -C: Optional classification of every miss as compulsory, capacity or
+ *     conflict
  * -s <s>: Number of set index bits (S = 2^s is the number of sets)
  * -E <E>: Associativity (number of lines per set)
  * -b <b>: Number of block bits (B = 2^b is the block size)
- * -t <tracefile>: Name of the valgrind trace to replay
+ * -t <tracefile>: Name of the valgrind trace to replay ("-" for stdin)
+ * -j <threads>: Optional number of threads to shard the sets across
+ * -p <policy>: Optional replacement policy: lru (default), fifo, random,
+ *              plru, srrip, brrip or lfu, or opt for Belady's offline
+ *              optimum (reads -t twice, so not from stdin)
+ * -c <config>: Optional cache hierarchy config file used instead of -s/-E/-b;
+ *              DTLB and STLB lines add data TLBs and page walks
+ * -m <cores>: Optional number of cores with MESI-coherent private caches;
+ *             -t then takes one trace per core ("a,b,...") or one trace
+ *             whose lines end in a thread id
+ * -P <prefetcher>: Optional prefetcher: nextline, stride or stream, followed
+ *                  by ",key=value" options degree, distance, latency (in
+ *                  accesses) and streams, e.g. "stride,degree=2,distance=4"
+ * -H <output>: Optional per-set and per-region access/miss/eviction counters,
+ *              written as CSV, or JSON if output ends in ".json"
+ * -R <regions>: Optional region map file ("start end name" or nm -S lines)
+ *               whose regions -H counts misses against
+ * -S <sampling>: Optional sampled simulation with extrapolated counters:
+ *                "sets=N" keeps 1/N of the sets, "period=P,warmup=W,
+ *                measure=M" measures M of every P data records after W
+ *                warm-up records; both may be combined
+ * -k <checkpoint>: Optional checkpoint file the cache and trace position are
+ *                  saved to every N records (",every=N", default 100000000)
+ *                  and at the end of the trace
+ * -l <checkpoint>: Optional checkpoint to resume from; -s, -E, -b and -p come
+ *                  from it. With ",warm" only the cache contents are kept and
+ *                  -t is simulated from its start with zeroed counters
+ * -w <write>: Optional write policy: back (default) or through, followed by
+ *             ",allocate" (default) or ",noallocate"; the bytes read from
+ *             and written to the next level are printed after the run
+ * -L <eventlog>: Optional binary log of the outcome of every data access,
+ *                rendered like -v by csim-events at a fraction of its cost
+ * -i <index>: Optional set index function: modulo (default), xor, prime, or
+ *             slice followed by one ",mask" of address bits per slice index
+ *             bit, whose parity selects the slice like the hash of a sliced
+ *             last-level cache
+ * <p>
+ * -s, -E and -b also accept lists and ranges ("1,2,4", "0-8") to simulate
+ * every combination in a single pass over the trace, with LRU replacement
+ * and none of -v, -j, -m, -P, -H, -R, -S, -k, -w, -L, -i and -C.
  */
 void printUsage(void){
     printf(
-            "\nUsage: ./csim-ref [-hv] -s <s> -E <E> -b <b> -t <tracefile>\n"
+            "\nUsage: ./csim-ref [-hvrC] [-j <threads>] [-p <policy>] [-c <config>] [-m <cores>] [-P <prefetcher>] [-H <output> [-R <regions>]] [-S <sampling>] [-k <checkpoint>] [-l <checkpoint>] [-w <write>] [-L <eventlog>] [-i <index>] -s <s> -E <E> -b <b> -t <tracefile>\n"
             "\t-h: Optional help flag that prints usage info\n"
             "\t-v: Optional verbose flag that displays trace info\n"
+            "\t-r: Optional reuse distance histogram at the -b block size;\n"
+            "\t    -s and -E are not needed\n"
+            "\t-C: Optional classification of every miss as compulsory,\n"
+            "\t    capacity or conflict\n"
             "\t-s <s>: Number of set index bits (S = 2^s is the number of sets)\n"
             "\t-E <E>: Associativity (number of lines per set)\n"
             "\t-b <b>: Number of block bits (B = 2^b is the block size)\n"
-            "\t-t <tracefile>: Name of the valgrind trace to replay\n"
+            "\t-t <tracefile>: Name of the valgrind trace to replay (\"-\" for stdin)\n"
+            "\t-j <threads>: Optional number of threads to shard the sets across\n"
+            "\t-p <policy>: Optional replacement policy: lru (default), fifo,\n"
+            "\t             random, plru, srrip, brrip or lfu, or opt for\n"
+            "\t             Belady's offline optimum (reads -t twice, so not\n"
+            "\t             from stdin)\n"
+            "\t-c <config>: Optional cache hierarchy config file used instead\n"
+            "\t             of -s/-E/-b; DTLB and STLB lines add data TLBs\n"
+            "\t             and page walks\n"
+            "\t-m <cores>: Optional number of cores with MESI-coherent private\n"
+            "\t            caches; -t then takes one trace per core (\"a,b,...\")\n"
+            "\t            or one trace whose lines end in a thread id\n"
+            "\t-P <prefetcher>: Optional prefetcher: nextline, stride or stream,\n"
+            "\t                 followed by \",key=value\" options degree, distance,\n"
+            "\t                 latency (in accesses) and streams,\n"
+            "\t                 e.g. \"stride,degree=2,distance=4\"\n"
+            "\t-H <output>: Optional per-set and per-region access/miss/eviction\n"
+            "\t             counters, written as CSV, or JSON if output ends in\n"
+            "\t             \".json\"\n"
+            "\t-R <regions>: Optional region map file (\"start end name\" or\n"
+            "\t              nm -S lines) whose regions -H counts misses against\n"
+            "\t-S <sampling>: Optional sampled simulation with extrapolated\n"
+            "\t               counters: \"sets=N\" keeps 1/N of the sets,\n"
+            "\t               \"period=P,warmup=W,measure=M\" measures M of every\n"
+            "\t               P data records after W warm-up records; both may\n"
+            "\t               be combined\n"
+            "\t-k <checkpoint>: Optional checkpoint file the cache and trace\n"
+            "\t                 position are saved to every N records\n"
+            "\t                 (\",every=N\", default 100000000) and at the end\n"
+            "\t-l <checkpoint>: Optional checkpoint to resume from; -s, -E, -b\n"
+            "\t                 and -p come from it. With \",warm\" only the cache\n"
+            "\t                 contents are kept and -t starts over with\n"
+            "\t                 zeroed counters\n"
+            "\t-w <write>: Optional write policy: back (default) or through,\n"
+            "\t            followed by \",allocate\" (default) or \",noallocate\";\n"
+            "\t            traffic to the next level is printed after the run\n"
+            "\t-L <eventlog>: Optional binary log of the outcome of every data\n"
+            "\t               access, rendered like -v by csim-events\n"
+            "\t-i <index>: Optional set index function: modulo (default), xor,\n"
+            "\t            prime, or slice followed by one \",mask\" of address\n"
+            "\t            bits per slice index bit (sliced last-level caches)\n"
+            "\n-s, -E and -b also accept lists and ranges (e.g. -s 0-8 -E 1,2,4)\n"
+            "to simulate every combination in a single LRU pass. Lists\n"
+            "cannot be combined with -v, -j, -m, -P, -H, -R, -S, -k, -w,\n"
+            "-L, -i or -C.\n"
     );
 }
 
@@ -225,7 +449,7 @@ bool getOptions(int argc, char *argv[], flag_t *flags, argument_t *args) {
     extern char *optarg; 
     char option;
 
-    while ((option = getopt (argc, argv, "hvs:E:b:t:")) != -1)
+    while ((option = getopt (argc, argv, "hvrCs:E:b:t:j:p:c:m:P:H:R:S:k:l:w:L:i:")) != -1)
             switch (option)
             {
                     case 'h':
@@ -235,6 +459,12 @@ bool getOptions(int argc, char *argv[], flag_t *flags, argument_t *args) {
                     case 'v':
                             flags->verbose = true;
                             break;
+                    case 'r':
+                            flags->reuse = true;
+                            break;
+                    case 'C':
+                            flags->classify = true;
+                            break;
                     case 's':
                             flags->setBits = true;
                             args->setBits = optarg;
@@ -251,12 +481,77 @@ bool getOptions(int argc, char *argv[], flag_t *flags, argument_t *args) {
                             flags->traceFile = true;
                             args->traceFile = optarg;
                             break;
+                    case 'j':
+                            flags->threads = true;
+                            args->threads = optarg;
+                            break;
+                    case 'p':
+                            flags->policy = true;
+                            args->policy = optarg;
+                            break;
+                    case 'c':
+                            flags->config = true;
+                            args->config = optarg;
+                            break;
+                    case 'm':
+                            flags->cores = true;
+                            args->cores = optarg;
+                            break;
+                    case 'P':
+                            flags->prefetch = true;
+                            args->prefetch = optarg;
+                            break;
+                    case 'H':
+                            flags->profile = true;
+                            args->profile = optarg;
+                            break;
+                    case 'R':
+                            flags->regions = true;
+                            args->regions = optarg;
+                            break;
+                    case 'S':
+                            flags->sample = true;
+                            args->sample = optarg;
+                            break;
+                    case 'k':
+                            flags->checkpoint = true;
+                            args->checkpoint = optarg;
+                            break;
+                    case 'l':
+                            flags->restore = true;
+                            args->restore = optarg;
+                            break;
+                    case 'w':
+                            flags->write = true;
+                            args->write = optarg;
+                            break;
+                    case 'L':
+                            flags->eventLog = true;
+                            args->eventLog = optarg;
+                            break;
+                    case 'i':
+                            flags->index = true;
+                            args->index = optarg;
+                            break;
                     case '?':
                             switch(optopt) {
                                     case 's':
                                     case 'E':
                                     case 'b':
                                     case 't':
+                                    case 'j':
+                                    case 'p':
+                                    case 'c':
+                                    case 'm':
+                                    case 'P':
+                                    case 'H':
+                                    case 'R':
+                                    case 'S':
+                                    case 'k':
+                                    case 'l':
+                                    case 'w':
+                                    case 'L':
+                                    case 'i':
                                             // fprintf (stderr, "Option -%c requires an argument.\n", optopt);
                                             printUsage();
                                             return false;
@@ -278,13 +573,104 @@ bool getOptions(int argc, char *argv[], flag_t *flags, argument_t *args) {
                             return false;
             }
 
-    if (!flags->setBits) {	/* -s is missing and mandatory */
+    if ((flags->checkpoint || flags->restore) && (flags->config
+            || flags->reuse || flags->threads || flags->cores
+            || flags->prefetch || flags->profile || flags->sample)) {
+            fprintf(stderr, "%s: -k and -l only apply to plain runs\n",
+                    argv[0]);
+            printUsage();
+            return false;
+    }
+    if (flags->restore && (flags->setBits || flags->associativity
+            || flags->blockBits || flags->policy)) {
+            fprintf(stderr, "%s: -l takes -s, -E, -b and -p from the "
+                    "checkpoint\n", argv[0]);
+            printUsage();
+            return false;
+    }
+    if (flags->write && (flags->config || flags->reuse || flags->cores
+            || flags->prefetch || flags->profile || flags->sample)) {
+            fprintf(stderr, "%s: -w only applies to plain runs\n", argv[0]);
+            printUsage();
+            return false;
+    }
+    if (flags->classify && (flags->config || flags->reuse || flags->cores
+            || flags->prefetch || flags->profile || flags->sample
+            || flags->checkpoint || flags->restore || flags->threads
+            || flags->verbose)) {
+            fprintf(stderr, "%s: -C only applies to plain quiet runs\n",
+                    argv[0]);
+            printUsage();
+            return false;
+    }
+    if (flags->eventLog && (flags->config || flags->reuse || flags->cores
+            || flags->prefetch || flags->profile || flags->sample
+            || flags->checkpoint || flags->restore || flags->threads
+            || flags->classify || flags->verbose)) {
+            fprintf(stderr, "%s: -L only applies to plain quiet runs\n",
+                    argv[0]);
+            printUsage();
+            return false;
+    }
+    if (flags->index && (flags->config || flags->reuse || flags->cores
+            || flags->sample || flags->checkpoint || flags->restore)) {
+            fprintf(stderr, "%s: -i does not apply to -c, -r, -m, -S, -k or "
+                    "-l runs\n", argv[0]);
+            printUsage();
+            return false;
+    }
+    if ((flags->prefetch || flags->profile || flags->sample)
+            && (flags->threads || flags->verbose)) {
+            fprintf(stderr, "%s: -P, -H and -S cannot be combined with -j or "
+                    "-v\n", argv[0]);
+            printUsage();
+            return false;
+    }
+    if (flags->write && flags->restore) {
+            fprintf(stderr, "%s: -l takes -w from the checkpoint\n",
+                    argv[0]);
+            printUsage();
+            return false;
+    }
+    if (flags->write) {
+            Cache probe;
+
+            if (!cacheSetWritePolicy(&probe, args->write)) {
+                    fprintf(stderr, "%s: unknown write policy %s\n",
+                            argv[0], args->write);
+                    printUsage();
+                    return false;
+            }
+    }
+    if (flags->threads) {
+            char *end;
+            long threads = strtol(args->threads, &end, 10);
+
+            if (end == args->threads || *end != '\0' || threads < 1
+                    || threads > SHARD_MAX_THREADS) {
+                    fprintf(stderr, "%s: -j takes 1-%d threads, not %s\n",
+                            argv[0], SHARD_MAX_THREADS, args->threads);
+                    printUsage();
+                    return false;
+            }
+    }
+    if (flags->checkpoint && flags->traceFile
+            && strcmp(args->traceFile, "-") == 0) {
+            fprintf(stderr, "%s: -k cannot checkpoint a trace read from "
+                    "stdin\n", argv[0]);
+            return false;
+    }
+    if (flags->restore && flags->traceFile)	/* -l replaces -s/-E/-b */
+            return true;
+    if (flags->config && flags->traceFile)	/* -c replaces -s/-E/-b */
+            return true;
+    if (!flags->setBits && !flags->reuse) {	/* -s is missing and mandatory */
             fprintf(stderr, "%s: missing -s option\n", argv[0]);
             printUsage();
             // fprintf(stderr, usage, argv[0]);
             return false;
     }
-    if (!flags->associativity) {	/* -E is missing and mandatory */
+    if (!flags->associativity && !flags->reuse) {	/* -E is missing and mandatory */
             fprintf(stderr, "%s: missing -E option\n", argv[0]);
             printUsage();
             // fprintf(stderr, usage, argv[0]);
@@ -296,6 +682,44 @@ bool getOptions(int argc, char *argv[], flag_t *flags, argument_t *args) {
             // fprintf(stderr, usage, argv[0]);
             return false;
     }
+    if (flags->policy && strcmp(args->policy, "opt") == 0) {
+            if (flags->verbose || flags->threads || flags->config
+                    || flags->cores || flags->prefetch || flags->profile
+                    || flags->sample || flags->checkpoint || flags->classify
+                    || flags->write || flags->reuse || flags->eventLog
+                    || flags->index) {
+                    fprintf(stderr, "%s: -p opt only applies to plain quiet "
+                            "runs\n", argv[0]);
+                    printUsage();
+                    return false;
+            }
+            if (flags->traceFile && strcmp(args->traceFile, "-") == 0) {
+                    fprintf(stderr, "%s: -p opt cannot read a trace from "
+                            "stdin\n", argv[0]);
+                    return false;
+            }
+    } else if (flags->policy
+            && cachePolicyByName(args->policy) == CACHE_POLICIES) {
+            fprintf(stderr, "%s: unknown policy %s\n", argv[0], args->policy);
+            printUsage();
+            return false;
+    }
+    if (flags->regions && !flags->profile) {	/* -R only feeds -H */
+            fprintf(stderr, "%s: -R requires -H\n", argv[0]);
+            printUsage();
+            return false;
+    }
+    if (flags->profile && flags->prefetch) {
+            fprintf(stderr, "%s: -H cannot be combined with -P\n", argv[0]);
+            printUsage();
+            return false;
+    }
+    if (flags->sample && (flags->prefetch || flags->profile)) {
+            fprintf(stderr, "%s: -S cannot be combined with -P or -H\n",
+                    argv[0]);
+            printUsage();
+            return false;
+    }
     if (!flags->traceFile) {	/* -t is missing and mandatory */
             fprintf(stderr, "%s: missing -t option\n", argv[0]);
             printUsage();
@@ -305,101 +729,721 @@ bool getOptions(int argc, char *argv[], flag_t *flags, argument_t *args) {
     return true;
 }
 
+/**
+ * Simulates one trace record and prints it with its outcome, in the
+ * "L 10,1 miss eviction" format of csim-ref -v.
+ * 
+ * @param trace valgrind data to be used
+ * @param cache the cache to access
+ */
+static void printAccess(const trace_t *trace, Cache *cache) {
+    char line[EVENT_LINE_SIZE];
+    event_t event;
+
+    eventSimulate(cache, trace, &event);
+    fwrite(line, eventFormat(&event, false, line), 1, stdout);
+}
+
+/**
+ * Batch consumer for verbose runs: prints every data access.
+ */
+static void printBatch(void *cache, const trace_t *batch, size_t count) {
+    size_t i;
+
+    for (i = 0; i < count; i++)
+        if (batch[i].operation != 'I')
+            printAccess(&batch[i], cache);
+}
+
+/**
+ * Batch consumer for quiet runs.
+ */
+static void simulateBatch(void *cache, const trace_t *batch, size_t count) {
+    cacheSimulateBatch(cache, batch, count);
+}
+
+/**
+ * Batch consumer for -P runs.
+ */
+static void prefetchBatch(void *prefetcher, const trace_t *batch,
+        size_t count) {
+    prefetchSimulateBatch(prefetcher, batch, count);
+}
+
+/**
+ * Batch consumer for -H runs.
+ */
+static void profileBatch(void *profile, const trace_t *batch, size_t count) {
+    profileSimulateBatch(profile, batch, count);
+}
+
+/**
+ * Batch consumer for -S runs.
+ */
+static void sampleBatch(void *sampler, const trace_t *batch, size_t count) {
+    samplerSimulateBatch(sampler, batch, count);
+}
+
+/**
+ * Batch consumer for -C runs.
+ */
+static void classifyBatch(void *classifier, const trace_t *batch,
+        size_t count) {
+    classifySimulateBatch(classifier, batch, count);
+}
+
+/**
+ * Batch consumer for -L runs.
+ */
+static void eventBatch(void *log, const trace_t *batch, size_t count) {
+    eventLogBatch(log, batch, count);
+}
+
+/**
+ * State of a checkpointed run.
+ */
+typedef struct checkpointRun_t {
+    Cache *cache;
+    traceReader_t *reader;
+    checkpointConfig_t config;
+    uint64_t records;
+    uint64_t next;
+    bool save;
+    bool verbose;
+    bool error;
+} checkpointRun_t;
+
+/**
+ * Batch consumer for -k and -l runs. The reader has just produced the
+ * batch, so its position is exactly where a resumed run must start.
+ */
+static void checkpointBatch(void *context, const trace_t *batch,
+        size_t count) {
+    checkpointRun_t *run = context;
+
+    if (run->verbose)
+        printBatch(run->cache, batch, count);
+    else
+        cacheSimulateBatch(run->cache, batch, count);
+    run->records += count;
+    if (run->save && run->records >= run->next && !run->reader->error) {
+        run->error |= !checkpointSave(run->config.path, run->cache,
+                run->reader, run->records);
+        run->next = run->records + run->config.every;
+    }
+}
+
+/**
+ * Batch consumer for -s/-E/-b list runs.
+ */
+static void sweepBatch(void *sweep, const trace_t *batch, size_t count) {
+    stackSweepBatch(sweep, batch, count);
+}
+
+/**
+ * Hands every batch of the trace to consume. Traces streamed from stdin are
+ * parsed on a reader thread so parsing overlaps simulation.
+ * 
+ * @param reader the trace to read records from
+ * @param consume the callback to pass each batch to
+ * @param context first argument of consume
+ * @return true if the whole trace was read without issue
+ */
+static bool consumeTrace(traceReader_t *reader, streamConsumer_t consume,
+        void *context) {
+    static trace_t batch[TRACE_BATCH_SIZE];
+    size_t count;
+
+    if (reader->stream)
+        return streamPipeline(reader, consume, context);
+
+    while ((count = traceNextBatch(reader, batch, TRACE_BATCH_SIZE)) > 0)
+        consume(context, batch, count);
+    return !reader->error;
+}
+
+/**
+ * Simulates the trace with the checkpoints of -k, resuming from the one of
+ * -l unless it is a warm start.
+ * 
+ * @return true if the trace is read and every checkpoint saved
+ */
+static bool checkpointTrace(flag_t *flags, argument_t *args, Cache *cache,
+        traceReader_t *reader) {
+    checkpointConfig_t restore;
+    checkpoint_t header;
+    checkpointRun_t run;
+    bool success;
+
+    memset(&run, 0, sizeof(run));
+    run.cache = cache;
+    run.reader = reader;
+    run.verbose = flags->verbose;
+
+    if (flags->restore) {
+        if (!checkpointParse(args->restore, &restore)
+                || !checkpointReadHeader(restore.path, &header))
+            return false;
+        if (!restore.warm) {
+            if (!checkpointSeek(&header, reader))
+                return false;
+            run.records = header.records;
+        }
+    }
+    if (flags->checkpoint) {
+        if (!checkpointParse(args->checkpoint, &run.config))
+            return false;
+        run.save = true;
+        run.next = run.records + run.config.every;
+    }
+
+    success = consumeTrace(reader, checkpointBatch, &run) && !run.error;
+    if (success && run.save)
+        success = checkpointSave(run.config.path, cache, reader, run.records);
+    return success;
+}
+
+/**
+ * Single-threaded way of simulating the trace: a batch consumer, then a
+ * report printed if the whole trace was read, then the release of the
+ * consumer's state. report and release may be NULL.
+ */
+typedef struct traceMode_t {
+    streamConsumer_t consume;
+    bool (*report)(void *context, argument_t *args, Cache *cache);
+    bool (*release)(void *context);
+} traceMode_t;
+
+/**
+ * Reports a -P run.
+ */
+static bool prefetchReport(void *prefetcher, argument_t *args, Cache *cache) {
+    (void) args;
+    (void) cache;
+    prefetchPrint(prefetcher, stdout);
+    return true;
+}
+
+/**
+ * Releases a -P run.
+ */
+static bool prefetchRelease(void *prefetcher) {
+    prefetchFree(prefetcher);
+    return true;
+}
+
+/**
+ * Reports a -S run; the summary then shows the extrapolated counters.
+ */
+static bool sampleReport(void *sampler, argument_t *args, Cache *cache) {
+    double halfWidth;
+
+    (void) args;
+    samplerPrint(sampler, stdout);
+    cache->hits = llround(samplerEstimate(sampler, SAMPLE_HITS, &halfWidth));
+    cache->misses = llround(samplerEstimate(sampler, SAMPLE_MISSES,
+            &halfWidth));
+    cache->evictions = llround(samplerEstimate(sampler, SAMPLE_EVICTIONS,
+            &halfWidth));
+    return true;
+}
+
+/**
+ * Releases a -S run.
+ */
+static bool sampleRelease(void *sampler) {
+    samplerFree(sampler);
+    return true;
+}
+
+/**
+ * Writes and reports a -H run.
+ */
+static bool profileReport(void *profile, argument_t *args, Cache *cache) {
+    (void) cache;
+    if (!profileWrite(profile, args->profile))
+        return false;
+    profilePrint(profile, stdout);
+    return true;
+}
+
+/**
+ * Releases a -H run.
+ */
+static bool profileRelease(void *profile) {
+    profileFree(profile);
+    return true;
+}
+
+/**
+ * Reports a -C run.
+ */
+static bool classifyReport(void *classifier, argument_t *args,
+        Cache *cache) {
+    (void) args;
+    (void) cache;
+    classifyPrint(classifier, stdout);
+    return true;
+}
+
+/**
+ * Releases a -C run.
+ */
+static bool classifyRelease(void *classifier) {
+    classifyFree(classifier);
+    return true;
+}
+
+/**
+ * Reports a -L run.
+ */
+static bool eventReport(void *log, argument_t *args, Cache *cache) {
+    (void) cache;
+    printf("%" PRIu64 " events logged to %s\n", ((eventLog_t *) log)->events,
+            args->eventLog);
+    return true;
+}
+
+/**
+ * Releases a -L run, flushing the rest of the log.
+ */
+static bool eventRelease(void *log) {
+    return eventLogClose(log);
+}
+
+static const traceMode_t prefetchMode = {
+    prefetchBatch, prefetchReport, prefetchRelease
+};
+static const traceMode_t sampleMode = {
+    sampleBatch, sampleReport, sampleRelease
+};
+static const traceMode_t profileMode = {
+    profileBatch, profileReport, profileRelease
+};
+static const traceMode_t classifyMode = {
+    classifyBatch, classifyReport, classifyRelease
+};
+static const traceMode_t eventMode = { eventBatch, eventReport, eventRelease };
+static const traceMode_t verboseMode = { printBatch, NULL, NULL };
+static const traceMode_t quietMode = { simulateBatch, NULL, NULL };
+
+/**
+ * Simulates the trace in one mode and closes the reader.
+ *
+ * @param reader the open trace
+ * @param mode the mode to simulate
+ * @param context the state of the mode
+ * @param created whether the state was created; it is released either way
+ * @param args arguments read from command line
+ * @param cache the cache to manipulate
+ * @return true if the state was created, the trace read and the report
+ * and release succeeded
+ */
+static bool simulateMode(traceReader_t *reader, const traceMode_t *mode,
+        void *context, bool created, argument_t *args, Cache *cache) {
+    bool success = created;
+
+    if (success) {
+        success = consumeTrace(reader, mode->consume, context);
+        tracePrintThroughput(reader, stderr);
+    }
+    if (success && mode->report)
+        success = mode->report(context, args, cache);
+    if (mode->release)
+        success = mode->release(context) && success;
+    traceClose(reader);
+    return success;
+}
+
 /**
  * Reads and parses the trace file provided by the argument of the -t command-
  * line option.
+ * <p>
+ * Only plain quiet runs are sharded across -j threads. Every other mode
+ * needs the trace in order (prefetcher training, per-access output, time
+ * samples, the shadow cache of -C, checkpoint positions) and runs on this
+ * thread; getOptions() rejects -j for them.
  * 
  * @return true if the file is read and parsed without issue
  */
-bool readAndParseTraceFile(argument_t *args, Cache *cache) {
-    FILE * traceFile;
-    char buffer[80];
-    
-    trace_t trace;
-    trace.address = 0;
-    trace.operation = 0;
-    trace.size = 0;
+bool readAndParseTraceFile(flag_t *flags, argument_t *args, Cache *cache) {
+    traceReader_t reader;
+    bool success;
 
-    traceFile = fopen (args->traceFile , "r");
-    
-    if (traceFile == NULL) {
-        perror ("Error opening file");
+    if (!traceOpen(&reader, args->traceFile))
         return false;
+
+    if (flags->prefetch) {
+        prefetcher_t prefetcher;
+
+        return simulateMode(&reader, &prefetchMode, &prefetcher,
+                prefetchCreate(&prefetcher, args->prefetch, cache), args,
+                cache);
     }
+    if (flags->sample) {
+        sampler_t sampler;
+        bool created = samplerCreate(&sampler, args->sample, cache);
 
-    printf("File read!\n");
-    while ( fgets (buffer , BUFFER_SIZE , traceFile) != NULL ) {
-        printf("\n%s",buffer);
-        sscanf(buffer,"%*c%c %Lx,%c",
-                &(trace.operation),
-                &(trace.address),
-                &(trace.size)
-        );
-        // Quick char to int subtraction technique.
-        // Equivalent to size = atoi((char *)(&size)) or size = size - 48.
-        trace.size -= '0';
-
-        switch(trace.operation) {
-            case 'L':
-                cacheLoad(&trace,cache);
-                break;
-            case 'S':
-                cacheStore(&trace,cache);
-                break;
-            case 'M':
-                cacheModify(&trace,cache);
-                break;
-            case 'I':
-                break;
-            default:
-                return false;
-        }
+        // The reader drops what -S does not sample.
+        reader.sample = &sampler.config;
+        return simulateMode(&reader, &sampleMode, &sampler, created, args,
+                cache);
     }
-    fclose (traceFile);
-    
-    return true;
+    if (flags->profile) {
+        profile_t profile;
+
+        return simulateMode(&reader, &profileMode, &profile,
+                profileCreate(&profile, cache, args->regions), args, cache);
+    }
+    if (flags->classify) {
+        classifier_t classifier;
+        bool created = classifyCreate(&classifier, cache);
+
+        if (!created)
+            fprintf(stderr, "Out of memory creating the classifier\n");
+        return simulateMode(&reader, &classifyMode, &classifier, created,
+                args, cache);
+    }
+    if (flags->eventLog) {
+        eventLog_t log;
+
+        return simulateMode(&reader, &eventMode, &log,
+                eventLogOpen(&log, args->eventLog, cache), args, cache);
+    }
+
+    if (flags->checkpoint || flags->restore) {
+        success = checkpointTrace(flags, args, cache, &reader);
+        tracePrintThroughput(&reader, stderr);
+        traceClose(&reader);
+        return success;
+    }
+    if (flags->threads && !flags->verbose && atoi(args->threads) > 1) {
+        success = shardSimulate(cache, &reader, atoi(args->threads));
+        tracePrintThroughput(&reader, stderr);
+        traceClose(&reader);
+        return success;
+    }
+
+    return simulateMode(&reader, flags->verbose ? &verboseMode : &quietMode,
+            cache, true, args, cache);
 }
 
 /**
- * Loads data from the cache.
+ * Simulates every combination of the -s/-E/-b lists in a single pass over
+ * the trace file and prints one summary line per configuration.
  * 
- * @param trace valgrind data to be used
- * @param cache the cache to load from
- * @return true on success
+ * @return true if the file is read and parsed without issue
  */
-bool cacheLoad(trace_t *trace, Cache *cache) {
-    if(trace->operation != 'L')
+bool readAndSweepTraceFile(argument_t *args) {
+    uint32_t setBits[STACKDIST_MAX_VALUES];
+    uint32_t associativities[STACKDIST_MAX_VALUES];
+    uint32_t blockBits[STACKDIST_MAX_VALUES];
+    size_t setCount, associativityCount, blockCount;
+    traceReader_t reader;
+    stackSweep_t sweep;
+    bool success;
+
+    setCount = stackParseList(args->setBits, setBits, STACKDIST_MAX_VALUES);
+    associativityCount = stackParseList(args->associativity, associativities,
+            STACKDIST_MAX_VALUES);
+    blockCount = stackParseList(args->blockBits, blockBits,
+            STACKDIST_MAX_VALUES);
+    if (!setCount || !associativityCount || !blockCount) {
+        fprintf(stderr, "Malformed -s/-E/-b list\n");
+        printUsage();
         return false;
-    
-    return true;
+    }
+
+    if (!stackSweepCreate(&sweep, setBits, setCount, associativities,
+            associativityCount, blockBits, blockCount)) {
+        fprintf(stderr, "Unable to create sweep configurations\n");
+        return false;
+    }
+
+    if (!traceOpen(&reader, args->traceFile)) {
+        stackSweepFree(&sweep);
+        return false;
+    }
+    success = consumeTrace(&reader, sweepBatch, &sweep);
+
+    tracePrintThroughput(&reader, stderr);
+    traceClose(&reader);
+    if (success)
+        stackSweepPrint(&sweep, stdout);
+    stackSweepFree(&sweep);
+
+    return success;
+}
+
+/**
+ * Batch consumer for -r runs.
+ */
+static void reuseConsumeBatch(void *reuse, const trace_t *batch,
+        size_t count) {
+    reuseBatch(reuse, batch, count);
 }
 
 /**
- * Stores data into the cache.
+ * Prints the exact reuse distance histogram of the trace file at the block
+ * size of the -b command-line option.
  * 
- * @param trace valgrind  data to be used
- * @param cache the cache to store into
- * @return true on success
+ * @return true if the file is read and parsed without issue
  */
-bool cacheStore(trace_t *trace, Cache *cache) {
-    if(trace->operation != 'S')
+bool readAndProfileReuse(argument_t *args) {
+    traceReader_t reader;
+    reuse_t reuse;
+    long blockBits;
+    bool success;
+
+    if (!parseNumber(args->blockBits, 0, 63, &blockBits)) {
+        fprintf(stderr, "Unsupported block size (b must be 0-63)\n");
         return false;
-    
-    return true;
+    }
+    if (!reuseCreate(&reuse, blockBits)) {
+        reuseFree(&reuse);
+        return false;
+    }
+    if (!traceOpen(&reader, args->traceFile)) {
+        reuseFree(&reuse);
+        return false;
+    }
+
+    success = consumeTrace(&reader, reuseConsumeBatch, &reuse);
+    tracePrintThroughput(&reader, stderr);
+    traceClose(&reader);
+    if (success)
+        reusePrint(&reuse, stdout);
+    reuseFree(&reuse);
+
+    return success;
+}
+
+/**
+ * Batch consumer for the first pass of -p opt runs.
+ */
+static void optimalIndexConsumer(void *optimal, const trace_t *batch,
+        size_t count) {
+    optimalIndexBatch(optimal, batch, count);
 }
 
 /**
- * Modifies data in the cache.
+ * Batch consumer for the second pass of -p opt runs.
+ */
+static void optimalConsumer(void *optimal, const trace_t *batch,
+        size_t count) {
+    optimalSimulateBatch(optimal, batch, count);
+}
+
+/**
+ * Simulates the trace file under Belady's optimal replacement, reading it
+ * twice, and prints the summary.
  * 
- * @param trace valgrind  data to be used
- * @param cache the cache to modify
- * @return true on success
+ * @return true if the file is read twice without issue
  */
-bool cacheModify(trace_t *trace, Cache *cache) {
-    if(trace->operation != 'M')
+bool readAndSimulateOptimal(argument_t *args) {
+    traceReader_t reader;
+    optimal_t optimal;
+    long setBits, associativity, blockBits;
+    bool success;
+
+    if (!optionsToGeometry(args, OPTIMAL_MAX_WAYS, &setBits, &associativity,
+            &blockBits))
         return false;
-    
-    return true;
+    if (!optimalCreate(&optimal, setBits, associativity, blockBits)) {
+        fprintf(stderr, "Unsupported cache geometry\n");
+        optimalFree(&optimal);
+        return false;
+    }
+
+    // The first pass builds the next-use index the second one replays.
+    success = traceOpen(&reader, args->traceFile);
+    if (success) {
+        success = consumeTrace(&reader, optimalIndexConsumer, &optimal);
+        traceClose(&reader);
+    }
+    if (success && !optimalStart(&optimal)) {
+        fprintf(stderr, "Out of memory creating the optimal cache\n");
+        success = false;
+    }
+    if (success)
+        success = traceOpen(&reader, args->traceFile);
+    if (success) {
+        success = consumeTrace(&reader, optimalConsumer, &optimal);
+        tracePrintThroughput(&reader, stderr);
+        traceClose(&reader);
+    }
+    if (success && optimal.now != optimal.accesses) {
+        fprintf(stderr, "%s changed between the passes\n", args->traceFile);
+        success = false;
+    }
+    if (success)
+        printSummary(optimal.hits, optimal.misses, optimal.evictions);
+    optimalFree(&optimal);
+
+    return success;
+}
+
+/**
+ * Batch consumer for -c runs.
+ */
+static void hierarchyBatch(void *hierarchy, const trace_t *batch,
+        size_t count) {
+    hierarchySimulateBatch(hierarchy, batch, count);
+}
+
+/**
+ * Simulates the trace file through the cache hierarchy described by the
+ * config file of the -c command-line option and prints per-level counters.
+ * 
+ * @return true if the config and trace are read without issue
+ */
+bool readAndSimulateHierarchy(argument_t *args) {
+    hierarchy_t hierarchy;
+    traceReader_t reader;
+    bool success;
+
+    if (!hierarchyCreate(&hierarchy, args->config))
+        return false;
+    if (!traceOpen(&reader, args->traceFile)) {
+        hierarchyFree(&hierarchy);
+        return false;
+    }
+
+    success = consumeTrace(&reader, hierarchyBatch, &hierarchy);
+    tracePrintThroughput(&reader, stderr);
+    traceClose(&reader);
+    if (success)
+        hierarchyPrint(&hierarchy, stdout);
+    hierarchyFree(&hierarchy);
+
+    return success;
+}
+
+/**
+ * State of a -m run with a single trace.
+ */
+typedef struct coherenceRun_t {
+    coherence_t *coherence;
+    bool overflow;
+} coherenceRun_t;
+
+/**
+ * Batch consumer for -m runs with a single trace: the thread id column
+ * picks the core. Records are dropped once a thread finds no free core.
+ */
+static void coherenceBatch(void *context, const trace_t *batch,
+        size_t count) {
+    coherenceRun_t *run = context;
+    size_t i;
+    int core;
+
+    for (i = 0; i < count && !run->overflow; i++) {
+        core = coherenceCore(run->coherence, batch[i].thread);
+        if (core < 0) {
+            fprintf(stderr, "Thread %" PRIu32 " is thread %u of the trace, "
+                    "but -m has only %u cores\n", batch[i].thread,
+                    run->coherence->cores + 1, run->coherence->cores);
+            run->overflow = true;
+            break;
+        }
+        coherenceAccess(run->coherence, core, &batch[i]);
+    }
+}
+
+/**
+ * Simulates MESI-coherent private caches for the number of cores given by
+ * the -m command-line option and prints per-core and coherence counters.
+ * <p>
+ * With one trace per core the traces are interleaved round-robin, one
+ * record per core per turn, until every trace is exhausted.
+ * 
+ * @return true if the traces are read without issue
+ */
+bool readAndSimulateCoherence(argument_t *args, Cache *cache) {
+    static traceReader_t readers[COHERENCE_MAX_CORES];
+    static trace_t *batches[COHERENCE_MAX_CORES];
+    size_t positions[COHERENCE_MAX_CORES];
+    size_t counts[COHERENCE_MAX_CORES];
+    char *paths = strdup(args->traceFile);
+    char *path;
+    coherence_t *coherence = malloc(sizeof(coherence_t));
+    unsigned cores = atoi(args->cores);
+    unsigned traces = 0, active, core;
+    bool success = paths && coherence;
+    bool created = false;
+    coherenceRun_t run;
+
+    if (atoi(args->cores) < 1 || atoi(args->cores) > COHERENCE_MAX_CORES) {
+        fprintf(stderr, "-m takes 1-%d cores, not %s\n", COHERENCE_MAX_CORES,
+                args->cores);
+        success = false;
+    }
+    for (path = success ? strtok(paths, ",") : NULL; path && success;
+            path = strtok(NULL, ",")) {
+        if (traces == COHERENCE_MAX_CORES) {
+            fprintf(stderr, "-t lists at most %d traces\n",
+                    COHERENCE_MAX_CORES);
+            success = false;
+            break;
+        }
+        if (!traceOpen(&readers[traces], path)) {
+            success = false;
+            break;
+        }
+        positions[traces] = counts[traces] = 0;
+        batches[traces] = malloc(TRACE_BATCH_SIZE * sizeof(trace_t));
+        success = batches[traces++] != NULL;
+    }
+    if (success && traces > 1 && traces != cores) {
+        fprintf(stderr, "-m %u needs %u traces, got %u\n", cores, cores,
+                traces);
+        success = false;
+    }
+    if (success && !(created = coherenceCreate(coherence, cores,
+            cache->setBits, cache->associativity, cache->blockBits,
+            cache->policy))) {
+        fprintf(stderr, "Unable to create %u coherent caches\n", cores);
+        success = false;
+    }
+
+    if (success && traces == 1) {
+        run.coherence = coherence;
+        run.overflow = false;
+        success = consumeTrace(&readers[0], coherenceBatch, &run)
+                && !run.overflow;
+    } else if (success) {
+        active = traces;
+        while (active) {
+            active = 0;
+            for (core = 0; core < traces; core++) {
+                if (positions[core] == counts[core]) {
+                    positions[core] = 0;
+                    counts[core] = traceNextBatch(&readers[core],
+                            batches[core], TRACE_BATCH_SIZE);
+                    if (counts[core] == 0)
+                        continue;
+                }
+                coherenceAccess(coherence, core,
+                        &batches[core][positions[core]++]);
+                active++;
+            }
+        }
+        for (core = 0; core < traces; core++)
+            success &= !readers[core].error;
+    }
+
+    if (success)
+        coherencePrint(coherence, stdout);
+    if (created)
+        coherenceFree(coherence);
+    for (core = 0; core < traces; core++) {
+        traceClose(&readers[core]);
+        free(batches[core]);
+    }
+    free(coherence);
+    free(paths);
+
+    return success;
 }
 
 /**
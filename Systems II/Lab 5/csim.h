@@ -15,27 +15,8 @@
 
 #include <inttypes.h>
 #include <stdbool.h>
-
-/**
- * Cache definition
- */
-typedef struct Cache{
-    uint8_t associativity; 
-    uint8_t blockBits; 
-    uint32_t blockSize; 
-    uint8_t setBits; 
-    uint32_t setSize; 
-    uint64_t ** tags; 
-} Cache;
-
-/**
- * Trace definition
- */
-typedef struct trace_t {
-    uint64_t address;
-    char operation;
-    uint8_t size;
-} trace_t;
+#include "cache.h"
+#include "trace.h"
 
 /**
  * Flag type definition
@@ -48,6 +29,21 @@ typedef union flag_t{
         bool E : 1;
         bool b : 1;
         bool t : 1;
+        bool j : 1;
+        bool p : 1;
+        bool c : 1;
+        bool m : 1;
+        bool P : 1;
+        bool H : 1;
+        bool R : 1;
+        bool r : 1;
+        bool S : 1;
+        bool k : 1;
+        bool l : 1;
+        bool w : 1;
+        bool C : 1;
+        bool L : 1;
+        bool i : 1;
     };
     struct {
         bool help : 1;
@@ -56,8 +52,23 @@ typedef union flag_t{
         bool associativity : 1;
         bool blockBits : 1;
         bool traceFile : 1;
+        bool threads : 1;
+        bool policy : 1;
+        bool config : 1;
+        bool cores : 1;
+        bool prefetch : 1;
+        bool profile : 1;
+        bool regions : 1;
+        bool reuse : 1;
+        bool sample : 1;
+        bool checkpoint : 1;
+        bool restore : 1;
+        bool write : 1;
+        bool classify : 1;
+        bool eventLog : 1;
+        bool index : 1;
     };
-    uint8_t raw;
+    uint32_t raw;
 }flag_t;
 
 /**
@@ -69,12 +80,38 @@ typedef union argument_t {
         char * E;
         char * b;
         char * t;
+        char * j;
+        char * p;
+        char * c;
+        char * m;
+        char * P;
+        char * H;
+        char * R;
+        char * S;
+        char * k;
+        char * l;
+        char * w;
+        char * L;
+        char * i;
     };
     struct {
         char * setBits;
         char * associativity;
         char * blockBits;
         char * traceFile;
+        char * threads;
+        char * policy;
+        char * config;
+        char * cores;
+        char * prefetch;
+        char * profile;
+        char * regions;
+        char * sample;
+        char * checkpoint;
+        char * restore;
+        char * write;
+        char * eventLog;
+        char * index;
     };
 } argument_t;
 
@@ -96,65 +133,98 @@ void printUsage(void);
 bool getOptions(int argc, char *argv[], flag_t *flags, argument_t *args);
 
 /**
- * Creates a Cache based on options and arguments gathered by getOptions().
+ * Parses the -s, -E and -b command-line options of a single cache as whole
+ * numbers and range-checks them before they can be narrowed, printing an
+ * error if they do not describe a cache.
+ *
+ * @param args arguments read from command line
+ * @param maxWays largest associativity accepted
+ * @param setBits receives s, 0-CACHE_MAX_SET_BITS
+ * @param associativity receives E, 1-maxWays
+ * @param blockBits receives b, with s + b below 64
+ * @return true if all three are valid
+ */
+bool optionsToGeometry(argument_t *args, long maxWays, long *setBits,
+        long *associativity, long *blockBits);
+
+/**
+ * Creates a Cache based on options and arguments gathered by getOptions(),
+ * or restores it from the checkpoint of the -l command-line option.
  * <p>
  * This function dynamically allocates data onto the heap. Be sure to call
  * freeCacheTags() to free memory and avoid memory leaks.
  * 
  * @param args arguments read from command line
  * @param cache the cache to manipulate
+ * @return true if the arguments describe a cache that could be created
  */
-void optionsToCache(argument_t *args, Cache *cache);
+bool optionsToCache(argument_t *args, Cache *cache);
 
 /**
- * Frees the dynamically allocated data from the heap that was created when
- * calling optionsToCache().
+ * Reads and parses the trace file provided by the argument of the -t command-
+ * line option.
  * 
+ * @param flags flags read from command line
+ * @param args arguments read from command line
  * @param cache the cache to manipulate
+ * @return true if the file is read and parsed without issue
  */
-void freeCacheTags(Cache *cache);
+bool readAndParseTraceFile(flag_t *flags, argument_t *args, Cache *cache);
 
 /**
- * Reads and parses the trace file provided by the argument of the -t command-
- * line option.
+ * Simulates every combination of the -s/-E/-b lists in a single pass over
+ * the trace file and prints one summary line per configuration.
  * 
  * @param args arguments read from command line
- * @param cache the cache to manipulate
  * @return true if the file is read and parsed without issue
  */
-bool readAndParseTraceFile(argument_t *args, Cache *cache);
+bool readAndSweepTraceFile(argument_t *args);
 
+/**
+ * Prints the exact reuse distance histogram of the trace file at the block
+ * size of the -b command-line option.
+ * 
+ * @param args arguments read from command line
+ * @return true if the file is read and parsed without issue
+ */
+bool readAndProfileReuse(argument_t *args);
 
 /**
- * Loads data from the cache.
+ * Simulates the trace file under Belady's optimal replacement (-p opt),
+ * reading it twice, and prints the summary.
  * 
- * @param trace valgrind data to be used
- * @param cache the cache to load from
- * @return true on success
+ * @param args arguments read from command line
+ * @return true if the file is read twice without issue
  */
-bool cacheLoad(trace_t *trace, Cache *cache);
+bool readAndSimulateOptimal(argument_t *args);
 
 /**
- * Stores data into the cache.
+ * Simulates the trace file through the cache hierarchy described by the
+ * config file of the -c command-line option and prints per-level counters.
  * 
- * @param trace valgrind  data to be used
- * @param cache the cache to store into
- * @return true on success
+ * @param args arguments read from command line
+ * @return true if the config and trace are read without issue
  */
-bool cacheStore(trace_t *trace, Cache *cache);
+bool readAndSimulateHierarchy(argument_t *args);
 
 /**
- * Modifies data in the cache.
+ * Simulates MESI-coherent private caches for the number of cores given by
+ * the -m command-line option and prints per-core and coherence counters.
  * 
- * @param trace valgrind  data to be used
- * @param cache the cache to modify
- * @return true on success
+ * @param args arguments read from command line
+ * @param cache the geometry and policy of every private cache
+ * @return true if the traces are read without issue
  */
-bool cacheModify(trace_t *trace, Cache *cache);
+bool readAndSimulateCoherence(argument_t *args, Cache *cache);
 
-uint64_t getBits(uint64_t value) {
-    
-    return 0;
-}
+/**
+ * Returns the bits between start and end.
+ * 
+ * @param value the value to pull bits from.
+ * @param start the start bit (0-63)
+ * @param end the end bit (0-63)
+ * @return the bits between start and end of value
+ */
+uint64_t getBits(uint64_t value, uint8_t start, uint8_t end);
 
 #endif  /* CSIM_H */
\ No newline at end of file
@@ -0,0 +1,216 @@
+/*
+ * File:   eventlog.c
+ * Author: Nathan Hernandez,
+ *         Alyssa Tyler
+ *
+ * LoginID: hernandeznp,
+ *          tylerae
+ *
+ * Binary event log. See eventlog.h.
+ */
+
+/**
+ * Includes
+ */
+#include "eventlog.h"
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+_Static_assert(sizeof(event_t) == 24, "event_t must stay 24 bytes");
+
+/**
+ * Writes all of a buffer, retrying short writes.
+ *
+ * @return true on success
+ */
+static bool eventWriteAll(int fd, const void *data, size_t length) {
+    const char *next = data;
+    ssize_t done;
+
+    while (length > 0) {
+        done = write(fd, next, length);
+        if (done <= 0)
+            return false;
+        next += done;
+        length -= done;
+    }
+    return true;
+}
+
+/**
+ * Creates an event log file and writes its header.
+ */
+bool eventLogOpen(eventLog_t *log, const char *path, Cache *cache) {
+    char header[EVENT_HEADER_SIZE];
+    uint32_t value;
+
+    memset(log, 0, sizeof(eventLog_t));
+    log->cache = cache;
+    log->fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (log->fd < 0) {
+        perror("Error creating event log");
+        return false;
+    }
+    log->buffer = malloc(EVENT_BUFFER_SIZE * sizeof(event_t));
+    memcpy(header, EVENT_MAGIC, 8);
+    value = EVENT_VERSION;
+    memcpy(header + 8, &value, sizeof(value));
+    value = sizeof(event_t);
+    memcpy(header + 12, &value, sizeof(value));
+    if (log->buffer == NULL || !eventWriteAll(log->fd, header,
+            sizeof(header))) {
+        perror("Error writing event log");
+        free(log->buffer);
+        close(log->fd);
+        log->buffer = NULL;
+        log->fd = -1;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Writes the buffered events. A failed write is remembered and later events
+ * are dropped.
+ */
+static void eventLogFlush(eventLog_t *log) {
+    if (!log->error && log->used > 0)
+        log->error = !eventWriteAll(log->fd, log->buffer,
+                log->used * sizeof(event_t));
+    log->used = 0;
+}
+
+/**
+ * Simulates one data record and describes its outcome.
+ */
+void eventSimulate(Cache *cache, const trace_t *trace, event_t *event) {
+    cacheResult_t result;
+
+    memset(event, 0, sizeof(event_t));
+    event->address = trace->address;
+    event->operation = trace->operation;
+    event->size = trace->size;
+    if (trace->operation == 'S')
+        result = cacheWrite(cache, trace->address, trace->size, CACHE_WRITE);
+    else
+        result = cacheAccess(cache, trace->address);
+    if (result == CACHE_MISS_EVICTION)
+        event->victim = cache->victim;
+    event->outcomes = result;
+    if (trace->operation == 'M')
+        event->outcomes |= cacheWrite(cache, trace->address, trace->size,
+                CACHE_MODIFY) << 2;
+}
+
+/**
+ * Simulates a batch of trace records and logs every data access.
+ */
+void eventLogBatch(eventLog_t *log, const trace_t *batch, size_t count) {
+    size_t i;
+
+    for (i = 0; i < count; i++) {
+        if (batch[i].operation == 'I')
+            continue;
+        eventSimulate(log->cache, &batch[i], &log->buffer[log->used++]);
+        log->events++;
+        if (log->used == EVENT_BUFFER_SIZE)
+            eventLogFlush(log);
+    }
+}
+
+/**
+ * Flushes and closes a log.
+ */
+bool eventLogClose(eventLog_t *log) {
+    bool success;
+
+    if (log->fd < 0)
+        return false;
+    eventLogFlush(log);
+    success = close(log->fd) == 0 && !log->error;
+    if (!success)
+        perror("Error writing event log");
+    free(log->buffer);
+    log->buffer = NULL;
+    log->fd = -1;
+    return success;
+}
+
+/**
+ * Renders an event as a "L 10,1 miss eviction" line.
+ */
+size_t eventFormat(const event_t *event, bool victims, char *line) {
+    static const char *outcomes[] = {
+        [CACHE_HIT] = " hit",
+        [CACHE_MISS] = " miss",
+        [2] = " ?",
+        [CACHE_MISS_EVICTION] = " miss eviction"
+    };
+    int length;
+
+    length = snprintf(line, EVENT_LINE_SIZE, "%c %" PRIx64 ",%u%s%s",
+            event->operation, event->address, event->size,
+            outcomes[event->outcomes & 3],
+            event->operation == 'M'
+                    ? outcomes[event->outcomes >> 2 & 3] : "");
+    if (victims && ((event->outcomes & 3) == CACHE_MISS_EVICTION
+            || (event->outcomes >> 2 & 3) == CACHE_MISS_EVICTION))
+        length += snprintf(line + length, EVENT_LINE_SIZE - length,
+                " victim %" PRIx64, event->victim);
+    line[length++] = '\n';
+    line[length] = '\0';
+    return length;
+}
+
+/**
+ * Renders every event of a log file.
+ */
+bool eventLogPrint(const char *path, bool victims, FILE *stream) {
+    char header[EVENT_HEADER_SIZE];
+    char line[EVENT_LINE_SIZE];
+    uint32_t version, size;
+    event_t *events;
+    size_t count, i;
+    bool success;
+    FILE *file;
+
+    file = fopen(path, "rb");
+    if (file == NULL) {
+        perror("Error opening event log");
+        return false;
+    }
+    if (fread(header, sizeof(header), 1, file) != 1
+            || memcmp(header, EVENT_MAGIC, 8) != 0) {
+        fprintf(stderr, "%s: not an event log\n", path);
+        fclose(file);
+        return false;
+    }
+    memcpy(&version, header + 8, sizeof(version));
+    memcpy(&size, header + 12, sizeof(size));
+    if (version != EVENT_VERSION || size != sizeof(event_t)) {
+        fprintf(stderr, "%s: not an event log of this version\n", path);
+        fclose(file);
+        return false;
+    }
+
+    events = malloc(EVENT_BUFFER_SIZE * sizeof(event_t));
+    if (events == NULL) {
+        fclose(file);
+        return false;
+    }
+    while ((count = fread(events, sizeof(event_t), EVENT_BUFFER_SIZE,
+            file)) > 0)
+        for (i = 0; i < count; i++)
+            fwrite(line, eventFormat(&events[i], victims, line), 1, stream);
+
+    success = !ferror(file);
+    if (success && (ftell(file) - EVENT_HEADER_SIZE) % sizeof(event_t)) {
+        fprintf(stderr, "%s: truncated event log\n", path);
+        success = false;
+    }
+    free(events);
+    fclose(file);
+    return success;
+}
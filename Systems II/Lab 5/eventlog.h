@@ -0,0 +1,136 @@
+/*
+ * File:   eventlog.h
+ * Author: Nathan Hernandez,
+ *         Alyssa Tyler
+ *
+ * LoginID: hernandeznp,
+ *          tylerae
+ *
+ * Binary log of the outcome of every data access, for debugging runs too
+ * long for -v.
+ * <p>
+ * A log starts with a 16 byte header: the magic "CSIMEVNT", a uint32
+ * version and the uint32 size of an event_t. One event_t per data record
+ * follows, in trace order and host byte order. Events are gathered in a
+ * buffer of EVENT_BUFFER_SIZE events and written with one write() each
+ * time it fills, so logging costs a store per access rather than a
+ * printf().
+ * <p>
+ * An eventLog_t is owned by one thread and takes no locks; concurrent
+ * writers each need their own log. csim-events renders a log in the
+ * "L 10,1 miss eviction" format of csim -v.
+ */
+
+#ifndef EVENTLOG_H
+#define EVENTLOG_H
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include "cache.h"
+#include "trace.h"
+
+#define EVENT_MAGIC "CSIMEVNT"
+#define EVENT_VERSION 1
+#define EVENT_HEADER_SIZE 16
+
+/**
+ * Number of events buffered between writes.
+ */
+#define EVENT_BUFFER_SIZE 65536
+
+/**
+ * Longest line eventFormat() writes, with its terminating null.
+ */
+#define EVENT_LINE_SIZE 96
+
+/**
+ * Outcome of a data record.
+ * <p>
+ * outcomes holds the cacheResult_t of the first access in bits 0-1 and, for
+ * a modify, that of its store in bits 2-3. victim is the block evicted by
+ * the record; the store of a modify always hits the line its load brought
+ * in, so a record evicts at most once.
+ */
+typedef struct event_t {
+    uint64_t address;
+    uint64_t victim;
+    char operation;
+    uint8_t size;
+    uint8_t outcomes;
+    uint8_t reserved[5];
+} event_t;
+
+/**
+ * Event log writer definition
+ */
+typedef struct eventLog_t {
+    Cache * cache;
+    int fd;
+    event_t * buffer;
+    size_t used;
+    uint64_t events;
+    bool error;
+} eventLog_t;
+
+/**
+ * Creates an event log file and writes its header.
+ * <p>
+ * Be sure to call eventLogClose() to flush the log and free memory.
+ *
+ * @param log the log to initialize
+ * @param path path of the file to create
+ * @param cache the cache whose accesses are logged
+ * @return true on success
+ */
+bool eventLogOpen(eventLog_t *log, const char *path, Cache *cache);
+
+/**
+ * Simulates one data record and describes its outcome.
+ *
+ * @param cache the cache to access
+ * @param trace the record to simulate; not an instruction fetch
+ * @param event receives the outcome
+ */
+void eventSimulate(Cache *cache, const trace_t *trace, event_t *event);
+
+/**
+ * Simulates a batch of trace records in the cache of a log and logs every
+ * data access.
+ *
+ * @param log the log to append to
+ * @param batch the records to simulate
+ * @param count number of records in batch
+ */
+void eventLogBatch(eventLog_t *log, const trace_t *batch, size_t count);
+
+/**
+ * Flushes and closes a log.
+ *
+ * @param log the log to close
+ * @return true if every event was written
+ */
+bool eventLogClose(eventLog_t *log);
+
+/**
+ * Renders an event as a "L 10,1 miss eviction" line, with a newline.
+ *
+ * @param event the event to render
+ * @param victims whether to append the address of an evicted block
+ * @param line receives the line; EVENT_LINE_SIZE bytes
+ * @return the length of the line
+ */
+size_t eventFormat(const event_t *event, bool victims, char *line);
+
+/**
+ * Renders every event of a log file.
+ *
+ * @param path path of the log
+ * @param victims whether to append the addresses of evicted blocks
+ * @param stream the stream to print to
+ * @return true if the whole log was read
+ */
+bool eventLogPrint(const char *path, bool victims, FILE *stream);
+
+#endif  /* EVENTLOG_H */
@@ -0,0 +1,238 @@
+/*
+ * File:   gen.c
+ * Author: Nathan Hernandez,
+ *         Alyssa Tyler
+ *
+ * LoginID: hernandeznp,
+ *          tylerae
+ *
+ * Synthetic trace generator. See gen.h.
+ */
+
+/**
+ * Includes
+ */
+#include "gen.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * Pattern names indexed by genPattern_t.
+ */
+static const char *patternNames[GEN_PATTERNS] = {
+    [GEN_SEQUENTIAL] = "sequential",
+    [GEN_STRIDED] = "strided",
+    [GEN_RANDOM] = "random",
+    [GEN_CHASE] = "chase",
+    [GEN_ZIPF] = "zipf",
+    [GEN_TRANSPOSE] = "transpose"
+};
+
+/**
+ * Looks up a pattern by name.
+ */
+genPattern_t genPatternByName(const char *name) {
+    genPattern_t pattern;
+
+    for (pattern = 0; pattern < GEN_PATTERNS; pattern++)
+        if (strcmp(name, patternNames[pattern]) == 0)
+            break;
+    return pattern;
+}
+
+/**
+ * Fills a configuration with defaults.
+ */
+void genDefaults(genConfig_t *config, genPattern_t pattern) {
+    config->pattern = pattern;
+    config->footprint = 1 << 20;
+    config->stride = 64;
+    config->alpha = 0.99;
+    config->rows = 32;
+    config->columns = 32;
+    config->seed = 1;
+}
+
+/**
+ * Returns the next pseudo-random number (splitmix64).
+ */
+static uint64_t genRandom(generator_t *generator) {
+    uint64_t z = (generator->state += 0x9e3779b97f4a7c15ull);
+
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return z ^ (z >> 31);
+}
+
+/**
+ * Returns a pseudo-random number in [0, bound).
+ */
+static uint64_t genBelow(generator_t *generator, uint64_t bound) {
+    return (uint64_t) (((unsigned __int128) genRandom(generator) * bound)
+            >> 64);
+}
+
+/**
+ * Links the chase nodes into a single random cycle (Sattolo's algorithm).
+ *
+ * @return true on success
+ */
+static bool genCreateChain(generator_t *generator) {
+    uint32_t *order = malloc(generator->items * sizeof(uint32_t));
+    uint32_t swap;
+    uint64_t i, j;
+
+    generator->chain = malloc(generator->items * sizeof(uint32_t));
+    if (order == NULL || generator->chain == NULL) {
+        free(order);
+        return false;
+    }
+    for (i = 0; i < generator->items; i++)
+        order[i] = i;
+    for (i = generator->items - 1; i > 0; i--) {
+        j = genBelow(generator, i);
+        swap = order[i];
+        order[i] = order[j];
+        order[j] = swap;
+    }
+    for (i = 0; i < generator->items; i++)
+        generator->chain[order[i]] = order[(i + 1) % generator->items];
+    free(order);
+    return true;
+}
+
+/**
+ * Builds the cumulative Zipf distribution of the blocks.
+ *
+ * @return true on success
+ */
+static bool genCreateCdf(generator_t *generator) {
+    double sum = 0;
+    uint64_t i;
+
+    generator->cdf = malloc(generator->items * sizeof(double));
+    if (generator->cdf == NULL)
+        return false;
+    for (i = 0; i < generator->items; i++) {
+        sum += 1 / pow(i + 1, generator->config.alpha);
+        generator->cdf[i] = sum;
+    }
+    for (i = 0; i < generator->items; i++)
+        generator->cdf[i] /= sum;
+    return true;
+}
+
+/**
+ * Creates a generator.
+ */
+bool genCreate(generator_t *generator, const genConfig_t *config) {
+    memset(generator, 0, sizeof(generator_t));
+    generator->config = *config;
+    generator->state = config->seed;
+    generator->items = config->footprint / GEN_NODE_SIZE;
+
+    switch (config->pattern) {
+        case GEN_SEQUENTIAL:
+        case GEN_RANDOM:
+            return config->footprint >= 8;
+        case GEN_STRIDED:
+            return config->stride > 0 && config->footprint >= config->stride;
+        case GEN_CHASE:
+            return generator->items > 1 && generator->items <= UINT32_MAX
+                    && genCreateChain(generator);
+        case GEN_ZIPF:
+            return generator->items > 0 && config->alpha > 0
+                    && genCreateCdf(generator);
+        case GEN_TRANSPOSE:
+            return config->rows > 0 && config->columns > 0;
+        default:
+            return false;
+    }
+}
+
+/**
+ * Draws a Zipf-distributed block rank by binary search of the CDF.
+ */
+static uint64_t genZipf(generator_t *generator) {
+    double u = (genRandom(generator) >> 11) * 0x1.0p-53;
+    uint64_t low = 0, high = generator->items - 1, middle;
+
+    while (low < high) {
+        middle = (low + high) / 2;
+        if (generator->cdf[middle] < u)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+    return low;
+}
+
+/**
+ * Generates the next records.
+ */
+void genNextBatch(generator_t *generator, trace_t *batch, size_t count) {
+    genConfig_t *config = &generator->config;
+    uint64_t matrix = (uint64_t) config->rows * config->columns;
+    uint64_t target = GEN_BASE + ((matrix * 4 + 4095) & ~4095ull);
+    uint64_t element, row, column;
+    size_t i;
+
+    for (i = 0; i < count; i++, generator->position++) {
+        batch[i].operation = 'L';
+        batch[i].size = 8;
+        batch[i].thread = 0;
+        batch[i].sample = TRACE_MEASURE;
+
+        switch (config->pattern) {
+            case GEN_SEQUENTIAL:
+                batch[i].address = GEN_BASE
+                        + generator->position * 8 % (config->footprint & ~7ull);
+                break;
+            case GEN_STRIDED:
+                batch[i].address = GEN_BASE + generator->position
+                        * config->stride % config->footprint;
+                break;
+            case GEN_RANDOM:
+                batch[i].address = GEN_BASE
+                        + genBelow(generator, config->footprint / 8) * 8;
+                break;
+            case GEN_CHASE:
+                batch[i].address = GEN_BASE
+                        + (uint64_t) generator->current * GEN_NODE_SIZE;
+                generator->current = generator->chain[generator->current];
+                break;
+            case GEN_ZIPF:
+                batch[i].address = GEN_BASE
+                        + genZipf(generator) * GEN_NODE_SIZE;
+                break;
+            case GEN_TRANSPOSE:
+                element = generator->position / 2 % matrix;
+                row = element / config->columns;
+                column = element % config->columns;
+                batch[i].size = 4;
+                if (generator->position % 2 == 0) {
+                    batch[i].address = GEN_BASE
+                            + (row * config->columns + column) * 4;
+                } else {
+                    batch[i].operation = 'S';
+                    batch[i].address = target
+                            + (column * config->rows + row) * 4;
+                }
+                break;
+            default:
+                batch[i].address = GEN_BASE;
+                break;
+        }
+    }
+}
+
+/**
+ * Frees memory allocated by genCreate().
+ */
+void genFree(generator_t *generator) {
+    free(generator->chain);
+    free(generator->cdf);
+    generator->chain = NULL;
+    generator->cdf = NULL;
+}
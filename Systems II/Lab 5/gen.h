@@ -0,0 +1,129 @@
+/*
+ * File:   gen.h
+ * Author: Nathan Hernandez,
+ *         Alyssa Tyler
+ *
+ * LoginID: hernandeznp,
+ *          tylerae
+ *
+ * Reproducible synthetic trace generator. The same configuration and seed
+ * always give the same records.
+ * <p>
+ * Patterns:
+ * <pre>
+ *   sequential  8-byte loads walking through the footprint, wrapping around
+ *   strided     loads stride bytes apart, wrapping around the footprint
+ *   random      uniformly random 8-byte loads within the footprint
+ *   chase       pointer chase through one random cycle of 64-byte nodes
+ *   zipf        loads of 64-byte blocks whose popularity follows Zipf(alpha)
+ *   transpose   the naive cachelab transpose of an N x M int matrix:
+ *               load A[i][j], store B[j][i], repeated
+ * </pre>
+ */
+
+#ifndef GEN_H
+#define GEN_H
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "trace.h"
+
+/**
+ * Address of the first byte of generated data.
+ */
+#define GEN_BASE 0x10000000
+
+/**
+ * Node and block size of the chase and zipf patterns.
+ */
+#define GEN_NODE_SIZE 64
+
+/**
+ * Synthetic access patterns.
+ */
+typedef enum genPattern_t {
+    GEN_SEQUENTIAL,
+    GEN_STRIDED,
+    GEN_RANDOM,
+    GEN_CHASE,
+    GEN_ZIPF,
+    GEN_TRANSPOSE,
+    GEN_PATTERNS
+} genPattern_t;
+
+/**
+ * Generator configuration
+ * <p>
+ * rows and columns are N and M of the transpose (A is N x M); the other
+ * patterns use footprint.
+ */
+typedef struct genConfig_t {
+    genPattern_t pattern;
+    uint64_t footprint;
+    uint64_t stride;
+    double alpha;
+    uint32_t rows;
+    uint32_t columns;
+    uint64_t seed;
+} genConfig_t;
+
+/**
+ * Generator definition
+ */
+typedef struct generator_t {
+    genConfig_t config;
+    uint64_t state;
+    uint64_t position;
+    uint64_t items;
+    uint32_t *chain;
+    uint32_t current;
+    double *cdf;
+} generator_t;
+
+/**
+ * Looks up a pattern by name ("sequential", "strided", "random", "chase",
+ * "zipf" or "transpose").
+ *
+ * @param name the name of the pattern
+ * @return the pattern, or GEN_PATTERNS if the name is unknown
+ */
+genPattern_t genPatternByName(const char *name);
+
+/**
+ * Fills a configuration with defaults: 1 MiB footprint, 64-byte stride,
+ * alpha 0.99, a 32 x 32 transpose and seed 1.
+ *
+ * @param config the configuration to initialize
+ * @param pattern the pattern to generate
+ */
+void genDefaults(genConfig_t *config, genPattern_t pattern);
+
+/**
+ * Creates a generator.
+ * <p>
+ * Be sure to call genFree() to free memory and avoid memory leaks.
+ *
+ * @param generator the generator to initialize
+ * @param config the configuration to generate
+ * @return true on success
+ */
+bool genCreate(generator_t *generator, const genConfig_t *config);
+
+/**
+ * Generates the next records.
+ *
+ * @param generator the generator to advance
+ * @param batch array receiving the records
+ * @param count number of records to generate
+ */
+void genNextBatch(generator_t *generator, trace_t *batch, size_t count);
+
+/**
+ * Frees memory allocated by genCreate().
+ *
+ * @param generator the generator to free
+ */
+void genFree(generator_t *generator);
+
+#endif  /* GEN_H */
@@ -0,0 +1,500 @@
+/*
+ * File:   hierarchy.c
+ * Author: Nathan Hernandez,
+ *         Alyssa Tyler
+ *
+ * LoginID: hernandeznp,
+ *          tylerae
+ *
+ * Multi-level cache hierarchy. See hierarchy.h.
+ */
+
+/**
+ * Includes
+ */
+#include "hierarchy.h"
+#include <errno.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * Defines
+ */
+#define LINE_SIZE 256
+
+/**
+ * Level names indexed by levelId_t.
+ */
+static const char *levelNames[LEVELS] = {
+    [LEVEL_L1I] = "L1I",
+    [LEVEL_L1D] = "L1D",
+    [LEVEL_L2] = "L2",
+    [LEVEL_LLC] = "LLC"
+};
+
+/**
+ * Inclusion policy names indexed by inclusion_t.
+ */
+static const char *inclusionNames[] = {
+    [INCLUSION_NINE] = "nine",
+    [INCLUSION_INCLUSIVE] = "inclusive",
+    [INCLUSION_EXCLUSIVE] = "exclusive"
+};
+
+/**
+ * Parses the decimal value of a numeric option of a level line.
+ *
+ * @return true if value is a whole non-negative number
+ */
+static bool hierarchyParseNumber(const char *option, const char *value,
+        unsigned number, int *result) {
+    char *end;
+    long parsed;
+
+    errno = 0;
+    parsed = strtol(value, &end, 10);
+    if (end == value || *end != '\0' || errno != 0 || parsed < 0
+            || parsed > INT_MAX) {
+        fprintf(stderr, "line %u: %s takes a number, not %s\n", number,
+                option, value);
+        return false;
+    }
+    *result = (int) parsed;
+    return true;
+}
+
+/**
+ * Parses one level line of the config file.
+ *
+ * @return true if the line is valid
+ */
+static bool hierarchyParseLevel(hierarchy_t *hierarchy, char *line,
+        unsigned number) {
+    char *name = strtok(line, " \t\r\n");
+    char *option, *value, *index = NULL;
+    int setBits = -1, associativity = -1, blockBits = -1, latency = -1;
+    cachePolicy_t policy = CACHE_LRU;
+    inclusion_t inclusion = INCLUSION_NINE;
+    tlbLevelId_t tlbId = TLB_LEVELS;
+    levelId_t id = LEVELS;
+    uint8_t pageBits = 0;
+    level_t *level;
+    unsigned i;
+
+    if (name == NULL)
+        return true;
+
+    if (strcmp(name, "L1") == 0 || strcmp(name, "L1D") == 0)
+        id = LEVEL_L1D;
+    else if (strcmp(name, "L1I") == 0)
+        id = LEVEL_L1I;
+    else if (strcmp(name, "L2") == 0)
+        id = LEVEL_L2;
+    else if (strcmp(name, "LLC") == 0 || strcmp(name, "L3") == 0)
+        id = LEVEL_LLC;
+    else if (strcmp(name, "DTLB") == 0)
+        tlbId = TLB_L1;
+    else if (strcmp(name, "STLB") == 0)
+        tlbId = TLB_L2;
+    else if (strcmp(name, "MEM") != 0) {
+        fprintf(stderr, "line %u: unknown level %s\n", number, name);
+        return false;
+    }
+
+    while ((option = strtok(NULL, " \t\r\n")) != NULL) {
+        value = strchr(option, '=');
+        if (value == NULL) {
+            fprintf(stderr, "line %u: expected key=value, got %s\n", number,
+                    option);
+            return false;
+        }
+        *value++ = '\0';
+        if (strcmp(option, "s") == 0) {
+            if (!hierarchyParseNumber(option, value, number, &setBits))
+                return false;
+        } else if (strcmp(option, "E") == 0) {
+            if (!hierarchyParseNumber(option, value, number, &associativity))
+                return false;
+        } else if (strcmp(option, "b") == 0) {
+            if (!hierarchyParseNumber(option, value, number, &blockBits))
+                return false;
+        } else if (strcmp(option, "p") == 0) {
+            policy = cachePolicyByName(value);
+            if (policy == CACHE_POLICIES) {
+                fprintf(stderr, "line %u: unknown policy %s\n", number,
+                        value);
+                return false;
+            }
+        } else if (strcmp(option, "inclusion") == 0) {
+            for (i = 0; i < 3; i++)
+                if (strcmp(value, inclusionNames[i]) == 0)
+                    break;
+            if (i == 3) {
+                fprintf(stderr, "line %u: unknown inclusion %s\n", number,
+                        value);
+                return false;
+            }
+            inclusion = i;
+        } else if (strcmp(option, "latency") == 0) {
+            if (!hierarchyParseNumber(option, value, number, &latency))
+                return false;
+        } else if (strcmp(option, "index") == 0) {
+            index = value;
+        } else if (strcmp(option, "page") == 0) {
+            if (!tlbPageBits(value, &pageBits)) {
+                fprintf(stderr, "line %u: unknown page size %s\n", number,
+                        value);
+                return false;
+            }
+        } else {
+            fprintf(stderr, "line %u: bad option %s=%s\n", number, option,
+                    value);
+            return false;
+        }
+    }
+
+    if (setBits > CACHE_MAX_SET_BITS || associativity == 0
+            || associativity > CACHE_MAX_WAYS || blockBits > 63
+            || (setBits >= 0 && setBits + blockBits > 63)) {
+        fprintf(stderr, "line %u: s must be 0-%d, E 1-%d and s + b below "
+                "64\n", number, CACHE_MAX_SET_BITS, CACHE_MAX_WAYS);
+        return false;
+    }
+
+    if (tlbId != TLB_LEVELS) {
+        if (setBits < 0 || associativity < 0 || blockBits >= 0
+                || latency >= 0 || index != NULL
+                || (pageBits && hierarchy->tlb.pageBits
+                        && pageBits != hierarchy->tlb.pageBits)) {
+            fprintf(stderr, "line %u: bad TLB %s\n", number, name);
+            return false;
+        }
+        if (pageBits)
+            hierarchy->tlb.pageBits = pageBits;
+        if (!tlbCreateLevel(&hierarchy->tlb, tlbId, setBits, associativity,
+                policy)) {
+            fprintf(stderr, "line %u: bad or repeated TLB %s\n", number,
+                    name);
+            return false;
+        }
+        return true;
+    }
+    if (pageBits) {
+        fprintf(stderr, "line %u: page only applies to DTLB and STLB\n",
+                number);
+        return false;
+    }
+    if (id == LEVELS) {
+        if (latency < 0 || index != NULL) {
+            fprintf(stderr, "line %u: MEM takes latency=N\n", number);
+            return false;
+        }
+        hierarchy->memoryLatency = latency;
+        return true;
+    }
+
+    level = &hierarchy->levels[id];
+    if (level->present || setBits < 0 || associativity < 0 || blockBits < 0
+            || !cacheCreate(&level->cache, setBits, associativity, blockBits,
+                    policy)) {
+        fprintf(stderr, "line %u: bad or repeated level %s\n", number, name);
+        return false;
+    }
+    if (index != NULL && !cacheSetIndex(&level->cache, index)) {
+        fprintf(stderr, "line %u: bad index %s\n", number, index);
+        freeCacheTags(&level->cache);
+        return false;
+    }
+    level->present = true;
+    level->inclusion = id <= LEVEL_L1D ? INCLUSION_NINE : inclusion;
+    if (latency >= 0)
+        level->latency = latency;
+    return true;
+}
+
+/**
+ * Default latencies in cycles, indexed by levelId_t.
+ */
+static const uint32_t defaultLatencies[LEVELS] = {
+    [LEVEL_L1I] = 4,
+    [LEVEL_L1D] = 4,
+    [LEVEL_L2] = 14,
+    [LEVEL_LLC] = 40
+};
+
+/**
+ * Reads a hierarchy config file and creates its caches.
+ */
+bool hierarchyCreate(hierarchy_t *hierarchy, const char *path) {
+    char line[LINE_SIZE];
+    char *comment;
+    unsigned number = 0;
+    uint8_t blockBits = 0;
+    bool success = true;
+    FILE *config;
+    levelId_t id;
+
+    memset(hierarchy, 0, sizeof(hierarchy_t));
+    for (id = 0; id < LEVELS; id++) {
+        hierarchy->levels[id].depth = id <= LEVEL_L1D ? 0 : id - LEVEL_L1D;
+        hierarchy->levels[id].latency = defaultLatencies[id];
+    }
+    hierarchy->memoryLatency = 200;
+
+    config = fopen(path, "r");
+    if (config == NULL) {
+        perror("Error opening config");
+        return false;
+    }
+    while (success && fgets(line, LINE_SIZE, config) != NULL) {
+        number++;
+        if ((comment = strchr(line, '#')) != NULL)
+            *comment = '\0';
+        success = hierarchyParseLevel(hierarchy, line, number);
+    }
+    fclose(config);
+
+    if (success && !hierarchy->levels[LEVEL_L1D].present) {
+        fprintf(stderr, "%s: an L1D (or L1) level is required\n", path);
+        success = false;
+    }
+    if (success && hierarchy->tlb.levels[TLB_L2].present
+            && !hierarchy->tlb.levels[TLB_L1].present) {
+        fprintf(stderr, "%s: an STLB requires a DTLB\n", path);
+        success = false;
+    }
+    if (hierarchy->tlb.pageBits == 0)
+        hierarchy->tlb.pageBits = 12;
+    for (id = 0; success && id < LEVELS; id++) {
+        if (!hierarchy->levels[id].present)
+            continue;
+        if (blockBits == 0)
+            blockBits = hierarchy->levels[id].cache.blockBits;
+        if (hierarchy->levels[id].cache.blockBits != blockBits) {
+            fprintf(stderr, "%s: all levels must use the same b\n", path);
+            success = false;
+        }
+    }
+
+    if (!success)
+        hierarchyFree(hierarchy);
+    return success;
+}
+
+/**
+ * Returns the next level below id, or LEVELS if id is the last level.
+ */
+static levelId_t hierarchyBelow(hierarchy_t *hierarchy, levelId_t id) {
+    levelId_t below;
+
+    for (below = id <= LEVEL_L1D ? LEVEL_L2 : id + 1; below < LEVELS; below++)
+        if (hierarchy->levels[below].present)
+            return below;
+    return LEVELS;
+}
+
+static void hierarchyInsert(hierarchy_t *hierarchy, levelId_t id,
+        uint64_t address, bool dirty);
+
+/**
+ * Writes a dirty block evicted from level id back to the level below it,
+ * or to memory.
+ */
+static void hierarchyWriteBack(hierarchy_t *hierarchy, levelId_t id,
+        uint64_t address) {
+    levelId_t below = hierarchyBelow(hierarchy, id);
+
+    hierarchy->levels[id].writebacks++;
+    if (below == LEVELS)
+        hierarchy->memoryWrites++;
+    else if (!cacheMarkDirty(&hierarchy->levels[below].cache, address))
+        hierarchyInsert(hierarchy, below, address, true);
+}
+
+/**
+ * Fills a block into level id and disposes of the line it evicts.
+ * <p>
+ * An inclusive level first invalidates the victim in every level above it,
+ * picking up any dirty copy. A dirty victim is written back; a clean one is
+ * handed to the level below only if that level is exclusive.
+ */
+static void hierarchyInsert(hierarchy_t *hierarchy, levelId_t id,
+        uint64_t address, bool dirty) {
+    level_t *level = &hierarchy->levels[id];
+    level_t *upper;
+    uint64_t victim;
+    bool victimDirty, upperDirty;
+    levelId_t above, below;
+
+    if (!cacheInsert(&level->cache, address, dirty, &victim, &victimDirty))
+        return;
+    level->evictions++;
+
+    if (level->inclusion == INCLUSION_INCLUSIVE) {
+        for (above = 0; above < LEVELS; above++) {
+            upper = &hierarchy->levels[above];
+            if (upper->present && upper->depth < level->depth
+                    && cacheInvalidate(&upper->cache, victim, &upperDirty)) {
+                level->backInvalidations++;
+                victimDirty |= upperDirty;
+            }
+        }
+    }
+
+    below = hierarchyBelow(hierarchy, id);
+    if (victimDirty)
+        hierarchyWriteBack(hierarchy, id, victim);
+    else if (below != LEVELS
+            && hierarchy->levels[below].inclusion == INCLUSION_EXCLUSIVE
+            && !cacheContains(&hierarchy->levels[below].cache, victim))
+        hierarchyInsert(hierarchy, below, victim, false);
+}
+
+/**
+ * Performs one access, from the L1 down until a level hits.
+ * <p>
+ * A hit in an exclusive level moves the block up. Levels that missed are
+ * then filled bottom-up, except exclusive ones, which only receive victims.
+ *
+ * @return the level that served the access, or LEVELS for memory
+ */
+static levelId_t hierarchyAccess(hierarchy_t *hierarchy, uint64_t address,
+        bool instruction, bool write) {
+    levelId_t path[3];
+    size_t depth = 0, hit, owner, i;
+    bool carried = false;
+
+    path[depth++] = instruction && hierarchy->levels[LEVEL_L1I].present
+            ? LEVEL_L1I : LEVEL_L1D;
+    if (hierarchy->levels[LEVEL_L2].present)
+        path[depth++] = LEVEL_L2;
+    if (hierarchy->levels[LEVEL_LLC].present)
+        path[depth++] = LEVEL_LLC;
+
+    for (hit = 0; hit < depth; hit++) {
+        if (cacheTouch(&hierarchy->levels[path[hit]].cache, address)) {
+            hierarchy->levels[path[hit]].hits++;
+            break;
+        }
+        hierarchy->levels[path[hit]].misses++;
+    }
+
+    if (hit == depth)
+        hierarchy->memoryReads++;
+    else if (hit > 0
+            && hierarchy->levels[path[hit]].inclusion == INCLUSION_EXCLUSIVE)
+        cacheInvalidate(&hierarchy->levels[path[hit]].cache, address, &carried);
+
+    // L1I never holds dirty lines. A dirty block an instruction fetch
+    // carries up stays dirty in the nearest level filled below L1I, or is
+    // written back from the exclusive level it left.
+    owner = 0;
+    if (carried && path[0] == LEVEL_L1I) {
+        for (owner = 1; owner < hit; owner++)
+            if (hierarchy->levels[path[owner]].inclusion
+                    != INCLUSION_EXCLUSIVE)
+                break;
+        if (owner == hit)
+            hierarchyWriteBack(hierarchy, path[hit], address);
+    }
+
+    for (i = hit; i-- > 0;)
+        if (i == 0 || hierarchy->levels[path[i]].inclusion
+                != INCLUSION_EXCLUSIVE)
+            hierarchyInsert(hierarchy, path[i], address,
+                    (i == 0 && write) || (carried && i == owner));
+
+    if (write && hit == 0)
+        cacheMarkDirty(&hierarchy->levels[path[0]].cache, address);
+    return hit == depth ? LEVELS : path[hit];
+}
+
+/**
+ * Translates a data address, walking the page table through the data
+ * caches on a TLB miss.
+ */
+static void hierarchyTranslate(hierarchy_t *hierarchy, uint64_t address) {
+    tlb_t *tlb = &hierarchy->tlb;
+    uint8_t step, steps;
+    levelId_t served;
+
+    if (tlbTranslate(tlb, address))
+        return;
+    steps = tlbWalkSteps(tlb);
+    for (step = 0; step < steps; step++) {
+        served = hierarchyAccess(hierarchy, tlbWalkAddress(address, step),
+                false, false);
+        tlb->walkCycles += served == LEVELS ? hierarchy->memoryLatency
+                : hierarchy->levels[served].latency;
+    }
+    tlb->walkAccesses += steps;
+}
+
+/**
+ * Simulates a batch of trace records.
+ */
+void hierarchySimulateBatch(hierarchy_t *hierarchy, const trace_t *batch,
+        size_t count) {
+    bool translate = hierarchy->tlb.levels[TLB_L1].present;
+    size_t i;
+
+    for (i = 0; i < count; i++) {
+        if (translate && batch[i].operation != 'I')
+            hierarchyTranslate(hierarchy, batch[i].address);
+        switch (batch[i].operation) {
+            case 'I':
+                hierarchyAccess(hierarchy, batch[i].address, true, false);
+                break;
+            case 'L':
+                hierarchyAccess(hierarchy, batch[i].address, false, false);
+                break;
+            case 'M':
+                hierarchyAccess(hierarchy, batch[i].address, false, false);
+                /* fall through */
+            case 'S':
+                hierarchyAccess(hierarchy, batch[i].address, false, true);
+                break;
+        }
+    }
+}
+
+/**
+ * Prints the counters of every level, of memory and of the TLB.
+ */
+void hierarchyPrint(hierarchy_t *hierarchy, FILE *stream) {
+    level_t *level;
+    levelId_t id;
+
+    for (id = 0; id < LEVELS; id++) {
+        level = &hierarchy->levels[id];
+        if (!level->present)
+            continue;
+        fprintf(stream, "%-3s hits:%" PRIu64 " misses:%" PRIu64
+                " evictions:%" PRIu64 " writebacks:%" PRIu64,
+                levelNames[id], level->hits, level->misses, level->evictions,
+                level->writebacks);
+        if (level->inclusion == INCLUSION_INCLUSIVE)
+            fprintf(stream, " back-invalidations:%" PRIu64,
+                    level->backInvalidations);
+        fprintf(stream, "\n");
+    }
+    fprintf(stream, "MEM reads:%" PRIu64 " writes:%" PRIu64 "\n",
+            hierarchy->memoryReads, hierarchy->memoryWrites);
+    if (hierarchy->tlb.levels[TLB_L1].present)
+        tlbPrint(&hierarchy->tlb, stream);
+}
+
+/**
+ * Frees the caches and TLB of a hierarchy.
+ */
+void hierarchyFree(hierarchy_t *hierarchy) {
+    levelId_t id;
+
+    for (id = 0; id < LEVELS; id++) {
+        if (hierarchy->levels[id].present)
+            freeCacheTags(&hierarchy->levels[id].cache);
+        hierarchy->levels[id].present = false;
+    }
+    tlbFree(&hierarchy->tlb);
+}
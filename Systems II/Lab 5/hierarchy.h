@@ -0,0 +1,135 @@
+/*
+ * File:   hierarchy.h
+ * Author: Nathan Hernandez,
+ *         Alyssa Tyler
+ *
+ * LoginID: hernandeznp,
+ *          tylerae
+ *
+ * Multi-level cache hierarchy: split L1I/L1D, a unified L2 and a last-level
+ * cache, each inclusive, exclusive or non-inclusive non-exclusive (NINE)
+ * with respect to the levels above it. L1s are write-back and
+ * write-allocate; dirty lines are written back level by level.
+ * <p>
+ * The hierarchy is read from a config file with one level per line:
+ * <pre>
+ *   # name  geometry          [policy]   [inclusion]          [latency]
+ *   L1I     s=6 E=8 b=6
+ *   L1D     s=6 E=8 b=6       p=lru                           latency=4
+ *   L2      s=10 E=4 b=6                 inclusion=nine
+ *   LLC     s=12 E=16 b=6     p=srrip    inclusion=inclusive  latency=40
+ *   MEM                                                       latency=200
+ *   DTLB    s=4 E=4           page=2m
+ *   STLB    s=7 E=12
+ * </pre>
+ * Every level must use the same block size. L2 and LLC are optional; when
+ * L1I is missing instruction fetches go to L1D ("L1" is accepted for it).
+ * <p>
+ * DTLB and STLB add the L1 and L2 data TLBs of tlb.h; page (4k, 2m or 1g,
+ * default 4k) may be given on either line. Data accesses are translated
+ * before they reach L1D, and the page-table reads of every walk go through
+ * L1D and below like loads. A walk costs the latency of the level that
+ * serves each read (defaults 4, 14, 40 and 200 cycles).
+ * <p>
+ * Cache levels also take index= with a set index function of
+ * cacheSetIndex(), e.g. "index=slice,0x1b5f575440,0x2eb5faa880" to spread
+ * an LLC across slices like a sliced last-level cache.
+ */
+
+#ifndef HIERARCHY_H
+#define HIERARCHY_H
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include "cache.h"
+#include "tlb.h"
+#include "trace.h"
+
+/**
+ * Levels of the hierarchy, in the order they are printed.
+ */
+typedef enum levelId_t {
+    LEVEL_L1I,
+    LEVEL_L1D,
+    LEVEL_L2,
+    LEVEL_LLC,
+    LEVELS
+} levelId_t;
+
+/**
+ * Relation of a level to the levels above it.
+ */
+typedef enum inclusion_t {
+    INCLUSION_NINE,
+    INCLUSION_INCLUSIVE,
+    INCLUSION_EXCLUSIVE
+} inclusion_t;
+
+/**
+ * Level definition
+ */
+typedef struct level_t {
+    bool present;
+    uint8_t depth;
+    inclusion_t inclusion;
+    uint32_t latency;
+    Cache cache;
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t evictions;
+    uint64_t writebacks;
+    uint64_t backInvalidations;
+} level_t;
+
+/**
+ * Hierarchy definition
+ */
+typedef struct hierarchy_t {
+    level_t levels[LEVELS];
+    uint64_t memoryReads;
+    uint64_t memoryWrites;
+    uint32_t memoryLatency;
+    tlb_t tlb;
+} hierarchy_t;
+
+/**
+ * Reads a hierarchy config file and creates its caches.
+ * <p>
+ * Be sure to call hierarchyFree() to free memory and avoid memory leaks.
+ *
+ * @param hierarchy the hierarchy to initialize
+ * @param path path of the config file
+ * @return true on success
+ */
+bool hierarchyCreate(hierarchy_t *hierarchy, const char *path);
+
+/**
+ * Simulates a batch of trace records. Instruction fetches go to L1I and
+ * a modify is a load followed by a store; with a TLB, every data record is
+ * translated once first.
+ *
+ * @param hierarchy the hierarchy to simulate
+ * @param batch the records to simulate
+ * @param count number of records in batch
+ */
+void hierarchySimulateBatch(hierarchy_t *hierarchy, const trace_t *batch,
+        size_t count);
+
+/**
+ * Prints the counters of every level, of memory and of the TLB.
+ *
+ * @param hierarchy the hierarchy to report on
+ * @param stream the stream to print to
+ */
+void hierarchyPrint(hierarchy_t *hierarchy, FILE *stream);
+
+/**
+ * Frees the caches and TLB of a hierarchy.
+ *
+ * @param hierarchy the hierarchy to free
+ */
+void hierarchyFree(hierarchy_t *hierarchy);
+
+#endif  /* HIERARCHY_H */
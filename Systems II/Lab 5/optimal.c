@@ -0,0 +1,319 @@
+/*
+ * File:   optimal.c
+ * Author: Nathan Hernandez,
+ *         Alyssa Tyler
+ *
+ * LoginID: hernandeznp,
+ *          tylerae
+ *
+ * Belady's optimal replacement. See optimal.h.
+ */
+
+/**
+ * Includes
+ */
+#include "optimal.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * Initial number of access numbers in next.
+ */
+#define OPTIMAL_INITIAL_CAPACITY (1u << 16)
+
+/**
+ * Initial number of table slots in the first pass (a power of two).
+ */
+#define OPTIMAL_INITIAL_TABLE 4096
+
+/**
+ * Returns the home slot of a block in the table.
+ */
+static size_t optimalHome(optimal_t *optimal, uint64_t block) {
+    uint64_t hash = block * 0x9e3779b97f4a7c15ull;
+
+    return (hash ^ hash >> 32) & (optimal->tableSize - 1);
+}
+
+/**
+ * Allocates an optimal cache for the first pass.
+ */
+bool optimalCreate(optimal_t *optimal, uint8_t setBits,
+        uint32_t associativity, uint8_t blockBits) {
+    memset(optimal, 0, sizeof(optimal_t));
+    if (associativity < 1 || associativity > OPTIMAL_MAX_WAYS
+            || setBits + blockBits >= 64 || setBits >= 32
+            || ((uint64_t) associativity << setBits) > UINT32_MAX / 2)
+        return false;
+    optimal->setBits = setBits;
+    optimal->blockBits = blockBits;
+    optimal->associativity = associativity;
+    optimal->capacity = OPTIMAL_INITIAL_CAPACITY;
+    optimal->tableSize = OPTIMAL_INITIAL_TABLE;
+    optimal->next = malloc(optimal->capacity * sizeof(uint64_t));
+    optimal->table = calloc(optimal->tableSize, sizeof(optimalEntry_t));
+    return optimal->next != NULL && optimal->table != NULL;
+}
+
+/**
+ * Doubles the table and rehashes every entry.
+ *
+ * @return true on success
+ */
+static bool optimalGrow(optimal_t *optimal) {
+    optimalEntry_t *old = optimal->table;
+    size_t oldSize = optimal->tableSize;
+    size_t i, slot;
+
+    optimal->table = calloc(oldSize * 2, sizeof(optimalEntry_t));
+    if (optimal->table == NULL) {
+        optimal->table = old;
+        return false;
+    }
+    optimal->tableSize = oldSize * 2;
+    for (i = 0; i < oldSize; i++) {
+        if (!old[i].used)
+            continue;
+        slot = optimalHome(optimal, old[i].block);
+        while (optimal->table[slot].used)
+            slot = (slot + 1) & (optimal->tableSize - 1);
+        optimal->table[slot] = old[i];
+    }
+    free(old);
+    return true;
+}
+
+/**
+ * Finds the slot of a block, or the free slot ending its probe chain.
+ */
+static size_t optimalSlot(optimal_t *optimal, uint64_t block) {
+    size_t slot = optimalHome(optimal, block);
+
+    while (optimal->table[slot].used && optimal->table[slot].block != block)
+        slot = (slot + 1) & (optimal->tableSize - 1);
+    return slot;
+}
+
+/**
+ * Numbers one access and makes it the next use of the previous access to
+ * its block.
+ */
+static void optimalIndex(optimal_t *optimal, uint64_t address) {
+    uint64_t block = address >> optimal->blockBits;
+    uint64_t *next;
+    size_t slot;
+
+    if (optimal->accesses == optimal->capacity) {
+        next = realloc(optimal->next,
+                optimal->capacity * 2 * sizeof(uint64_t));
+        if (next == NULL) {
+            fprintf(stderr, "Out of memory growing the next-use index\n");
+            exit(EXIT_FAILURE);
+        }
+        optimal->next = next;
+        optimal->capacity *= 2;
+    }
+    if ((optimal->tableUsed + 1) * 2 > optimal->tableSize
+            && !optimalGrow(optimal)) {
+        fprintf(stderr, "Out of memory growing the next-use table\n");
+        exit(EXIT_FAILURE);
+    }
+
+    slot = optimalSlot(optimal, block);
+    if (optimal->table[slot].used) {
+        optimal->next[optimal->table[slot].value] = optimal->accesses;
+    } else {
+        optimal->table[slot].block = block;
+        optimal->table[slot].used = true;
+        optimal->tableUsed++;
+    }
+    optimal->table[slot].value = optimal->accesses;
+    optimal->next[optimal->accesses++] = OPTIMAL_NEVER;
+}
+
+/**
+ * Numbers a batch of trace records.
+ */
+void optimalIndexBatch(optimal_t *optimal, const trace_t *batch,
+        size_t count) {
+    size_t i;
+
+    for (i = 0; i < count; i++) {
+        switch (batch[i].operation) {
+            case 'M':
+                optimalIndex(optimal, batch[i].address);
+                /* fall through */
+            case 'L':
+            case 'S':
+                optimalIndex(optimal, batch[i].address);
+                break;
+        }
+    }
+}
+
+/**
+ * Ends the first pass and allocates the lines for the second. The table
+ * then maps resident blocks to their lines and never grows.
+ */
+bool optimalStart(optimal_t *optimal) {
+    size_t lines = (size_t) optimal->associativity << optimal->setBits;
+
+    free(optimal->table);
+    optimal->tableSize = 1;
+    while (optimal->tableSize < 2 * lines)
+        optimal->tableSize *= 2;
+    optimal->tableUsed = 0;
+    optimal->now = 0;
+    optimal->table = calloc(optimal->tableSize, sizeof(optimalEntry_t));
+    optimal->blocks = malloc(lines * sizeof(uint64_t));
+    optimal->keys = malloc(lines * sizeof(uint64_t));
+    optimal->heap = malloc(lines * sizeof(uint32_t));
+    optimal->positions = malloc(lines * sizeof(uint32_t));
+    optimal->filled = calloc((size_t) 1 << optimal->setBits,
+            sizeof(uint32_t));
+    return optimal->table && optimal->blocks && optimal->keys
+            && optimal->heap && optimal->positions && optimal->filled;
+}
+
+/**
+ * Deletes a table slot, shifting later slots of its probe chain back so
+ * lookups still find them.
+ */
+static void optimalRemove(optimal_t *optimal, size_t hole) {
+    size_t mask = optimal->tableSize - 1;
+    size_t slot = hole, home;
+
+    for (;;) {
+        slot = (slot + 1) & mask;
+        if (!optimal->table[slot].used)
+            break;
+        home = optimalHome(optimal, optimal->table[slot].block);
+        if (((slot - home) & mask) >= ((slot - hole) & mask)) {
+            optimal->table[hole] = optimal->table[slot];
+            hole = slot;
+        }
+    }
+    optimal->table[hole].used = false;
+}
+
+/**
+ * Moves the way at heap position k of a set up while its next use is
+ * later than its parent's.
+ */
+static void optimalSiftUp(optimal_t *optimal, size_t base, uint32_t k) {
+    uint32_t way = optimal->heap[base + k], parent;
+    uint64_t key = optimal->keys[base + way];
+
+    while (k > 0) {
+        parent = (k - 1) / 2;
+        if (optimal->keys[base + optimal->heap[base + parent]] >= key)
+            break;
+        optimal->heap[base + k] = optimal->heap[base + parent];
+        optimal->positions[base + optimal->heap[base + k]] = k;
+        k = parent;
+    }
+    optimal->heap[base + k] = way;
+    optimal->positions[base + way] = k;
+}
+
+/**
+ * Moves the way at heap position k of a set down while a child's next use
+ * is later.
+ */
+static void optimalSiftDown(optimal_t *optimal, size_t base, uint32_t k,
+        uint32_t size) {
+    uint32_t way = optimal->heap[base + k], child;
+    uint64_t key = optimal->keys[base + way];
+
+    while ((child = 2 * k + 1) < size) {
+        if (child + 1 < size && optimal->keys[base + optimal->heap[base
+                + child + 1]] > optimal->keys[base + optimal->heap[base
+                + child]])
+            child++;
+        if (optimal->keys[base + optimal->heap[base + child]] <= key)
+            break;
+        optimal->heap[base + k] = optimal->heap[base + child];
+        optimal->positions[base + optimal->heap[base + k]] = k;
+        k = child;
+    }
+    optimal->heap[base + k] = way;
+    optimal->positions[base + way] = k;
+}
+
+/**
+ * Performs one access, evicting the line used furthest in the future.
+ */
+static void optimalAccess(optimal_t *optimal, uint64_t address) {
+    uint64_t block = address >> optimal->blockBits;
+    uint64_t key = optimal->now < optimal->accesses
+            ? optimal->next[optimal->now] : OPTIMAL_NEVER;
+    size_t set = block & (((size_t) 1 << optimal->setBits) - 1);
+    size_t base = set * optimal->associativity;
+    size_t slot = optimalSlot(optimal, block);
+    uint32_t way;
+
+    optimal->now++;
+    if (optimal->table[slot].used) {
+        optimal->hits++;
+        way = optimal->table[slot].value - base;
+        optimal->keys[base + way] = key;
+        optimalSiftUp(optimal, base, optimal->positions[base + way]);
+        return;
+    }
+
+    optimal->misses++;
+    if (optimal->filled[set] < optimal->associativity) {
+        way = optimal->filled[set]++;
+        optimal->blocks[base + way] = block;
+        optimal->keys[base + way] = key;
+        optimal->heap[base + way] = way;
+        optimalSiftUp(optimal, base, way);
+    } else {
+        way = optimal->heap[base];
+        optimal->evictions++;
+        optimalRemove(optimal, optimalSlot(optimal,
+                optimal->blocks[base + way]));
+        slot = optimalSlot(optimal, block);
+        optimal->blocks[base + way] = block;
+        optimal->keys[base + way] = key;
+        optimalSiftDown(optimal, base, 0, optimal->associativity);
+    }
+    optimal->table[slot].block = block;
+    optimal->table[slot].value = base + way;
+    optimal->table[slot].used = true;
+}
+
+/**
+ * Simulates a batch of trace records.
+ */
+void optimalSimulateBatch(optimal_t *optimal, const trace_t *batch,
+        size_t count) {
+    size_t i;
+
+    for (i = 0; i < count; i++) {
+        switch (batch[i].operation) {
+            case 'M':
+                optimalAccess(optimal, batch[i].address);
+                /* fall through */
+            case 'L':
+            case 'S':
+                optimalAccess(optimal, batch[i].address);
+                break;
+        }
+    }
+}
+
+/**
+ * Frees memory allocated by optimalCreate() and optimalStart().
+ */
+void optimalFree(optimal_t *optimal) {
+    free(optimal->next);
+    free(optimal->table);
+    free(optimal->blocks);
+    free(optimal->keys);
+    free(optimal->heap);
+    free(optimal->positions);
+    free(optimal->filled);
+    memset(optimal, 0, sizeof(optimal_t));
+}
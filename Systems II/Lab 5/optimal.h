@@ -0,0 +1,130 @@
+/*
+ * File:   optimal.h
+ * Author: Nathan Hernandez,
+ *         Alyssa Tyler
+ *
+ * LoginID: hernandeznp,
+ *          tylerae
+ *
+ * Belady's optimal (MIN) replacement, an upper bound for every policy of
+ * cache.h on the same geometry.
+ * <p>
+ * OPT needs the future, so the trace is read twice. The first pass numbers
+ * every data access (a modify is two) and records in next[i] the number of
+ * the next access to the same block, or OPTIMAL_NEVER. The second pass
+ * simulates the cache: every set keeps a binary max-heap of its ways keyed
+ * by the next use of their block, and a miss in a full set evicts the top.
+ * Like the other policies, OPT always allocates the missing block; it never
+ * bypasses the cache.
+ * <p>
+ * next takes 8 bytes per data access, so memory grows with the length of
+ * the trace rather than with its footprint.
+ */
+
+#ifndef OPTIMAL_H
+#define OPTIMAL_H
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "trace.h"
+
+/**
+ * Next use of a block that is never accessed again.
+ */
+#define OPTIMAL_NEVER UINT64_MAX
+
+/**
+ * Largest associativity optimalCreate() accepts.
+ */
+#define OPTIMAL_MAX_WAYS (1 << 20)
+
+/**
+ * Block to access number (first pass) or line (second pass) entry.
+ */
+typedef struct optimalEntry_t {
+    uint64_t block;
+    uint64_t value;
+    bool used;
+} optimalEntry_t;
+
+/**
+ * Optimal cache definition
+ * <p>
+ * Line set * associativity + way holds blocks[line] with its next use in
+ * keys[line]. heap[set * associativity + k] is the way at heap position k,
+ * and positions[line] is the heap position of a way.
+ */
+typedef struct optimal_t {
+    uint8_t setBits;
+    uint8_t blockBits;
+    uint32_t associativity;
+    uint64_t * next;
+    size_t accesses;
+    size_t capacity;
+    optimalEntry_t * table;
+    size_t tableSize;
+    size_t tableUsed;
+    uint64_t * blocks;
+    uint64_t * keys;
+    uint32_t * heap;
+    uint32_t * positions;
+    uint32_t * filled;
+    size_t now;
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t evictions;
+} optimal_t;
+
+/**
+ * Allocates an optimal cache for the first pass.
+ * <p>
+ * Be sure to call optimalFree() to free memory and avoid memory leaks.
+ *
+ * @param optimal the cache to initialize
+ * @param setBits number of set index bits
+ * @param associativity number of lines per set
+ * @param blockBits number of block bits
+ * @return true on success
+ */
+bool optimalCreate(optimal_t *optimal, uint8_t setBits,
+        uint32_t associativity, uint8_t blockBits);
+
+/**
+ * First pass: numbers a batch of trace records and links every access to
+ * the previous access to its block.
+ *
+ * @param optimal the cache being indexed
+ * @param batch the records to index
+ * @param count number of records in batch
+ */
+void optimalIndexBatch(optimal_t *optimal, const trace_t *batch,
+        size_t count);
+
+/**
+ * Ends the first pass and allocates the lines for the second.
+ *
+ * @param optimal the indexed cache
+ * @return true on success
+ */
+bool optimalStart(optimal_t *optimal);
+
+/**
+ * Second pass: simulates a batch of the same records, in the same order.
+ *
+ * @param optimal the cache to simulate; now ends equal to accesses unless
+ *                the trace changed between the passes
+ * @param batch the records to simulate
+ * @param count number of records in batch
+ */
+void optimalSimulateBatch(optimal_t *optimal, const trace_t *batch,
+        size_t count);
+
+/**
+ * Frees memory allocated by optimalCreate() and optimalStart().
+ *
+ * @param optimal the cache to free
+ */
+void optimalFree(optimal_t *optimal);
+
+#endif  /* OPTIMAL_H */
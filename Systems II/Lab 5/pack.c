@@ -0,0 +1,194 @@
+/*
+ * File:   pack.c
+ * Author: Nathan Hernandez,
+ *         Alyssa Tyler
+ *
+ * LoginID: hernandeznp,
+ *          tylerae
+ *
+ * Compact binary trace format. See pack.h.
+ */
+
+/**
+ * Includes
+ */
+#include "pack.h"
+#include <string.h>
+
+/**
+ * Operation characters indexed by their two bit code.
+ */
+static const char operations[4] = { 'I', 'L', 'S', 'M' };
+
+/**
+ * Stores a little-endian uint32.
+ */
+static void packPut32(uint8_t *p, uint32_t value) {
+    p[0] = value;
+    p[1] = value >> 8;
+    p[2] = value >> 16;
+    p[3] = value >> 24;
+}
+
+/**
+ * Loads a little-endian uint32.
+ */
+static uint32_t packGet32(const uint8_t *p) {
+    return p[0] | p[1] << 8 | p[2] << 16 | (uint32_t) p[3] << 24;
+}
+
+/**
+ * Writes out the buffered block, if any.
+ */
+static bool packFlush(packWriter_t *writer) {
+    uint8_t header[PACK_BLOCK_HEADER_SIZE];
+
+    if (writer->records == 0)
+        return true;
+
+    packPut32(header, writer->records);
+    packPut32(header + 4, writer->used);
+    if (fwrite(header, sizeof(header), 1, writer->file) != 1
+            || fwrite(writer->buffer, writer->used, 1, writer->file) != 1)
+        return false;
+
+    writer->totalBytes += sizeof(header) + writer->used;
+    writer->used = 0;
+    writer->records = 0;
+    writer->previous = 0;
+    return true;
+}
+
+/**
+ * Creates a packed trace file and writes its header.
+ */
+bool packOpen(packWriter_t *writer, const char *path) {
+    uint8_t header[PACK_HEADER_SIZE];
+
+    writer->used = 0;
+    writer->records = 0;
+    writer->previous = 0;
+    writer->totalRecords = 0;
+    writer->totalBytes = PACK_HEADER_SIZE;
+    writer->file = fopen(path, "wb");
+    if (writer->file == NULL) {
+        perror("Error creating file");
+        return false;
+    }
+
+    memcpy(header, PACK_MAGIC, 8);
+    packPut32(header + 8, PACK_VERSION);
+    packPut32(header + 12, PACK_BLOCK_RECORDS);
+    if (fwrite(header, sizeof(header), 1, writer->file) != 1) {
+        fclose(writer->file);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Appends a record, writing out the current block when it is full.
+ */
+bool packAppend(packWriter_t *writer, const trace_t *trace) {
+    uint8_t *p = writer->buffer + writer->used;
+    int64_t delta = (int64_t) (trace->address - writer->previous);
+    uint64_t zigzag = ((uint64_t) delta << 1) ^ (uint64_t) (delta >> 63);
+    uint8_t operation;
+
+    switch (trace->operation) {
+        case 'I': operation = 0; break;
+        case 'L': operation = 1; break;
+        case 'S': operation = 2; break;
+        case 'M': operation = 3; break;
+        default: return false;
+    }
+
+    if (trace->size < PACK_SIZE_ESCAPE) {
+        *p++ = operation << 6 | trace->size;
+    } else {
+        *p++ = operation << 6 | PACK_SIZE_ESCAPE;
+        *p++ = trace->size;
+    }
+    while (zigzag >= 0x80) {
+        *p++ = zigzag | 0x80;
+        zigzag >>= 7;
+    }
+    *p++ = zigzag;
+
+    writer->used = p - writer->buffer;
+    writer->previous = trace->address;
+    writer->totalRecords++;
+    if (++writer->records == PACK_BLOCK_RECORDS)
+        return packFlush(writer);
+    return true;
+}
+
+/**
+ * Writes out the last block and closes the file.
+ */
+bool packClose(packWriter_t *writer) {
+    bool success = packFlush(writer);
+
+    if (fclose(writer->file) != 0)
+        success = false;
+    return success;
+}
+
+/**
+ * Checks whether a buffer starts with a packed trace header.
+ */
+bool packIsPacked(const char *data, size_t length) {
+    return length >= PACK_HEADER_SIZE
+            && memcmp(data, PACK_MAGIC, 8) == 0
+            && packGet32((const uint8_t *) data + 8) == PACK_VERSION;
+}
+
+/**
+ * Decodes records from a block payload.
+ */
+const uint8_t * packDecode(const uint8_t *p, const uint8_t *end,
+        uint64_t *previous, trace_t *batch, size_t count) {
+    uint64_t address = *previous;
+    uint64_t zigzag;
+    unsigned shift;
+    uint8_t byte;
+    size_t i;
+
+    for (i = 0; i < count; i++) {
+        if (p == end)
+            return NULL;
+        byte = *p++;
+        batch[i].operation = operations[byte >> 6];
+        batch[i].thread = 0;
+        batch[i].sample = TRACE_MEASURE;
+        batch[i].size = byte & PACK_SIZE_ESCAPE;
+        if (batch[i].size == PACK_SIZE_ESCAPE) {
+            if (p == end)
+                return NULL;
+            batch[i].size = *p++;
+        }
+
+        zigzag = 0;
+        shift = 0;
+        do {
+            if (p == end || shift > 63)
+                return NULL;
+            byte = *p++;
+            zigzag |= (uint64_t) (byte & 0x7f) << shift;
+            shift += 7;
+        } while (byte & 0x80);
+
+        address += (zigzag >> 1) ^ -(zigzag & 1);
+        batch[i].address = address;
+    }
+    *previous = address;
+    return p;
+}
+
+/**
+ * Reads the record count and payload length of a block header.
+ */
+void packBlockHeader(const uint8_t *p, uint32_t *records, uint32_t *bytes) {
+    *records = packGet32(p);
+    *bytes = packGet32(p + 4);
+}
@@ -0,0 +1,115 @@
+/*
+ * File:   pack.h
+ * Author: Nathan Hernandez,
+ *         Alyssa Tyler
+ *
+ * LoginID: hernandeznp,
+ *          tylerae
+ *
+ * Compact binary trace format.
+ * <p>
+ * A file starts with a 16 byte header: the magic "CSIMPACK", a uint32
+ * version and the uint32 maximum number of records per block. Blocks
+ * follow, each a uint32 record count and uint32 payload length and then
+ * the payload. A record is one byte holding the operation (bits 6-7) and
+ * size (bits 0-5, 63 escapes to a following raw size byte) followed by the
+ * zigzag varint delta from the previous address. The previous address is
+ * reset to 0 at the start of every block so blocks decode independently.
+ * All integers are little-endian. Thread ids are not stored, so csim-pack
+ * refuses traces that tag records with a thread other than 0.
+ */
+
+#ifndef PACK_H
+#define PACK_H
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include "trace.h"
+
+#define PACK_MAGIC "CSIMPACK"
+#define PACK_VERSION 1
+#define PACK_HEADER_SIZE 16
+#define PACK_BLOCK_HEADER_SIZE 8
+#define PACK_BLOCK_RECORDS 4096
+#define PACK_SIZE_ESCAPE 63
+
+/**
+ * Largest encoding of one record: operation byte, escaped size byte and a
+ * ten byte varint.
+ */
+#define PACK_MAX_RECORD_SIZE 12
+
+/**
+ * Packed trace writer definition
+ */
+typedef struct packWriter_t {
+    FILE * file;
+    uint8_t buffer[PACK_BLOCK_RECORDS * PACK_MAX_RECORD_SIZE];
+    size_t used;
+    uint32_t records;
+    uint64_t previous;
+    uint64_t totalRecords;
+    uint64_t totalBytes;
+} packWriter_t;
+
+/**
+ * Creates a packed trace file and writes its header.
+ *
+ * @param writer the writer to initialize
+ * @param path path of the file to create
+ * @return true on success
+ */
+bool packOpen(packWriter_t *writer, const char *path);
+
+/**
+ * Appends a record, writing out the current block when it is full.
+ *
+ * @param writer the writer to append to
+ * @param trace the record to append
+ * @return true on success
+ */
+bool packAppend(packWriter_t *writer, const trace_t *trace);
+
+/**
+ * Writes out the last block and closes the file.
+ *
+ * @param writer the writer to close
+ * @return true on success
+ */
+bool packClose(packWriter_t *writer);
+
+/**
+ * Checks whether a buffer starts with a packed trace header.
+ *
+ * @param data the start of the file
+ * @param length the length of the file
+ * @return true if the header is valid
+ */
+bool packIsPacked(const char *data, size_t length);
+
+/**
+ * Decodes records from a block payload.
+ *
+ * @param p current position in the payload
+ * @param end end of the payload
+ * @param previous previous address, updated as records are decoded
+ * @param batch array receiving the decoded records
+ * @param count number of records to decode
+ * @return the position after the last record, or NULL if the payload is
+ * corrupt
+ */
+const uint8_t * packDecode(const uint8_t *p, const uint8_t *end,
+        uint64_t *previous, trace_t *batch, size_t count);
+
+/**
+ * Reads the record count and payload length of a block header.
+ *
+ * @param p the start of the block header
+ * @param records receives the number of records in the block
+ * @param bytes receives the length of the block payload
+ */
+void packBlockHeader(const uint8_t *p, uint32_t *records, uint32_t *bytes);
+
+#endif  /* PACK_H */
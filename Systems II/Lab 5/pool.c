@@ -0,0 +1,152 @@
+/*
+ * File:   pool.c
+ * Author: Nathan Hernandez,
+ *         Alyssa Tyler
+ *
+ * LoginID: hernandeznp,
+ *          tylerae
+ *
+ * Work-stealing thread pool. See pool.h.
+ */
+
+/**
+ * Includes
+ */
+#include "pool.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+/**
+ * Worker definition
+ * <p>
+ * range packs the worker's remaining task indices [head, tail) as
+ * head << 32 | tail, so the owner taking the tail and thieves taking the
+ * head agree through a single compare-and-swap.
+ */
+typedef struct poolWorker_t {
+    _Alignas(64) _Atomic uint64_t range;
+    struct pool_t *pool;
+    unsigned id;
+    pthread_t thread;
+} poolWorker_t;
+
+/**
+ * Pool definition
+ */
+typedef struct pool_t {
+    poolWorker_t *workers;
+    unsigned threads;
+    poolTask_t task;
+    void *context;
+} pool_t;
+
+/**
+ * Takes a task from the back (owner) or front (thief) of a worker's range.
+ *
+ * @return true if a task was taken
+ */
+static bool poolTake(poolWorker_t *worker, bool steal, size_t *index) {
+    uint64_t range = atomic_load(&worker->range);
+    uint64_t head, tail;
+
+    for (;;) {
+        head = range >> 32;
+        tail = range & UINT32_MAX;
+        if (head >= tail)
+            return false;
+        if (steal ? atomic_compare_exchange_weak(&worker->range, &range,
+                        (head + 1) << 32 | tail)
+                : atomic_compare_exchange_weak(&worker->range, &range,
+                        head << 32 | (tail - 1))) {
+            *index = steal ? head : tail - 1;
+            return true;
+        }
+    }
+}
+
+/**
+ * Worker thread: runs its own tasks, then steals until every range is
+ * empty. Tasks never create tasks, so an empty sweep means the pool is
+ * done.
+ */
+static void * poolWorker(void *argument) {
+    poolWorker_t *worker = argument;
+    pool_t *pool = worker->pool;
+    size_t index;
+    unsigned victim, i;
+    bool found;
+
+    for (;;) {
+        if (poolTake(worker, false, &index)) {
+            pool->task(pool->context, index);
+            continue;
+        }
+        found = false;
+        for (i = 1; !found && i < pool->threads; i++) {
+            victim = (worker->id + i) % pool->threads;
+            found = poolTake(&pool->workers[victim], true, &index);
+        }
+        if (!found)
+            return NULL;
+        pool->task(pool->context, index);
+    }
+}
+
+/**
+ * Returns the number of online processors, at least 1.
+ */
+unsigned poolDefaultThreads(void) {
+    long processors = sysconf(_SC_NPROCESSORS_ONLN);
+
+    if (processors < 1)
+        return 1;
+    return processors < POOL_MAX_THREADS ? processors : POOL_MAX_THREADS;
+}
+
+/**
+ * Runs every task on a pool of threads and waits for all of them.
+ */
+bool poolRun(unsigned threads, size_t tasks, poolTask_t task, void *context) {
+    pool_t pool;
+    size_t first = 0, share;
+    unsigned i, started;
+
+    if (threads < 1 || threads > POOL_MAX_THREADS || tasks > UINT32_MAX)
+        return false;
+    if (threads > tasks)
+        threads = tasks ? tasks : 1;
+
+    pool.workers = aligned_alloc(64, threads * sizeof(poolWorker_t));
+    if (pool.workers == NULL)
+        return false;
+    pool.threads = threads;
+    pool.task = task;
+    pool.context = context;
+
+    for (i = 0; i < threads; i++) {
+        share = tasks / threads + (i < tasks % threads);
+        atomic_init(&pool.workers[i].range,
+                (uint64_t) first << 32 | (first + share));
+        first += share;
+        pool.workers[i].pool = &pool;
+        pool.workers[i].id = i;
+    }
+
+    for (started = 0; started < threads; started++)
+        if (pthread_create(&pool.workers[started].thread, NULL, poolWorker,
+                &pool.workers[started]) != 0)
+            break;
+    if (started == 0) {
+        free(pool.workers);
+        return false;
+    }
+    // Workers that failed to start have their tasks stolen by the others.
+    for (i = 0; i < started; i++)
+        pthread_join(pool.workers[i].thread, NULL);
+
+    free(pool.workers);
+    return true;
+}
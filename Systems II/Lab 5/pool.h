@@ -0,0 +1,49 @@
+/*
+ * File:   pool.h
+ * Author: Nathan Hernandez,
+ *         Alyssa Tyler
+ *
+ * LoginID: hernandeznp,
+ *          tylerae
+ *
+ * Work-stealing thread pool for a fixed set of independent tasks. Every
+ * worker starts with a contiguous range of task indices, runs them from the
+ * back and, once it runs dry, steals from the front of other workers'
+ * ranges, so long tasks do not leave cores idle.
+ */
+
+#ifndef POOL_H
+#define POOL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * Largest number of workers.
+ */
+#define POOL_MAX_THREADS 256
+
+/**
+ * Task callback, called once for every index in [0, tasks).
+ */
+typedef void (*poolTask_t)(void *context, size_t index);
+
+/**
+ * Returns the number of online processors, at least 1.
+ *
+ * @return the default pool size
+ */
+unsigned poolDefaultThreads(void);
+
+/**
+ * Runs every task on a pool of threads and waits for all of them.
+ *
+ * @param threads number of workers (1-POOL_MAX_THREADS)
+ * @param tasks number of tasks
+ * @param task the callback running one task
+ * @param context first argument of task
+ * @return true on success, false if the threads could not be started
+ */
+bool poolRun(unsigned threads, size_t tasks, poolTask_t task, void *context);
+
+#endif  /* POOL_H */
@@ -0,0 +1,441 @@
+/*
+ * File:   prefetch.c
+ * Author: Nathan Hernandez,
+ *         Alyssa Tyler
+ *
+ * LoginID: hernandeznp,
+ *          tylerae
+ *
+ * Hardware prefetcher models. See prefetch.h.
+ */
+
+/**
+ * Includes
+ */
+#include "prefetch.h"
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * Confidence a stride needs before it is prefetched.
+ */
+#define STRIDE_CONFIDENT 2
+
+/**
+ * Largest stride confidence.
+ */
+#define STRIDE_CONFIDENCE_MAX 3
+
+/**
+ * Page bits used to key strides when the trace has no instruction records.
+ */
+#define STRIDE_PAGE_BITS 12
+
+/**
+ * Hashes a block or key for the open-addressing tables.
+ */
+static uint64_t prefetchHash(uint64_t key) {
+    uint64_t hash = key * 0x9e3779b97f4a7c15ull;
+
+    return hash ^ hash >> 32;
+}
+
+/**
+ * Finds the pending entry of a prefetched block.
+ *
+ * @return the entry, or NULL if the block is not pending
+ */
+static pendingEntry_t * pendingFind(prefetcher_t *prefetcher, uint64_t block) {
+    size_t mask = prefetcher->pendingSize - 1;
+    size_t slot = prefetchHash(block) & mask;
+
+    while (prefetcher->pending[slot].used) {
+        if (prefetcher->pending[slot].block == block)
+            return &prefetcher->pending[slot];
+        slot = (slot + 1) & mask;
+    }
+    return NULL;
+}
+
+/**
+ * Records a prefetched block. The table holds at least twice as many slots
+ * as the cache has lines and only resident blocks are pending, so it never
+ * fills up.
+ */
+static void pendingAdd(prefetcher_t *prefetcher, uint64_t block,
+        uint64_t ready) {
+    size_t mask = prefetcher->pendingSize - 1;
+    size_t slot = prefetchHash(block) & mask;
+
+    while (prefetcher->pending[slot].used)
+        slot = (slot + 1) & mask;
+    prefetcher->pending[slot].block = block;
+    prefetcher->pending[slot].ready = ready;
+    prefetcher->pending[slot].used = true;
+}
+
+/**
+ * Deletes a pending entry, shifting later entries of its probe chain back so
+ * lookups still find them.
+ */
+static void pendingRemove(prefetcher_t *prefetcher, pendingEntry_t *entry) {
+    size_t mask = prefetcher->pendingSize - 1;
+    size_t hole = entry - prefetcher->pending;
+    size_t slot = hole, home;
+
+    for (;;) {
+        slot = (slot + 1) & mask;
+        if (!prefetcher->pending[slot].used)
+            break;
+        home = prefetchHash(prefetcher->pending[slot].block) & mask;
+        if (((slot - home) & mask) >= ((slot - hole) & mask)) {
+            prefetcher->pending[hole] = prefetcher->pending[slot];
+            hole = slot;
+        }
+    }
+    prefetcher->pending[hole].used = false;
+}
+
+/**
+ * Parses an unsigned option value within [min, max].
+ *
+ * @return true if value is a number within range
+ */
+static bool prefetchParseValue(const char *value, unsigned min, unsigned max,
+        unsigned *result) {
+    char *end;
+    unsigned long number = strtoul(value, &end, 10);
+
+    if (*value == '\0' || *end != '\0' || number < min || number > max)
+        return false;
+    *result = number;
+    return true;
+}
+
+/**
+ * Creates a prefetcher from a specification.
+ */
+bool prefetchCreate(prefetcher_t *prefetcher, const char *spec, Cache *cache) {
+    char buffer[256];
+    char *option, *value;
+    size_t lines;
+    bool valid;
+
+    memset(prefetcher, 0, sizeof(prefetcher_t));
+    prefetcher->cache = cache;
+    prefetcher->degree = 1;
+    prefetcher->distance = 1;
+    prefetcher->latency = 0;
+    prefetcher->streams = 4;
+
+    if (strlen(spec) >= sizeof(buffer)) {
+        fprintf(stderr, "prefetcher specification too long\n");
+        return false;
+    }
+    strcpy(buffer, spec);
+
+    option = strtok(buffer, ",");
+    if (option != NULL && strcmp(option, "nextline") == 0) {
+        prefetcher->kind = PREFETCH_NEXTLINE;
+    } else if (option != NULL && strcmp(option, "stride") == 0) {
+        prefetcher->kind = PREFETCH_STRIDE;
+    } else if (option != NULL && strcmp(option, "stream") == 0) {
+        prefetcher->kind = PREFETCH_STREAM;
+        prefetcher->degree = 4;
+    } else {
+        fprintf(stderr, "unknown prefetcher %s\n", option ? option : "");
+        return false;
+    }
+
+    while ((option = strtok(NULL, ",")) != NULL) {
+        value = strchr(option, '=');
+        if (value == NULL) {
+            fprintf(stderr, "prefetcher: expected key=value, got %s\n",
+                    option);
+            return false;
+        }
+        *value++ = '\0';
+        if (strcmp(option, "degree") == 0)
+            valid = prefetchParseValue(value, 1, PREFETCH_MAX_DEGREE,
+                    &prefetcher->degree);
+        else if (strcmp(option, "distance") == 0)
+            valid = prefetchParseValue(value, 1, 1u << 20,
+                    &prefetcher->distance);
+        else if (strcmp(option, "latency") == 0)
+            valid = prefetchParseValue(value, 0, 1u << 30,
+                    &prefetcher->latency);
+        else if (strcmp(option, "streams") == 0)
+            valid = prefetchParseValue(value, 1, PREFETCH_MAX_STREAMS,
+                    &prefetcher->streams);
+        else
+            valid = false;
+        if (!valid) {
+            fprintf(stderr, "prefetcher: bad option %s=%s\n", option, value);
+            return false;
+        }
+    }
+
+    lines = (size_t) cache->setSize * cache->associativity;
+    prefetcher->pendingSize = 1;
+    while (prefetcher->pendingSize < lines * 2)
+        prefetcher->pendingSize <<= 1;
+    prefetcher->pending = calloc(prefetcher->pendingSize,
+            sizeof(pendingEntry_t));
+    return prefetcher->pending != NULL;
+}
+
+/**
+ * Accounts for a line leaving the cache. An unused prefetched line was a
+ * useless prefetch; a demand line pushed out by a prefetch fill goes into
+ * the pollution filter.
+ */
+static void prefetchEvicted(prefetcher_t *prefetcher, uint64_t victim,
+        bool byPrefetch) {
+    uint64_t block = victim >> prefetcher->cache->blockBits;
+    pendingEntry_t *entry = pendingFind(prefetcher, block);
+
+    if (entry != NULL) {
+        prefetcher->useless++;
+        pendingRemove(prefetcher, entry);
+    } else if (byPrefetch) {
+        prefetcher->pollutionEvictions++;
+        prefetcher->pollution[prefetchHash(block)
+                & (PREFETCH_POLLUTION_SIZE - 1)] = block + 1;
+    }
+}
+
+/**
+ * Prefetches a block into the cache unless it is already there.
+ */
+static void prefetchFill(prefetcher_t *prefetcher, uint64_t block) {
+    Cache *cache = prefetcher->cache;
+    uint64_t address = block << cache->blockBits;
+    uint64_t victim;
+    bool victimDirty;
+
+    if (cacheContains(cache, address))
+        return;
+    prefetcher->issued++;
+    if (cacheInsert(cache, address, false, &victim, &victimDirty))
+        prefetchEvicted(prefetcher, victim, true);
+    pendingAdd(prefetcher, block, prefetcher->now + prefetcher->latency);
+}
+
+/**
+ * Trains the stride table on a demand access and prefetches along a
+ * confident stride.
+ */
+static void prefetchStride(prefetcher_t *prefetcher, uint64_t address,
+        uint64_t block) {
+    uint64_t key = prefetcher->pc ? prefetcher->pc
+            : (address >> STRIDE_PAGE_BITS) | 1ull << 63;
+    strideEntry_t *entry = &prefetcher->strides[prefetchHash(key)
+            & (PREFETCH_STRIDE_ENTRIES - 1)];
+    int64_t delta;
+    unsigned i;
+
+    if (entry->key != key) {
+        entry->key = key;
+        entry->last = block;
+        entry->stride = 0;
+        entry->confidence = 0;
+        return;
+    }
+
+    delta = (int64_t) (block - entry->last);
+    if (delta == 0)
+        return;
+    if (delta == entry->stride) {
+        if (entry->confidence < STRIDE_CONFIDENCE_MAX)
+            entry->confidence++;
+    } else {
+        entry->stride = delta;
+        entry->confidence = 0;
+    }
+    entry->last = block;
+
+    if (entry->confidence < STRIDE_CONFIDENT)
+        return;
+    for (i = 0; i < prefetcher->degree; i++)
+        prefetchFill(prefetcher, block
+                + entry->stride * (int64_t) (prefetcher->distance + i));
+}
+
+/**
+ * Appends the next block of a stream to the tail of its buffer.
+ */
+static void streamPush(prefetcher_t *prefetcher, streamBuffer_t *buffer) {
+    unsigned tail = (buffer->head + buffer->count) % PREFETCH_MAX_DEGREE;
+
+    buffer->blocks[tail] = buffer->next++;
+    buffer->ready[tail] = prefetcher->now + prefetcher->latency;
+    buffer->count++;
+    prefetcher->issued++;
+}
+
+/**
+ * Looks for a missing block in the stream buffers. On a match the entries
+ * ahead of it are dropped, the block moves into the cache and the buffer is
+ * topped up; otherwise the least recently used buffer restarts after the
+ * block.
+ *
+ * @return CACHE_HIT if a buffer held the block in time, CACHE_MISS otherwise
+ */
+static cacheResult_t prefetchStream(prefetcher_t *prefetcher, uint64_t block) {
+    streamBuffer_t *buffer, *oldest = &prefetcher->buffers[0];
+    cacheResult_t result = CACHE_MISS;
+    unsigned stream, i;
+
+    for (stream = 0; stream < prefetcher->streams; stream++) {
+        buffer = &prefetcher->buffers[stream];
+        if (buffer->used < oldest->used)
+            oldest = buffer;
+        for (i = 0; i < buffer->count; i++)
+            if (buffer->blocks[(buffer->head + i) % PREFETCH_MAX_DEGREE]
+                    == block)
+                break;
+        if (i == buffer->count)
+            continue;
+
+        prefetcher->useless += i;
+        buffer->head = (buffer->head + i) % PREFETCH_MAX_DEGREE;
+        buffer->count -= i;
+        if (buffer->ready[buffer->head] > prefetcher->now) {
+            prefetcher->late++;
+        } else {
+            prefetcher->useful++;
+            result = CACHE_HIT;
+        }
+        buffer->head = (buffer->head + 1) % PREFETCH_MAX_DEGREE;
+        buffer->count--;
+        buffer->used = prefetcher->now;
+        while (buffer->count < prefetcher->degree)
+            streamPush(prefetcher, buffer);
+        return result;
+    }
+
+    prefetcher->useless += oldest->count;
+    oldest->head = 0;
+    oldest->count = 0;
+    oldest->next = block + prefetcher->distance;
+    oldest->used = prefetcher->now;
+    while (oldest->count < prefetcher->degree)
+        streamPush(prefetcher, oldest);
+    return CACHE_MISS;
+}
+
+/**
+ * Performs a demand access and lets the prefetcher react to it.
+ */
+static void prefetchAccess(prefetcher_t *prefetcher, uint64_t address) {
+    Cache *cache = prefetcher->cache;
+    uint64_t block = address >> cache->blockBits;
+    uint64_t *filter;
+    pendingEntry_t *entry;
+    uint64_t victim;
+    bool victimDirty, trigger = false;
+    unsigned i;
+
+    prefetcher->now++;
+    if (cacheTouch(cache, address)) {
+        entry = pendingFind(prefetcher, block);
+        if (entry == NULL) {
+            cache->hits++;
+        } else {
+            if (entry->ready > prefetcher->now) {
+                prefetcher->late++;
+                cache->misses++;
+            } else {
+                prefetcher->useful++;
+                cache->hits++;
+            }
+            pendingRemove(prefetcher, entry);
+            trigger = true;
+        }
+    } else {
+        filter = &prefetcher->pollution[prefetchHash(block)
+                & (PREFETCH_POLLUTION_SIZE - 1)];
+        if (*filter == block + 1) {
+            prefetcher->pollutionMisses++;
+            *filter = 0;
+        }
+        if (prefetcher->kind == PREFETCH_STREAM
+                && prefetchStream(prefetcher, block) == CACHE_HIT)
+            cache->hits++;
+        else
+            cache->misses++;
+        if (cacheInsert(cache, address, false, &victim, &victimDirty)) {
+            cache->evictions++;
+            prefetchEvicted(prefetcher, victim, false);
+        }
+        trigger = true;
+    }
+
+    switch (prefetcher->kind) {
+        case PREFETCH_NEXTLINE:
+            // Tagged: a miss or the first use of a prefetched line triggers.
+            if (trigger)
+                for (i = 0; i < prefetcher->degree; i++)
+                    prefetchFill(prefetcher,
+                            block + prefetcher->distance + i);
+            break;
+        case PREFETCH_STRIDE:
+            prefetchStride(prefetcher, address, block);
+            break;
+        case PREFETCH_STREAM:
+            break;
+    }
+}
+
+/**
+ * Simulates a batch of trace records with prefetching.
+ */
+void prefetchSimulateBatch(prefetcher_t *prefetcher, const trace_t *batch,
+        size_t count) {
+    size_t i;
+
+    for (i = 0; i < count; i++) {
+        switch (batch[i].operation) {
+            case 'I':
+                prefetcher->pc = batch[i].address;
+                break;
+            case 'L':
+            case 'S':
+                prefetchAccess(prefetcher, batch[i].address);
+                break;
+            case 'M':
+                prefetchAccess(prefetcher, batch[i].address);
+                cacheTouch(prefetcher->cache, batch[i].address);
+                prefetcher->cache->hits++;
+                break;
+        }
+    }
+}
+
+/**
+ * Prints prefetch counters, accuracy and coverage. Accuracy is the share of
+ * issued prefetches that were used, late or not; coverage is the share of
+ * would-be misses that a timely prefetch removed.
+ */
+void prefetchPrint(prefetcher_t *prefetcher, FILE *stream) {
+    uint64_t used = prefetcher->useful + prefetcher->late;
+    uint64_t missed = prefetcher->useful + prefetcher->cache->misses;
+
+    fprintf(stream, "prefetch issued:%" PRIu64 " useful:%" PRIu64
+            " late:%" PRIu64 " useless:%" PRIu64
+            " pollution-evictions:%" PRIu64 " pollution-misses:%" PRIu64
+            " accuracy:%.2f%% coverage:%.2f%%\n",
+            prefetcher->issued, prefetcher->useful, prefetcher->late,
+            prefetcher->useless, prefetcher->pollutionEvictions,
+            prefetcher->pollutionMisses,
+            prefetcher->issued ? 100.0 * used / prefetcher->issued : 0.0,
+            missed ? 100.0 * prefetcher->useful / missed : 0.0);
+}
+
+/**
+ * Frees memory allocated by prefetchCreate().
+ */
+void prefetchFree(prefetcher_t *prefetcher) {
+    free(prefetcher->pending);
+    prefetcher->pending = NULL;
+}
@@ -0,0 +1,156 @@
+/*
+ * File:   prefetch.h
+ * Author: Nathan Hernandez,
+ *         Alyssa Tyler
+ *
+ * LoginID: hernandeznp,
+ *          tylerae
+ *
+ * Hardware prefetcher models on top of a single cache: tagged next-line,
+ * stride (per instruction, or per 4K page when the trace has no instruction
+ * records) and stream buffers.
+ * <p>
+ * Time is counted in data accesses. A prefetch issued at time t is ready at
+ * t + latency; a demand access that finds it earlier is a late prefetch and
+ * still counts as a miss. A prefetched block that is evicted before use is
+ * useless, and demand misses on blocks that a prefetch fill evicted are
+ * pollution misses.
+ */
+
+#ifndef PREFETCH_H
+#define PREFETCH_H
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include "cache.h"
+#include "trace.h"
+
+/**
+ * Number of stride table entries (a power of two).
+ */
+#define PREFETCH_STRIDE_ENTRIES 256
+
+/**
+ * Largest number of stream buffers.
+ */
+#define PREFETCH_MAX_STREAMS 16
+
+/**
+ * Largest degree, which is also the depth of a stream buffer.
+ */
+#define PREFETCH_MAX_DEGREE 16
+
+/**
+ * Number of entries of the filter remembering blocks evicted by prefetch
+ * fills (a power of two).
+ */
+#define PREFETCH_POLLUTION_SIZE 4096
+
+/**
+ * Prefetcher kinds.
+ */
+typedef enum prefetchKind_t {
+    PREFETCH_NEXTLINE,
+    PREFETCH_STRIDE,
+    PREFETCH_STREAM
+} prefetchKind_t;
+
+/**
+ * Stride table entry, keyed by instruction address or page.
+ */
+typedef struct strideEntry_t {
+    uint64_t key;
+    uint64_t last;
+    int64_t stride;
+    uint8_t confidence;
+} strideEntry_t;
+
+/**
+ * Stream buffer definition: a FIFO of upcoming blocks and when each
+ * becomes ready.
+ */
+typedef struct streamBuffer_t {
+    uint64_t blocks[PREFETCH_MAX_DEGREE];
+    uint64_t ready[PREFETCH_MAX_DEGREE];
+    uint8_t head;
+    uint8_t count;
+    uint64_t next;
+    uint64_t used;
+} streamBuffer_t;
+
+/**
+ * Block to ready time map of prefetched blocks not yet used.
+ */
+typedef struct pendingEntry_t {
+    uint64_t block;
+    uint64_t ready;
+    bool used;
+} pendingEntry_t;
+
+/**
+ * Prefetcher definition
+ */
+typedef struct prefetcher_t {
+    prefetchKind_t kind;
+    unsigned degree;
+    unsigned distance;
+    unsigned latency;
+    unsigned streams;
+    Cache * cache;
+    uint64_t now;
+    uint64_t pc;
+    strideEntry_t strides[PREFETCH_STRIDE_ENTRIES];
+    streamBuffer_t buffers[PREFETCH_MAX_STREAMS];
+    pendingEntry_t * pending;
+    size_t pendingSize;
+    uint64_t pollution[PREFETCH_POLLUTION_SIZE];
+    uint64_t issued;
+    uint64_t useful;
+    uint64_t late;
+    uint64_t useless;
+    uint64_t pollutionEvictions;
+    uint64_t pollutionMisses;
+} prefetcher_t;
+
+/**
+ * Creates a prefetcher from a specification such as "nextline",
+ * "stride,degree=2,distance=4" or "stream,streams=8,latency=50".
+ * <p>
+ * Be sure to call prefetchFree() to free memory and avoid memory leaks.
+ *
+ * @param prefetcher the prefetcher to initialize
+ * @param spec the specification
+ * @param cache the cache to prefetch into
+ * @return true on success
+ */
+bool prefetchCreate(prefetcher_t *prefetcher, const char *spec, Cache *cache);
+
+/**
+ * Simulates a batch of trace records with prefetching. Instruction records
+ * only update the current instruction address.
+ *
+ * @param prefetcher the prefetcher to simulate
+ * @param batch the records to simulate
+ * @param count number of records in batch
+ */
+void prefetchSimulateBatch(prefetcher_t *prefetcher, const trace_t *batch,
+        size_t count);
+
+/**
+ * Prints prefetch counters, accuracy and coverage.
+ *
+ * @param prefetcher the prefetcher to report on
+ * @param stream the stream to print to
+ */
+void prefetchPrint(prefetcher_t *prefetcher, FILE *stream);
+
+/**
+ * Frees memory allocated by prefetchCreate().
+ *
+ * @param prefetcher the prefetcher to free
+ */
+void prefetchFree(prefetcher_t *prefetcher);
+
+#endif  /* PREFETCH_H */
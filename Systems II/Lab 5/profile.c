@@ -0,0 +1,367 @@
+/*
+ * File:   profile.c
+ * Author: Nathan Hernandez,
+ *         Alyssa Tyler
+ *
+ * LoginID: hernandeznp,
+ *          tylerae
+ *
+ * Per-set and per-region counters. See profile.h.
+ */
+
+/**
+ * Includes
+ */
+#include "profile.h"
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * Defines
+ */
+#define LINE_SIZE 512
+
+/**
+ * Fewest hex digits nm prints for an address or size; it zero-pads them to
+ * 8 or 16.
+ */
+#define NM_MIN_DIGITS 8
+
+/**
+ * Symbol type letters nm prints.
+ */
+#define NM_TYPES "AaBbCcDdGgIiNnpRrSsTtUuVvWw-?"
+
+/**
+ * Orders regions by start address.
+ */
+static int regionCompare(const void *a, const void *b) {
+    const region_t *left = a, *right = b;
+
+    return (left->start > right->start) - (left->start < right->start);
+}
+
+/**
+ * Checks whether a field is an nm symbol type letter.
+ */
+static bool profileIsType(const char *field) {
+    return field[0] != '\0' && field[1] == '\0'
+            && strchr(NM_TYPES, field[0]) != NULL;
+}
+
+/**
+ * Checks whether a field is a zero-padded nm address or size.
+ */
+static bool profileIsWide(const char *field) {
+    return strlen(field) >= NM_MIN_DIGITS;
+}
+
+/**
+ * Parses one line of the region map file into region.
+ * <p>
+ * Lines nm -S prints for symbols without a size ("address type name", with
+ * a zero-padded address) or without an address ("type name", undefined and
+ * weak symbols) are skipped, as are its zero-size symbols. Every other line
+ * must be a range or a full nm -S line.
+ *
+ * @return 1 if a region was read, 0 for a blank or skipped line, -1 if
+ * invalid
+ */
+static int profileParseRegion(char *line, region_t *region) {
+    char *fields[4];
+    char *end;
+    unsigned count = 0;
+    uint64_t first, second;
+
+    fields[0] = strtok(line, " \t\r\n");
+    while (count < 4 && fields[count] != NULL)
+        if (++count < 4)
+            fields[count] = strtok(NULL, " \t\r\n");
+    if (count == 0 || (count == 2 && profileIsType(fields[0]))
+            || (count == 3 && profileIsType(fields[1])
+                    && profileIsWide(fields[0])))
+        return 0;
+    if (count < 3 || (count == 4 && (!profileIsType(fields[2])
+            || !profileIsWide(fields[0]) || !profileIsWide(fields[1]))))
+        return -1;
+
+    first = strtoull(fields[0], &end, 16);
+    if (*end != '\0')
+        return -1;
+    second = strtoull(fields[1], &end, 16);
+    if (*end != '\0')
+        return -1;
+
+    memset(region, 0, sizeof(region_t));
+    region->start = first;
+    if (count == 4) {
+        if (second == 0)
+            return 0;
+        region->end = first + second;	/* nm -S: address size type name */
+        strncpy(region->name, fields[3], PROFILE_NAME_SIZE - 1);
+    } else {
+        region->end = second;
+        strncpy(region->name, fields[2], PROFILE_NAME_SIZE - 1);
+    }
+    return region->end > region->start ? 1 : -1;
+}
+
+/**
+ * Reads the region map file, sorts it and appends "[other]".
+ *
+ * @return true on success
+ */
+static bool profileReadRegions(profile_t *profile, const char *path) {
+    char line[LINE_SIZE];
+    char *comment;
+    size_t capacity = 0;
+    unsigned number = 0;
+    region_t region, *grown;
+    int parsed;
+    FILE *map = NULL;
+
+    if (path != NULL && (map = fopen(path, "r")) == NULL) {
+        perror("Error opening region map");
+        return false;
+    }
+    while (map != NULL && fgets(line, LINE_SIZE, map) != NULL) {
+        number++;
+        if ((comment = strchr(line, '#')) != NULL)
+            *comment = '\0';
+        parsed = profileParseRegion(line, &region);
+        if (parsed < 0) {
+            fprintf(stderr, "%s: line %u: expected \"start end name\" or "
+                    "\"address size type name\"\n", path, number);
+            fclose(map);
+            return false;
+        }
+        if (parsed == 0)
+            continue;
+        if (profile->regionCount + 1 >= capacity) {
+            capacity = capacity ? capacity * 2 : 64;
+            grown = realloc(profile->regions, capacity * sizeof(region_t));
+            if (grown == NULL) {
+                fclose(map);
+                return false;
+            }
+            profile->regions = grown;
+        }
+        profile->regions[profile->regionCount++] = region;
+    }
+    if (map != NULL)
+        fclose(map);
+
+    if (profile->regionCount + 1 > capacity) {
+        grown = realloc(profile->regions, (capacity + 1) * sizeof(region_t));
+        if (grown == NULL)
+            return false;
+        profile->regions = grown;
+    }
+    qsort(profile->regions, profile->regionCount, sizeof(region_t),
+            regionCompare);
+    memset(&profile->regions[profile->regionCount], 0, sizeof(region_t));
+    strcpy(profile->regions[profile->regionCount].name, "[other]");
+    profile->last = &profile->regions[profile->regionCount];
+    return true;
+}
+
+/**
+ * Allocates the counters of a profile for a cache.
+ */
+bool profileCreate(profile_t *profile, Cache *cache, const char *path) {
+    memset(profile, 0, sizeof(profile_t));
+    profile->cache = cache;
+    profile->sets = calloc(cache->setSize, sizeof(profileCounters_t));
+    if (profile->sets == NULL)
+        return false;
+    return profileReadRegions(profile, path);
+}
+
+/**
+ * Finds the region holding address: the previous region if it still
+ * matches, otherwise the last region starting at or below address.
+ */
+static region_t * profileRegion(profile_t *profile, uint64_t address) {
+    region_t *other = &profile->regions[profile->regionCount];
+    size_t low = 0, high = profile->regionCount, middle;
+
+    if (profile->last != other && address >= profile->last->start
+            && address < profile->last->end)
+        return profile->last;
+
+    while (low < high) {
+        middle = (low + high) / 2;
+        if (profile->regions[middle].start <= address)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+    if (low > 0 && address < profile->regions[low - 1].end)
+        profile->last = &profile->regions[low - 1];
+    else
+        profile->last = other;
+    return profile->last;
+}
+
+/**
+ * Performs one access and adds its outcome to its set and region.
+ */
+static void profileAccess(profile_t *profile, uint64_t address,
+        region_t *region) {
+    Cache *cache = profile->cache;
+    profileCounters_t *set = &profile->sets[cacheSetOf(cache, address)];
+    cacheResult_t result = cacheAccess(cache, address);
+    uint64_t missed = result != CACHE_HIT;
+    uint64_t evicted = result == CACHE_MISS_EVICTION;
+
+    set->accesses++;
+    set->misses += missed;
+    set->evictions += evicted;
+    region->counters.accesses++;
+    region->counters.misses += missed;
+    region->counters.evictions += evicted;
+}
+
+/**
+ * Simulates a batch of trace records, counting every data access.
+ */
+void profileSimulateBatch(profile_t *profile, const trace_t *batch,
+        size_t count) {
+    region_t *region;
+    size_t i;
+
+    for (i = 0; i < count; i++) {
+        if (batch[i].operation == 'I')
+            continue;
+        region = profileRegion(profile, batch[i].address);
+        profileAccess(profile, batch[i].address, region);
+        if (batch[i].operation == 'M')
+            profileAccess(profile, batch[i].address, region);
+    }
+}
+
+/**
+ * Writes the counters as CSV rows of kind,name,start,end,accesses,misses,
+ * evictions.
+ */
+static void profileWriteCsv(profile_t *profile, FILE *out) {
+    profileCounters_t *counters;
+    region_t *region;
+    size_t i;
+
+    fprintf(out, "kind,name,start,end,accesses,misses,evictions\n");
+    for (i = 0; i < profile->cache->setSize; i++) {
+        counters = &profile->sets[i];
+        fprintf(out, "set,%zu,,,%" PRIu64 ",%" PRIu64 ",%" PRIu64 "\n", i,
+                counters->accesses, counters->misses, counters->evictions);
+    }
+    for (i = 0; i <= profile->regionCount; i++) {
+        region = &profile->regions[i];
+        fprintf(out, "region,%s,", region->name);
+        if (i < profile->regionCount)
+            fprintf(out, "0x%" PRIx64 ",0x%" PRIx64, region->start,
+                    region->end);
+        else
+            fprintf(out, ",");
+        fprintf(out, ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 "\n",
+                region->counters.accesses, region->counters.misses,
+                region->counters.evictions);
+    }
+}
+
+/**
+ * Writes the counters as a JSON object with "sets" and "regions" arrays.
+ */
+static void profileWriteJson(profile_t *profile, FILE *out) {
+    profileCounters_t *counters;
+    region_t *region;
+    const char *c;
+    size_t i;
+
+    fprintf(out, "{\n  \"sets\": [\n");
+    for (i = 0; i < profile->cache->setSize; i++) {
+        counters = &profile->sets[i];
+        fprintf(out, "    {\"set\": %zu, \"accesses\": %" PRIu64
+                ", \"misses\": %" PRIu64 ", \"evictions\": %" PRIu64 "}%s\n",
+                i, counters->accesses, counters->misses, counters->evictions,
+                i + 1 < profile->cache->setSize ? "," : "");
+    }
+    fprintf(out, "  ],\n  \"regions\": [\n");
+    for (i = 0; i <= profile->regionCount; i++) {
+        region = &profile->regions[i];
+        fprintf(out, "    {\"name\": \"");
+        for (c = region->name; *c; c++) {
+            if (*c == '"' || *c == '\\')
+                fputc('\\', out);
+            fputc(*c, out);
+        }
+        fprintf(out, "\"");
+        if (i < profile->regionCount)
+            fprintf(out, ", \"start\": %" PRIu64 ", \"end\": %" PRIu64,
+                    region->start, region->end);
+        fprintf(out, ", \"accesses\": %" PRIu64 ", \"misses\": %" PRIu64
+                ", \"evictions\": %" PRIu64 "}%s\n",
+                region->counters.accesses, region->counters.misses,
+                region->counters.evictions,
+                i < profile->regionCount ? "," : "");
+    }
+    fprintf(out, "  ]\n}\n");
+}
+
+/**
+ * Writes the counters to path as CSV or JSON.
+ */
+bool profileWrite(profile_t *profile, const char *path) {
+    size_t length = strlen(path);
+    FILE *out = fopen(path, "w");
+
+    if (out == NULL) {
+        perror("Error creating profile");
+        return false;
+    }
+    if (length >= 5 && strcmp(path + length - 5, ".json") == 0)
+        profileWriteJson(profile, out);
+    else
+        profileWriteCsv(profile, out);
+    return fclose(out) == 0;
+}
+
+/**
+ * Prints the sets with the most misses and their share of all misses.
+ */
+void profilePrint(profile_t *profile, FILE *stream) {
+    size_t top[PROFILE_TOP_SETS];
+    size_t found = 0, i, j;
+    uint64_t misses = 0;
+
+    for (i = 0; i < profile->cache->setSize; i++) {
+        misses += profile->sets[i].misses;
+        if (profile->sets[i].misses == 0)
+            continue;
+        if (found == PROFILE_TOP_SETS && profile->sets[i].misses
+                <= profile->sets[top[found - 1]].misses)
+            continue;
+        if (found < PROFILE_TOP_SETS)
+            found++;
+        for (j = found - 1; j > 0
+                && profile->sets[top[j - 1]].misses < profile->sets[i].misses;
+                j--)
+            top[j] = top[j - 1];
+        top[j] = i;
+    }
+    for (i = 0; i < found; i++)
+        fprintf(stream, "hot set %zu misses:%" PRIu64 " (%.2f%%) evictions:%"
+                PRIu64 "\n", top[i], profile->sets[top[i]].misses,
+                100.0 * profile->sets[top[i]].misses / misses,
+                profile->sets[top[i]].evictions);
+}
+
+/**
+ * Frees memory allocated by profileCreate().
+ */
+void profileFree(profile_t *profile) {
+    free(profile->sets);
+    free(profile->regions);
+    profile->sets = NULL;
+    profile->regions = NULL;
+}
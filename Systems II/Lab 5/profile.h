@@ -0,0 +1,128 @@
+/*
+ * File:   profile.h
+ * Author: Nathan Hernandez,
+ *         Alyssa Tyler
+ *
+ * LoginID: hernandeznp,
+ *          tylerae
+ *
+ * Per-set and per-address-region access, miss and eviction counters, to
+ * find set conflicts (e.g. from power-of-two strides) and the data
+ * structures they come from.
+ * <p>
+ * Regions come from a map file with one region per line, either a range
+ * <pre>
+ *   # start   end       name
+ *   601000    602000    matrixA
+ * </pre>
+ * or a symbol as printed by "nm -S" (address, size, type, name), so raw
+ * nm -S output can be used; its symbols without an address or size are
+ * skipped. Addresses and sizes are hexadecimal. Accesses outside every
+ * region count towards "[other]".
+ * <p>
+ * Counters are written as CSV, one row per set and per region, or as JSON
+ * when the output file name ends in ".json".
+ */
+
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include "cache.h"
+#include "trace.h"
+
+/**
+ * Longest region name kept.
+ */
+#define PROFILE_NAME_SIZE 64
+
+/**
+ * Number of sets with the most misses printed.
+ */
+#define PROFILE_TOP_SETS 5
+
+/**
+ * Access, miss and eviction counters.
+ */
+typedef struct profileCounters_t {
+    uint64_t accesses;
+    uint64_t misses;
+    uint64_t evictions;
+} profileCounters_t;
+
+/**
+ * Region definition
+ */
+typedef struct region_t {
+    uint64_t start;
+    uint64_t end;
+    char name[PROFILE_NAME_SIZE];
+    profileCounters_t counters;
+} region_t;
+
+/**
+ * Profile definition
+ * <p>
+ * regions is sorted by start and ends with the "[other]" region; last is
+ * the region of the previous access, tried first.
+ */
+typedef struct profile_t {
+    Cache * cache;
+    profileCounters_t * sets;
+    region_t * regions;
+    size_t regionCount;
+    region_t * last;
+} profile_t;
+
+/**
+ * Allocates the counters of a profile for a cache, reading regions from
+ * path if it is not NULL.
+ * <p>
+ * Be sure to call profileFree() to free memory and avoid memory leaks.
+ *
+ * @param profile the profile to initialize
+ * @param cache the cache to profile
+ * @param path path of the region map file, or NULL
+ * @return true on success
+ */
+bool profileCreate(profile_t *profile, Cache *cache, const char *path);
+
+/**
+ * Simulates a batch of trace records, counting every data access against
+ * its set and region. A modify counts as two accesses.
+ *
+ * @param profile the profile to simulate
+ * @param batch the records to simulate
+ * @param count number of records in batch
+ */
+void profileSimulateBatch(profile_t *profile, const trace_t *batch,
+        size_t count);
+
+/**
+ * Writes the counters to path as CSV, or JSON if path ends in ".json".
+ *
+ * @param profile the profile to write
+ * @param path the file to create
+ * @return true on success
+ */
+bool profileWrite(profile_t *profile, const char *path);
+
+/**
+ * Prints the sets with the most misses and their share of all misses.
+ *
+ * @param profile the profile to report on
+ * @param stream the stream to print to
+ */
+void profilePrint(profile_t *profile, FILE *stream);
+
+/**
+ * Frees memory allocated by profileCreate().
+ *
+ * @param profile the profile to free
+ */
+void profileFree(profile_t *profile);
+
+#endif  /* PROFILE_H */
@@ -0,0 +1,259 @@
+/*
+ * File:   reuse.c
+ * Author: Nathan Hernandez,
+ *         Alyssa Tyler
+ *
+ * LoginID: hernandeznp,
+ *          tylerae
+ *
+ * Exact reuse distance histogram. See reuse.h.
+ */
+
+/**
+ * Includes
+ */
+#include "reuse.h"
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * Smallest number of times the tree covers.
+ */
+#define REUSE_INITIAL_CAPACITY (1u << 16)
+
+/**
+ * Initial number of table slots (a power of two).
+ */
+#define REUSE_INITIAL_TABLE 4096
+
+/**
+ * Returns the home slot of a block in the table.
+ */
+static size_t reuseHome(reuse_t *reuse, uint64_t block) {
+    uint64_t hash = block * 0x9e3779b97f4a7c15ull;
+
+    return (hash ^ hash >> 32) & (reuse->tableSize - 1);
+}
+
+/**
+ * Doubles the table and rehashes every entry.
+ *
+ * @return true on success
+ */
+static bool reuseGrow(reuse_t *reuse) {
+    reuseEntry_t *old = reuse->table;
+    size_t oldSize = reuse->tableSize;
+    size_t i, slot;
+
+    reuse->table = calloc(oldSize * 2, sizeof(reuseEntry_t));
+    if (reuse->table == NULL) {
+        reuse->table = old;
+        return false;
+    }
+    reuse->tableSize = oldSize * 2;
+    for (i = 0; i < oldSize; i++) {
+        if (!old[i].used)
+            continue;
+        slot = reuseHome(reuse, old[i].block);
+        while (reuse->table[slot].used)
+            slot = (slot + 1) & (reuse->tableSize - 1);
+        reuse->table[slot] = old[i];
+    }
+    free(old);
+    return true;
+}
+
+/**
+ * Finds the entry of a block, creating an unused one for a new block.
+ * <p>
+ * Creating an entry may move every other entry.
+ */
+static reuseEntry_t * reuseFind(reuse_t *reuse, uint64_t block) {
+    size_t slot;
+
+    if ((reuse->tableUsed + 1) * 2 > reuse->tableSize && !reuseGrow(reuse)) {
+        fprintf(stderr, "Out of memory growing the reuse table\n");
+        exit(EXIT_FAILURE);
+    }
+
+    slot = reuseHome(reuse, block);
+    while (reuse->table[slot].used && reuse->table[slot].block != block)
+        slot = (slot + 1) & (reuse->tableSize - 1);
+    reuse->table[slot].block = block;
+    return &reuse->table[slot];
+}
+
+/**
+ * Adds delta at time in the Fenwick tree.
+ */
+static void reuseUpdate(reuse_t *reuse, size_t time, int32_t delta) {
+    for (time++; time <= reuse->capacity; time += time & -time)
+        reuse->tree[time - 1] += delta;
+}
+
+/**
+ * Counts the live times before time.
+ */
+static uint64_t reusePrefix(reuse_t *reuse, size_t time) {
+    uint64_t sum = 0;
+
+    for (; time > 0; time -= time & -time)
+        sum += reuse->tree[time - 1];
+    return sum;
+}
+
+/**
+ * (Re)allocates the tree and owners for capacity times, with the first
+ * live times in use, and builds the tree in linear time.
+ *
+ * @return true on success
+ */
+static bool reuseResize(reuse_t *reuse, size_t capacity, size_t live) {
+    uint32_t *tree = realloc(reuse->tree, capacity * sizeof(uint32_t));
+    uint64_t *owners;
+    size_t i, parent;
+
+    if (tree == NULL)
+        return false;
+    reuse->tree = tree;
+    owners = realloc(reuse->owners, capacity * sizeof(uint64_t));
+    if (owners == NULL)
+        return false;
+    reuse->owners = owners;
+    reuse->capacity = capacity;
+
+    for (i = 0; i < capacity; i++)
+        tree[i] = i < live;
+    for (i = 1; i <= capacity; i++) {
+        parent = i + (i & -i);
+        if (parent <= capacity)
+            tree[parent - 1] += tree[i - 1];
+    }
+    return true;
+}
+
+/**
+ * Renumbers the live times 0..blocks-1 in order and rebuilds the tree with
+ * room for at least as many accesses again.
+ */
+static void reuseCompact(reuse_t *reuse) {
+    size_t live = 0, time;
+    size_t capacity = reuse->tableUsed * 4;
+
+    for (time = 0; time < reuse->now; time++) {
+        if (reuse->owners[time] == REUSE_DEAD)
+            continue;
+        reuseFind(reuse, reuse->owners[time])->time = live;
+        reuse->owners[live++] = reuse->owners[time];
+    }
+    if (capacity < REUSE_INITIAL_CAPACITY)
+        capacity = REUSE_INITIAL_CAPACITY;
+    if (!reuseResize(reuse, capacity, live)) {
+        fprintf(stderr, "Out of memory growing the reuse tree\n");
+        exit(EXIT_FAILURE);
+    }
+    reuse->now = live;
+}
+
+/**
+ * Creates an empty reuse distance profile.
+ */
+bool reuseCreate(reuse_t *reuse, uint8_t blockBits) {
+    memset(reuse, 0, sizeof(reuse_t));
+    reuse->blockBits = blockBits;
+    reuse->tableSize = REUSE_INITIAL_TABLE;
+    reuse->table = calloc(reuse->tableSize, sizeof(reuseEntry_t));
+    if (reuse->table == NULL)
+        return false;
+    return reuseResize(reuse, REUSE_INITIAL_CAPACITY, 0);
+}
+
+/**
+ * Adds one access of a block, binning its distance.
+ */
+static void reuseAccess(reuse_t *reuse, uint64_t block) {
+    reuseEntry_t *entry;
+    uint64_t distance;
+
+    if (reuse->now == reuse->capacity)
+        reuseCompact(reuse);
+
+    reuse->accesses++;
+    entry = reuseFind(reuse, block);
+    if (!entry->used) {
+        entry->used = true;
+        reuse->tableUsed++;
+        reuse->cold++;
+    } else {
+        distance = reusePrefix(reuse, reuse->now)
+                - reusePrefix(reuse, entry->time + 1);
+        reuse->bins[distance ? 64 - __builtin_clzll(distance) : 0]++;
+        reuseUpdate(reuse, entry->time, -1);
+        reuse->owners[entry->time] = REUSE_DEAD;
+    }
+    entry->time = reuse->now;
+    reuse->owners[reuse->now] = block;
+    reuseUpdate(reuse, reuse->now++, 1);
+}
+
+/**
+ * Adds the data accesses of a batch of trace records to the profile.
+ */
+void reuseBatch(reuse_t *reuse, const trace_t *batch, size_t count) {
+    size_t i;
+
+    for (i = 0; i < count; i++) {
+        if (batch[i].operation == 'I')
+            continue;
+        reuseAccess(reuse, batch[i].address >> reuse->blockBits);
+        if (batch[i].operation == 'M')
+            reuseAccess(reuse, batch[i].address >> reuse->blockBits);
+    }
+}
+
+/**
+ * Prints the histogram and the fully-associative LRU miss rates it
+ * predicts. With C = 2^k lines, every access in a bin at or above the one
+ * starting at C misses, as do cold accesses.
+ */
+void reusePrint(reuse_t *reuse, FILE *stream) {
+    uint64_t total = reuse->accesses ? reuse->accesses : 1;
+    uint64_t misses = reuse->accesses;
+    unsigned last = 0, bin;
+
+    for (bin = 0; bin < REUSE_BINS; bin++)
+        if (reuse->bins[bin])
+            last = bin;
+
+    fprintf(stream, "accesses:%" PRIu64 " blocks:%zu cold:%" PRIu64 "\n",
+            reuse->accesses, reuse->tableUsed, reuse->cold);
+    for (bin = 0; bin <= last; bin++) {
+        if (bin <= 1)
+            fprintf(stream, "distance %u", bin);
+        else
+            fprintf(stream, "distance %" PRIu64 "-%" PRIu64,
+                    (uint64_t) 1 << (bin - 1),
+                    ((uint64_t) 2 << (bin - 1)) - 1);
+        fprintf(stream, " count:%" PRIu64 " (%.2f%%)\n", reuse->bins[bin],
+                100.0 * reuse->bins[bin] / total);
+    }
+    for (bin = 0; bin <= last; bin++) {
+        misses -= reuse->bins[bin];
+        fprintf(stream, "lines %" PRIu64 " (%" PRIu64 " bytes) miss rate:"
+                "%.2f%%\n", (uint64_t) 1 << bin,
+                ((uint64_t) 1 << bin) << reuse->blockBits,
+                100.0 * misses / total);
+    }
+}
+
+/**
+ * Frees memory allocated by reuseCreate().
+ */
+void reuseFree(reuse_t *reuse) {
+    free(reuse->tree);
+    free(reuse->owners);
+    free(reuse->table);
+    reuse->tree = NULL;
+    reuse->owners = NULL;
+    reuse->table = NULL;
+}
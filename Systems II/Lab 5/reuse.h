@@ -0,0 +1,106 @@
+/*
+ * File:   reuse.h
+ * Author: Nathan Hernandez,
+ *         Alyssa Tyler
+ *
+ * LoginID: hernandeznp,
+ *          tylerae
+ *
+ * Exact reuse (LRU stack) distance histogram of block addresses. The
+ * distance of an access is the number of distinct other blocks touched
+ * since the previous access to its block, so it hits in a fully-associative
+ * LRU cache of C lines exactly when its distance is below C.
+ * <p>
+ * Each block keeps the time of its last access, and a Fenwick tree over
+ * time marks those times, so a distance is a range count in O(log n). When
+ * time runs past the tree, live times are renumbered densely and the tree
+ * is rebuilt, which keeps memory proportional to the number of distinct
+ * blocks instead of the length of the trace.
+ */
+
+#ifndef REUSE_H
+#define REUSE_H
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include "trace.h"
+
+/**
+ * Number of histogram bins: distance 0, then one bin per power of two.
+ */
+#define REUSE_BINS 65
+
+/**
+ * Owner of a time whose block has been accessed again since.
+ */
+#define REUSE_DEAD UINT64_MAX
+
+/**
+ * Block to last access time entry.
+ */
+typedef struct reuseEntry_t {
+    uint64_t block;
+    uint64_t time;
+    bool used;
+} reuseEntry_t;
+
+/**
+ * Reuse distance profile definition
+ * <p>
+ * owners[t] is the block last accessed at time t, or REUSE_DEAD if that
+ * block has been accessed again since.
+ */
+typedef struct reuse_t {
+    uint8_t blockBits;
+    uint32_t * tree;
+    uint64_t * owners;
+    size_t capacity;
+    size_t now;
+    reuseEntry_t * table;
+    size_t tableSize;
+    size_t tableUsed;
+    uint64_t bins[REUSE_BINS];
+    uint64_t cold;
+    uint64_t accesses;
+} reuse_t;
+
+/**
+ * Creates an empty reuse distance profile.
+ * <p>
+ * Be sure to call reuseFree() to free memory and avoid memory leaks.
+ *
+ * @param reuse the profile to initialize
+ * @param blockBits number of block offset bits
+ * @return true on success
+ */
+bool reuseCreate(reuse_t *reuse, uint8_t blockBits);
+
+/**
+ * Adds the data accesses of a batch of trace records to the profile. A
+ * modify is two accesses, the second at distance 0.
+ *
+ * @param reuse the profile to add to
+ * @param batch the records to add
+ * @param count number of records in batch
+ */
+void reuseBatch(reuse_t *reuse, const trace_t *batch, size_t count);
+
+/**
+ * Prints the log-binned histogram and the miss rate it predicts for a
+ * fully-associative LRU cache of every power of two lines.
+ *
+ * @param reuse the profile to report on
+ * @param stream the stream to print to
+ */
+void reusePrint(reuse_t *reuse, FILE *stream);
+
+/**
+ * Frees memory allocated by reuseCreate().
+ *
+ * @param reuse the profile to free
+ */
+void reuseFree(reuse_t *reuse);
+
+#endif  /* REUSE_H */
@@ -0,0 +1,274 @@
+/*
+ * File:   sample.c
+ * Author: Nathan Hernandez,
+ *         Alyssa Tyler
+ *
+ * LoginID: hernandeznp,
+ *          tylerae
+ *
+ * Sampled simulation. See sample.h.
+ */
+
+/**
+ * Includes
+ */
+#include "sample.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * Normal quantile of a two-sided 95% confidence interval.
+ */
+#define SAMPLE_Z95 1.96
+
+/**
+ * Metric names indexed by sampleMetric_t.
+ */
+static const char *metricNames[SAMPLE_METRICS] = {
+    [SAMPLE_HITS] = "hits",
+    [SAMPLE_MISSES] = "misses",
+    [SAMPLE_EVICTIONS] = "evictions"
+};
+
+/**
+ * Parses an unsigned option value of at least min.
+ *
+ * @return true if value is a number of at least min
+ */
+static bool sampleParseValue(const char *value, uint64_t min,
+        uint64_t *result) {
+    char *end;
+    unsigned long long number = strtoull(value, &end, 10);
+
+    if (*value == '\0' || *end != '\0' || number < min)
+        return false;
+    *result = number;
+    return true;
+}
+
+/**
+ * Creates a sampler from a specification.
+ */
+bool samplerCreate(sampler_t *sampler, const char *spec, Cache *cache) {
+    char buffer[256];
+    char *option, *value;
+    uint64_t setRatio = 1, set;
+    bool valid;
+
+    memset(sampler, 0, sizeof(sampler_t));
+    sampler->cache = cache;
+    sampler->config.setBits = cache->setBits;
+    sampler->config.blockBits = cache->blockBits;
+
+    if (strlen(spec) >= sizeof(buffer)) {
+        fprintf(stderr, "sampling specification too long\n");
+        return false;
+    }
+    strcpy(buffer, spec);
+
+    for (option = strtok(buffer, ","); option; option = strtok(NULL, ",")) {
+        value = strchr(option, '=');
+        if (value == NULL) {
+            fprintf(stderr, "sampling: expected key=value, got %s\n", option);
+            return false;
+        }
+        *value++ = '\0';
+        if (strcmp(option, "sets") == 0)
+            valid = sampleParseValue(value, 1, &setRatio)
+                    && setRatio <= UINT32_MAX;
+        else if (strcmp(option, "period") == 0)
+            valid = sampleParseValue(value, 1, &sampler->config.period);
+        else if (strcmp(option, "warmup") == 0)
+            valid = sampleParseValue(value, 0, &sampler->config.warmup);
+        else if (strcmp(option, "measure") == 0)
+            valid = sampleParseValue(value, 1, &sampler->config.measure);
+        else
+            valid = false;
+        if (!valid) {
+            fprintf(stderr, "sampling: bad option %s=%s\n", option, value);
+            return false;
+        }
+    }
+    sampler->config.setRatio = setRatio;
+
+    if (sampler->config.period && (sampler->config.measure == 0
+            || sampler->config.warmup + sampler->config.measure
+                > sampler->config.period)) {
+        fprintf(stderr, "sampling: period needs 0 < measure and "
+                "warmup + measure <= period\n");
+        return false;
+    }
+    if (!sampler->config.period
+            && (sampler->config.warmup || sampler->config.measure)) {
+        fprintf(stderr, "sampling: warmup and measure need a period\n");
+        return false;
+    }
+
+    for (set = 0; set < cache->setSize; set++)
+        sampler->sampledSets += traceSampleKeepsSet(&sampler->config, set);
+    if (sampler->sampledSets == 0) {
+        fprintf(stderr, "sampling: sets=%" PRIu64 " keeps none of the %"
+                PRIu64 " sets\n", setRatio, (uint64_t) cache->setSize);
+        return false;
+    }
+
+    sampler->sets = calloc(cache->setSize, sizeof(sampleCounters_t));
+    return sampler->sets != NULL;
+}
+
+/**
+ * Folds the current time unit into the unit sums.
+ */
+static void samplerEndUnit(sampler_t *sampler) {
+    double records = sampler->unit.records;
+    double count;
+    sampleMetric_t metric;
+
+    if (sampler->unit.records == 0)
+        return;
+    sampler->units++;
+    sampler->unitRecordSquares += records * records;
+    for (metric = 0; metric < SAMPLE_METRICS; metric++) {
+        count = sampler->unit.counts[metric];
+        sampler->unitSquares[metric] += count * count;
+        sampler->unitProducts[metric] += count * records;
+    }
+    memset(&sampler->unit, 0, sizeof(sampleCounters_t));
+}
+
+/**
+ * Adds the outcome of one measured access to its samples.
+ */
+static void samplerCount(sampler_t *sampler, sampleCounters_t *set,
+        cacheResult_t result) {
+    sampleMetric_t metric = result == CACHE_HIT ? SAMPLE_HITS : SAMPLE_MISSES;
+
+    set->counts[metric]++;
+    sampler->unit.counts[metric]++;
+    sampler->total.counts[metric]++;
+    if (result == CACHE_MISS_EVICTION) {
+        set->counts[SAMPLE_EVICTIONS]++;
+        sampler->unit.counts[SAMPLE_EVICTIONS]++;
+        sampler->total.counts[SAMPLE_EVICTIONS]++;
+    }
+}
+
+/**
+ * Simulates a batch of sampled records, counting only measured ones.
+ */
+void samplerSimulateBatch(sampler_t *sampler, const trace_t *batch,
+        size_t count) {
+    Cache *cache = sampler->cache;
+    sampleCounters_t *set;
+    cacheResult_t result;
+    size_t i;
+
+    for (i = 0; i < count; i++) {
+        if (batch[i].sample == TRACE_UNIT)
+            samplerEndUnit(sampler);
+        result = cacheAccess(cache, batch[i].address);
+        if (batch[i].sample == TRACE_WARM) {
+            if (batch[i].operation == 'M')
+                cacheAccess(cache, batch[i].address);
+            continue;
+        }
+
+        set = &sampler->sets[(batch[i].address >> cache->blockBits)
+                & (cache->setSize - 1)];
+        set->records++;
+        sampler->unit.records++;
+        sampler->total.records++;
+        samplerCount(sampler, set, result);
+        if (batch[i].operation == 'M')
+            samplerCount(sampler, set, cacheAccess(cache, batch[i].address));
+    }
+}
+
+/**
+ * Extrapolates a metric to the whole trace.
+ */
+double samplerEstimate(sampler_t *sampler, sampleMetric_t metric,
+        double *halfWidth) {
+    double sets = sampler->cache->setSize;
+    double kept = sampler->sampledSets;
+    double setScale = sets / kept;
+    double records = sampler->config.position;
+    double measured = sampler->total.records;
+    double sum = sampler->total.counts[metric];
+    double units, ratio, residuals, fraction, mean, squares = 0, value;
+    uint64_t set;
+
+    *halfWidth = 0;
+    if (sampler->config.period) {
+        samplerEndUnit(sampler);
+        if (measured == 0) {
+            *halfWidth = NAN;
+            return 0;
+        }
+        units = sampler->units;
+        ratio = sum / measured;
+        if (units < 2)
+            *halfWidth = NAN;
+        else {
+            residuals = sampler->unitSquares[metric]
+                    - 2 * ratio * sampler->unitProducts[metric]
+                    + ratio * ratio * sampler->unitRecordSquares;
+            fraction = measured / records;
+            *halfWidth = SAMPLE_Z95 * setScale * records / measured
+                    * sqrt(fmax(residuals, 0) / (units * (units - 1))
+                    * fmax(1 - fraction, 0)) * units;
+        }
+        return setScale * records * ratio;
+    }
+
+    if (kept < 2 && kept < sets) {
+        *halfWidth = NAN;
+    } else if (kept < sets) {
+        mean = sum / kept;
+        for (set = 0; set < sampler->cache->setSize; set++) {
+            if (!traceSampleKeepsSet(&sampler->config, set))
+                continue;
+            value = sampler->sets[set].counts[metric] - mean;
+            squares += value * value;
+        }
+        *halfWidth = SAMPLE_Z95 * sets * sqrt(squares / (kept - 1) / kept
+                * (1 - kept / sets));
+    }
+    return setScale * sum;
+}
+
+/**
+ * Prints how much was sampled and the extrapolated counters.
+ */
+void samplerPrint(sampler_t *sampler, FILE *stream) {
+    sampleMetric_t metric;
+    double estimate, halfWidth;
+
+    fprintf(stream, "sampled sets:%" PRIu64 "/%" PRIu64, sampler->sampledSets,
+            (uint64_t) sampler->cache->setSize);
+    if (sampler->config.period)
+        fprintf(stream, " units:%" PRIu64 " measured records:%" PRIu64
+                "/%" PRIu64, sampler->units + (sampler->unit.records > 0),
+                sampler->total.records, sampler->config.position);
+    fprintf(stream, "\n");
+    for (metric = 0; metric < SAMPLE_METRICS; metric++) {
+        estimate = samplerEstimate(sampler, metric, &halfWidth);
+        if (isnan(halfWidth))
+            fprintf(stream, "%s%s:%.0f +/- n/a", metric ? " " : "",
+                    metricNames[metric], estimate);
+        else
+            fprintf(stream, "%s%s:%.0f +/- %.0f", metric ? " " : "",
+                    metricNames[metric], estimate, halfWidth);
+    }
+    fprintf(stream, isnan(halfWidth) ? " (too few samples for an interval)\n"
+            : " (95%% confidence)\n");
+}
+
+/**
+ * Frees memory allocated by samplerCreate().
+ */
+void samplerFree(sampler_t *sampler) {
+    free(sampler->sets);
+    sampler->sets = NULL;
+}
@@ -0,0 +1,117 @@
+/*
+ * File:   sample.h
+ * Author: Nathan Hernandez,
+ *         Alyssa Tyler
+ *
+ * LoginID: hernandeznp,
+ *          tylerae
+ *
+ * Sampled simulation of huge traces. The trace reader drops what sampling
+ * does not keep (see traceSample_t); the sampler simulates the rest and
+ * extrapolates hits, misses and evictions to the whole trace with 95%
+ * confidence intervals.
+ * <p>
+ * With time sampling every measured unit is one sample and totals use the
+ * ratio estimator (count per measured record times records in the trace).
+ * With set sampling alone every kept set is one sample. With both, the
+ * time estimate for the kept sets is scaled up to every set.
+ */
+
+#ifndef SAMPLE_H
+#define SAMPLE_H
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include "cache.h"
+#include "trace.h"
+
+/**
+ * Metrics extrapolated by the sampler.
+ */
+typedef enum sampleMetric_t {
+    SAMPLE_HITS,
+    SAMPLE_MISSES,
+    SAMPLE_EVICTIONS,
+    SAMPLE_METRICS
+} sampleMetric_t;
+
+/**
+ * Counters of one sample (a set or a time unit).
+ */
+typedef struct sampleCounters_t {
+    uint64_t counts[SAMPLE_METRICS];
+    uint64_t records;
+} sampleCounters_t;
+
+/**
+ * Sampler definition
+ * <p>
+ * The sums over completed units feed the variance of the ratio estimator.
+ */
+typedef struct sampler_t {
+    traceSample_t config;
+    Cache * cache;
+    uint64_t sampledSets;
+    sampleCounters_t * sets;
+    sampleCounters_t unit;
+    sampleCounters_t total;
+    uint64_t units;
+    double unitRecordSquares;
+    double unitSquares[SAMPLE_METRICS];
+    double unitProducts[SAMPLE_METRICS];
+} sampler_t;
+
+/**
+ * Creates a sampler from a specification such as "sets=16" or
+ * "period=1000000,warmup=20000,measure=10000" (or both).
+ * <p>
+ * Be sure to call samplerFree() to free memory and avoid memory leaks.
+ *
+ * @param sampler the sampler to initialize
+ * @param spec the specification
+ * @param cache the cache to simulate
+ * @return true on success
+ */
+bool samplerCreate(sampler_t *sampler, const char *spec, Cache *cache);
+
+/**
+ * Simulates a batch of sampled records, counting only measured ones.
+ *
+ * @param sampler the sampler to simulate
+ * @param batch the records to simulate
+ * @param count number of records in batch
+ */
+void samplerSimulateBatch(sampler_t *sampler, const trace_t *batch,
+        size_t count);
+
+/**
+ * Extrapolates a metric to the whole trace.
+ *
+ * @param sampler the sampler to report on
+ * @param metric the metric to extrapolate
+ * @param halfWidth receives the half width of the 95% confidence interval,
+ *                  0 if nothing was left out, or NAN if fewer than two
+ *                  sets or time units were sampled
+ * @return the estimated total
+ */
+double samplerEstimate(sampler_t *sampler, sampleMetric_t metric,
+        double *halfWidth);
+
+/**
+ * Prints how much was sampled and the extrapolated counters.
+ *
+ * @param sampler the sampler to report on
+ * @param stream the stream to print to
+ */
+void samplerPrint(sampler_t *sampler, FILE *stream);
+
+/**
+ * Frees memory allocated by samplerCreate().
+ *
+ * @param sampler the sampler to free
+ */
+void samplerFree(sampler_t *sampler);
+
+#endif  /* SAMPLE_H */
@@ -0,0 +1,202 @@
+/*
+ * File:   shard.c
+ * Author: Nathan Hernandez,
+ *         Alyssa Tyler
+ *
+ * LoginID: hernandeznp,
+ *          tylerae
+ *
+ * Set-sharded multithreaded simulation. See shard.h.
+ */
+
+/**
+ * Includes
+ */
+#include "shard.h"
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * Records staged by the reader before they are pushed to a worker queue.
+ */
+#define SHARD_STAGE_SIZE 512
+
+/**
+ * Sets are handed out in groups of 2^SHARD_GROUP_BITS so neighbouring
+ * workers do not share cache lines of the valid array.
+ */
+#define SHARD_GROUP_BITS 5
+
+/**
+ * Single-producer/single-consumer queue of trace records.
+ * <p>
+ * head is only written by the reader and tail only by the worker; each
+ * sits on its own cache line.
+ */
+typedef struct shardQueue_t {
+    _Alignas(64) atomic_size_t head;
+    _Alignas(64) atomic_size_t tail;
+    _Alignas(64) trace_t *records;
+} shardQueue_t;
+
+/**
+ * Worker definition
+ * <p>
+ * cache is a shallow copy of the shared cache: it points at the same tag
+ * store but has its own clock and counters. A set is only ever touched by
+ * one worker, so LRU stamps from different clocks are never compared.
+ */
+typedef struct shardWorker_t {
+    shardQueue_t queue;
+    Cache cache;
+    atomic_bool *done;
+    pthread_t thread;
+    trace_t stage[SHARD_STAGE_SIZE];
+    size_t staged;
+} shardWorker_t;
+
+/**
+ * Appends records to a worker queue, waiting while it is full.
+ */
+static void shardPush(shardQueue_t *queue, const trace_t *records, size_t count) {
+    size_t head = atomic_load_explicit(&queue->head, memory_order_relaxed);
+    size_t start = head & (SHARD_QUEUE_SIZE - 1);
+    size_t first = count < SHARD_QUEUE_SIZE - start
+            ? count : SHARD_QUEUE_SIZE - start;
+
+    while (head + count - atomic_load_explicit(&queue->tail,
+            memory_order_acquire) > SHARD_QUEUE_SIZE)
+        sched_yield();
+
+    memcpy(queue->records + start, records, first * sizeof(trace_t));
+    memcpy(queue->records, records + first, (count - first) * sizeof(trace_t));
+    atomic_store_explicit(&queue->head, head + count, memory_order_release);
+}
+
+/**
+ * Worker body: simulates everything in its queue until the reader is done.
+ */
+static void * shardRun(void *argument) {
+    shardWorker_t *worker = argument;
+    shardQueue_t *queue = &worker->queue;
+    size_t tail = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+    size_t head, start, count, first;
+
+    for (;;) {
+        head = atomic_load_explicit(&queue->head, memory_order_acquire);
+        if (head == tail) {
+            if (atomic_load_explicit(worker->done, memory_order_acquire)
+                    && atomic_load_explicit(&queue->head,
+                            memory_order_acquire) == tail)
+                break;
+            sched_yield();
+            continue;
+        }
+
+        start = tail & (SHARD_QUEUE_SIZE - 1);
+        count = head - tail;
+        first = count < SHARD_QUEUE_SIZE - start
+                ? count : SHARD_QUEUE_SIZE - start;
+        cacheSimulateBatch(&worker->cache, queue->records + start, first);
+        cacheSimulateBatch(&worker->cache, queue->records, count - first);
+
+        tail = head;
+        atomic_store_explicit(&queue->tail, tail, memory_order_release);
+    }
+    return NULL;
+}
+
+/**
+ * Simulates the rest of a trace on several threads.
+ * <p>
+ * The calling thread reads and dispatches the trace; instruction records
+ * are dropped before they reach a queue.
+ */
+bool shardSimulate(Cache *cache, traceReader_t *reader, unsigned threads) {
+    static trace_t batch[TRACE_BATCH_SIZE];
+    shardWorker_t *workers;
+    shardWorker_t *worker;
+    atomic_bool done;
+    uint8_t groupBits;
+    size_t count, i;
+    unsigned started, shard;
+    uint64_t set;
+    bool success = true;
+
+    if (threads < 1 || threads > SHARD_MAX_THREADS) {
+        fprintf(stderr, "Unsupported thread count %u (1-%d)\n", threads,
+                SHARD_MAX_THREADS);
+        return false;
+    }
+
+    groupBits = cache->setBits >= SHARD_GROUP_BITS + 8 ? SHARD_GROUP_BITS : 0;
+    if (posix_memalign((void **) &workers, 64, threads * sizeof(shardWorker_t)))
+        return false;
+    atomic_init(&done, false);
+
+    for (started = 0; started < threads; started++) {
+        worker = &workers[started];
+        atomic_init(&worker->queue.head, 0);
+        atomic_init(&worker->queue.tail, 0);
+        worker->queue.records = malloc(SHARD_QUEUE_SIZE * sizeof(trace_t));
+        worker->cache = *cache;
+        worker->cache.hits = 0;
+        worker->cache.misses = 0;
+        worker->cache.evictions = 0;
+        worker->cache.fills = 0;
+        worker->cache.writebacks = 0;
+        worker->cache.writeBytes = 0;
+        worker->done = &done;
+        worker->staged = 0;
+        if (worker->queue.records == NULL || pthread_create(&worker->thread,
+                NULL, shardRun, worker) != 0) {
+            free(worker->queue.records);
+            fprintf(stderr, "Unable to start worker thread\n");
+            success = false;
+            break;
+        }
+    }
+
+    while (success
+            && (count = traceNextBatch(reader, batch, TRACE_BATCH_SIZE)) > 0) {
+        for (i = 0; i < count; i++) {
+            if (batch[i].operation == 'I')
+                continue;
+            set = cacheSetOf(cache, batch[i].address);
+            shard = (set >> groupBits) % threads;
+            worker = &workers[shard];
+            worker->stage[worker->staged++] = batch[i];
+            if (worker->staged == SHARD_STAGE_SIZE) {
+                shardPush(&worker->queue, worker->stage, worker->staged);
+                worker->staged = 0;
+            }
+        }
+    }
+
+    for (shard = 0; shard < started; shard++)
+        if (workers[shard].staged)
+            shardPush(&workers[shard].queue, workers[shard].stage,
+                    workers[shard].staged);
+    atomic_store_explicit(&done, true, memory_order_release);
+
+    for (shard = 0; shard < started; shard++) {
+        worker = &workers[shard];
+        pthread_join(worker->thread, NULL);
+        cache->hits += worker->cache.hits;
+        cache->misses += worker->cache.misses;
+        cache->evictions += worker->cache.evictions;
+        cache->fills += worker->cache.fills;
+        cache->writebacks += worker->cache.writebacks;
+        cache->writeBytes += worker->cache.writeBytes;
+        if (worker->cache.clock > cache->clock)
+            cache->clock = worker->cache.clock;
+        free(worker->queue.records);
+    }
+    free(workers);
+
+    return success && !reader->error;
+}
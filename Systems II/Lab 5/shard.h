@@ -0,0 +1,44 @@
+/*
+ * File:   shard.h
+ * Author: Nathan Hernandez,
+ *         Alyssa Tyler
+ *
+ * LoginID: hernandeznp,
+ *          tylerae
+ *
+ * Set-sharded multithreaded simulation. Sets are independent, so the trace
+ * is split by set index into one lock-free single-producer/single-consumer
+ * queue per worker and every worker simulates its own shard of the sets.
+ */
+
+#ifndef SHARD_H
+#define SHARD_H
+
+#include <stdbool.h>
+#include "cache.h"
+#include "trace.h"
+
+/**
+ * Largest number of worker threads.
+ */
+#define SHARD_MAX_THREADS 256
+
+/**
+ * Number of trace_t records each worker queue can hold (a power of two).
+ */
+#define SHARD_QUEUE_SIZE 65536
+
+/**
+ * Simulates the rest of a trace on several threads and adds the merged
+ * counters to cache.
+ * <p>
+ * The totals are identical to a single-threaded run of the same trace.
+ *
+ * @param cache the cache to simulate
+ * @param reader the trace to read records from
+ * @param threads number of worker threads (1-SHARD_MAX_THREADS)
+ * @return true on success
+ */
+bool shardSimulate(Cache *cache, traceReader_t *reader, unsigned threads);
+
+#endif  /* SHARD_H */
@@ -0,0 +1,212 @@
+/*
+ * File:   stackdist.c
+ * Author: Nathan Hernandez,
+ *         Alyssa Tyler
+ *
+ * LoginID: hernandeznp,
+ *          tylerae
+ *
+ * Single-pass multi-configuration simulation. See stackdist.h.
+ */
+
+/**
+ * Includes
+ */
+#include "stackdist.h"
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * Parses a list of values such as "1,2,4" or "0-8" or "1-4,8".
+ */
+size_t stackParseList(const char *text, uint32_t *values, size_t capacity) {
+    size_t count = 0;
+    unsigned long first, last, value;
+    char *end;
+
+    while (*text) {
+        first = strtoul(text, &end, 10);
+        if (end == text)
+            return 0;
+        last = first;
+        text = end;
+        if (*text == '-') {
+            last = strtoul(++text, &end, 10);
+            if (end == text || last < first)
+                return 0;
+            text = end;
+        }
+        for (value = first; value <= last; value++) {
+            if (count == capacity)
+                return 0;
+            values[count++] = value;
+        }
+        if (*text == ',')
+            text++;
+        else if (*text)
+            return 0;
+    }
+    return count;
+}
+
+/**
+ * Creates a sweep over every combination of the given parameters.
+ * <p>
+ * The stacks only need to be as deep as the largest associativity: a block
+ * pushed off the bottom misses in every configuration anyway.
+ */
+bool stackSweepCreate(stackSweep_t *sweep,
+        const uint32_t *setBits, size_t setCount,
+        const uint32_t *associativities, size_t associativityCount,
+        const uint32_t *blockBits, size_t blockCount) {
+    size_t i, j, sets;
+    stackConfig_t *config;
+
+    sweep->depth = 0;
+    sweep->associativityCount = associativityCount;
+    for (i = 0; i < associativityCount; i++) {
+        if (associativities[i] == 0)
+            return false;
+        sweep->associativities[i] = associativities[i];
+        if (associativities[i] > sweep->depth)
+            sweep->depth = associativities[i];
+    }
+
+    sweep->configCount = setCount * blockCount;
+    sweep->configs = calloc(sweep->configCount, sizeof(stackConfig_t));
+    if (sweep->configs == NULL)
+        return false;
+
+    for (i = 0; i < blockCount; i++) {
+        for (j = 0; j < setCount; j++) {
+            config = &sweep->configs[i * setCount + j];
+            if (setBits[j] + blockBits[i] >= 64) {
+                stackSweepFree(sweep);
+                return false;
+            }
+            config->setBits = setBits[j];
+            config->blockBits = blockBits[i];
+            sets = (size_t) 1 << config->setBits;
+            config->stacks = malloc(sets * sweep->depth * sizeof(uint64_t));
+            config->occupancy = calloc(sets, sizeof(uint32_t));
+            config->distances = calloc(sweep->depth, sizeof(uint64_t));
+            config->cold = calloc(sweep->depth + 1, sizeof(uint64_t));
+            if (!config->stacks || !config->occupancy || !config->distances
+                    || !config->cold) {
+                stackSweepFree(sweep);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+/**
+ * Records one reference in the stack of its set and moves it to the top.
+ */
+static inline void stackAccess(stackConfig_t *config, uint32_t depth,
+        uint64_t address) {
+    uint64_t block = address >> config->blockBits;
+    size_t set = block & (((size_t) 1 << config->setBits) - 1);
+    uint64_t *stack = config->stacks + set * depth;
+    uint32_t occupancy = config->occupancy[set];
+    uint32_t distance;
+
+    for (distance = 0; distance < occupancy; distance++)
+        if (stack[distance] == block)
+            break;
+
+    if (distance < occupancy) {
+        config->distances[distance]++;
+    } else {
+        config->cold[occupancy]++;
+        if (occupancy < depth)
+            config->occupancy[set] = ++occupancy;
+        distance = occupancy - 1;
+    }
+    memmove(stack + 1, stack, distance * sizeof(uint64_t));
+    stack[0] = block;
+}
+
+/**
+ * Feeds a batch of trace records to every configuration of the sweep.
+ * <p>
+ * The store half of a modify is always at distance 0, so it is only
+ * counted.
+ */
+void stackSweepBatch(stackSweep_t *sweep, const trace_t *batch, size_t count) {
+    stackConfig_t *config;
+    size_t c, i;
+
+    for (c = 0; c < sweep->configCount; c++) {
+        config = &sweep->configs[c];
+        for (i = 0; i < count; i++) {
+            switch (batch[i].operation) {
+                case 'M':
+                    config->modifies++;
+                    /* fall through */
+                case 'L':
+                case 'S':
+                    stackAccess(config, sweep->depth, batch[i].address);
+                    break;
+            }
+        }
+    }
+}
+
+/**
+ * Prints one printSummary() style line per configuration.
+ * <p>
+ * With E ways a reference hits iff its stack distance is below E. A miss
+ * evicts iff the set already held E blocks, which is always the case for
+ * re-references at distance E or more.
+ */
+void stackSweepPrint(stackSweep_t *sweep, FILE *stream) {
+    stackConfig_t *config;
+    uint64_t hits, misses, evictions;
+    uint32_t associativity, d;
+    size_t c, a;
+
+    for (c = 0; c < sweep->configCount; c++) {
+        config = &sweep->configs[c];
+        for (a = 0; a < sweep->associativityCount; a++) {
+            associativity = sweep->associativities[a];
+            hits = config->modifies;
+            misses = 0;
+            evictions = 0;
+            for (d = 0; d < sweep->depth; d++) {
+                if (d < associativity)
+                    hits += config->distances[d];
+                else
+                    misses += config->distances[d];
+            }
+            evictions = misses;
+            for (d = 0; d <= sweep->depth; d++) {
+                misses += config->cold[d];
+                if (d >= associativity)
+                    evictions += config->cold[d];
+            }
+            fprintf(stream, "s=%u E=%u b=%u hits:%" PRIu64 " misses:%" PRIu64
+                    " evictions:%" PRIu64 "\n",
+                    config->setBits, associativity, config->blockBits,
+                    hits, misses, evictions);
+        }
+    }
+}
+
+/**
+ * Frees memory allocated by stackSweepCreate().
+ */
+void stackSweepFree(stackSweep_t *sweep) {
+    size_t c;
+
+    for (c = 0; c < sweep->configCount; c++) {
+        free(sweep->configs[c].stacks);
+        free(sweep->configs[c].occupancy);
+        free(sweep->configs[c].distances);
+        free(sweep->configs[c].cold);
+    }
+    free(sweep->configs);
+    sweep->configs = NULL;
+    sweep->configCount = 0;
+}
@@ -0,0 +1,109 @@
+/*
+ * File:   stackdist.h
+ * Author: Nathan Hernandez,
+ *         Alyssa Tyler
+ *
+ * LoginID: hernandeznp,
+ *          tylerae
+ *
+ * Single-pass multi-configuration simulation. For every (s, b) pair a
+ * per-set LRU stack (Mattson) is kept, and a histogram of stack distances
+ * gives hits, misses and evictions of every associativity at once.
+ */
+
+#ifndef STACKDIST_H
+#define STACKDIST_H
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include "trace.h"
+
+/**
+ * Largest number of values a -s/-E/-b list may hold.
+ */
+#define STACKDIST_MAX_VALUES 64
+
+/**
+ * Stack distance state of one (s, b) pair.
+ * <p>
+ * stacks holds depth block numbers per set, most recently used first.
+ * distances[d] counts re-references found at depth d; cold[n] counts
+ * references not in the stack while the set held n blocks.
+ */
+typedef struct stackConfig_t {
+    uint8_t setBits;
+    uint8_t blockBits;
+    uint64_t * stacks;
+    uint32_t * occupancy;
+    uint64_t * distances;
+    uint64_t * cold;
+    uint64_t modifies;
+} stackConfig_t;
+
+/**
+ * Multi-configuration sweep definition
+ */
+typedef struct stackSweep_t {
+    uint32_t associativities[STACKDIST_MAX_VALUES];
+    size_t associativityCount;
+    uint32_t depth;
+    stackConfig_t * configs;
+    size_t configCount;
+} stackSweep_t;
+
+/**
+ * Parses a list of values such as "1,2,4" or "0-8" or "1-4,8".
+ *
+ * @param text the text to parse
+ * @param values array receiving the values in the order given
+ * @param capacity number of values the array can hold
+ * @return number of values parsed, 0 if text is malformed
+ */
+size_t stackParseList(const char *text, uint32_t *values, size_t capacity);
+
+/**
+ * Creates a sweep over every combination of the given parameters.
+ * <p>
+ * Be sure to call stackSweepFree() to free memory and avoid memory leaks.
+ *
+ * @param sweep the sweep to initialize
+ * @param setBits set index bit values
+ * @param setCount number of set index bit values
+ * @param associativities associativity values
+ * @param associativityCount number of associativity values
+ * @param blockBits block bit values
+ * @param blockCount number of block bit values
+ * @return true on success
+ */
+bool stackSweepCreate(stackSweep_t *sweep,
+        const uint32_t *setBits, size_t setCount,
+        const uint32_t *associativities, size_t associativityCount,
+        const uint32_t *blockBits, size_t blockCount);
+
+/**
+ * Feeds a batch of trace records to every configuration of the sweep.
+ *
+ * @param sweep the sweep to update
+ * @param batch the records to simulate
+ * @param count number of records in batch
+ */
+void stackSweepBatch(stackSweep_t *sweep, const trace_t *batch, size_t count);
+
+/**
+ * Prints one printSummary() style line per configuration.
+ *
+ * @param sweep the sweep to report on
+ * @param stream the stream to print to
+ */
+void stackSweepPrint(stackSweep_t *sweep, FILE *stream);
+
+/**
+ * Frees memory allocated by stackSweepCreate().
+ *
+ * @param sweep the sweep to free
+ */
+void stackSweepFree(stackSweep_t *sweep);
+
+#endif  /* STACKDIST_H */
@@ -0,0 +1,129 @@
+/*
+ * File:   stream.c
+ * Author: Nathan Hernandez,
+ *         Alyssa Tyler
+ *
+ * LoginID: hernandeznp,
+ *          tylerae
+ *
+ * Pipelined trace consumption. See stream.h.
+ */
+
+/**
+ * Includes
+ */
+#include "stream.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/**
+ * One batch of the ring.
+ */
+typedef struct streamSlot_t {
+    trace_t records[TRACE_BATCH_SIZE];
+    size_t count;
+} streamSlot_t;
+
+/**
+ * Ring of batches shared by the reader thread and the simulator.
+ * <p>
+ * Slot head % STREAM_SLOTS is filled by the reader and slot
+ * tail % STREAM_SLOTS drained by the simulator; the counters are guarded by
+ * lock.
+ */
+typedef struct streamRing_t {
+    streamSlot_t slots[STREAM_SLOTS];
+    size_t head;
+    size_t tail;
+    bool done;
+    pthread_mutex_t lock;
+    pthread_cond_t notFull;
+    pthread_cond_t notEmpty;
+    traceReader_t *reader;
+} streamRing_t;
+
+/**
+ * Reader thread body: parses batches into free slots until the trace ends.
+ */
+static void * streamRead(void *argument) {
+    streamRing_t *ring = argument;
+    streamSlot_t *slot;
+
+    for (;;) {
+        pthread_mutex_lock(&ring->lock);
+        while (ring->head - ring->tail == STREAM_SLOTS)
+            pthread_cond_wait(&ring->notFull, &ring->lock);
+        slot = &ring->slots[ring->head % STREAM_SLOTS];
+        pthread_mutex_unlock(&ring->lock);
+
+        slot->count = traceNextBatch(ring->reader, slot->records,
+                TRACE_BATCH_SIZE);
+
+        pthread_mutex_lock(&ring->lock);
+        if (slot->count)
+            ring->head++;
+        else
+            ring->done = true;
+        pthread_cond_signal(&ring->notEmpty);
+        pthread_mutex_unlock(&ring->lock);
+
+        if (!slot->count)
+            return NULL;
+    }
+}
+
+/**
+ * Reads the trace on a separate thread and hands every batch to consume on
+ * the calling thread, in trace order.
+ */
+bool streamPipeline(traceReader_t *reader, streamConsumer_t consume,
+        void *context) {
+    streamRing_t *ring;
+    streamSlot_t *slot;
+    pthread_t thread;
+
+    ring = malloc(sizeof(streamRing_t));
+    if (ring == NULL)
+        return false;
+    ring->head = 0;
+    ring->tail = 0;
+    ring->done = false;
+    ring->reader = reader;
+    pthread_mutex_init(&ring->lock, NULL);
+    pthread_cond_init(&ring->notFull, NULL);
+    pthread_cond_init(&ring->notEmpty, NULL);
+
+    if (pthread_create(&thread, NULL, streamRead, ring) != 0) {
+        fprintf(stderr, "Unable to start reader thread\n");
+        free(ring);
+        return false;
+    }
+
+    for (;;) {
+        pthread_mutex_lock(&ring->lock);
+        while (ring->head == ring->tail && !ring->done)
+            pthread_cond_wait(&ring->notEmpty, &ring->lock);
+        if (ring->head == ring->tail) {
+            pthread_mutex_unlock(&ring->lock);
+            break;
+        }
+        slot = &ring->slots[ring->tail % STREAM_SLOTS];
+        pthread_mutex_unlock(&ring->lock);
+
+        consume(context, slot->records, slot->count);
+
+        pthread_mutex_lock(&ring->lock);
+        ring->tail++;
+        pthread_cond_signal(&ring->notFull);
+        pthread_mutex_unlock(&ring->lock);
+    }
+
+    pthread_join(thread, NULL);
+    pthread_mutex_destroy(&ring->lock);
+    pthread_cond_destroy(&ring->notFull);
+    pthread_cond_destroy(&ring->notEmpty);
+    free(ring);
+
+    return !reader->error;
+}
@@ -0,0 +1,45 @@
+/*
+ * File:   stream.h
+ * Author: Nathan Hernandez,
+ *         Alyssa Tyler
+ *
+ * LoginID: hernandeznp,
+ *          tylerae
+ *
+ * Pipelined trace consumption. A reader thread parses the trace into a
+ * bounded ring of trace_t batches while the calling thread simulates them,
+ * so parsing overlaps simulation and memory use stays fixed no matter how
+ * long the trace is.
+ */
+
+#ifndef STREAM_H
+#define STREAM_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "trace.h"
+
+/**
+ * Number of batches in the ring between the reader and the simulator.
+ */
+#define STREAM_SLOTS 8
+
+/**
+ * Callback that consumes one batch of trace records.
+ */
+typedef void (*streamConsumer_t)(void *context, const trace_t *batch,
+        size_t count);
+
+/**
+ * Reads the trace on a separate thread and hands every batch to consume on
+ * the calling thread, in trace order.
+ *
+ * @param reader the trace to read records from
+ * @param consume the callback to pass each batch to
+ * @param context first argument of consume
+ * @return true if the whole trace was read without issue
+ */
+bool streamPipeline(traceReader_t *reader, streamConsumer_t consume,
+        void *context);
+
+#endif  /* STREAM_H */
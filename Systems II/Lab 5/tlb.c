@@ -0,0 +1,125 @@
+/*
+ * File:   tlb.c
+ * Author: Nathan Hernandez,
+ *         Alyssa Tyler
+ *
+ * LoginID: hernandeznp,
+ *          tylerae
+ *
+ * Data TLB. See tlb.h.
+ */
+
+/**
+ * Includes
+ */
+#include "tlb.h"
+#include <string.h>
+
+/**
+ * Level names indexed by tlbLevelId_t.
+ */
+static const char *tlbNames[TLB_LEVELS] = {
+    [TLB_L1] = "DTLB",
+    [TLB_L2] = "STLB"
+};
+
+/**
+ * Parses a page size name.
+ */
+bool tlbPageBits(const char *name, uint8_t *pageBits) {
+    if (strcmp(name, "4k") == 0 || strcmp(name, "4K") == 0)
+        *pageBits = 12;
+    else if (strcmp(name, "2m") == 0 || strcmp(name, "2M") == 0)
+        *pageBits = 21;
+    else if (strcmp(name, "1g") == 0 || strcmp(name, "1G") == 0)
+        *pageBits = 30;
+    else
+        return false;
+    return true;
+}
+
+/**
+ * Creates one level of a TLB.
+ */
+bool tlbCreateLevel(tlb_t *tlb, tlbLevelId_t id, uint8_t setBits,
+        uint8_t associativity, cachePolicy_t policy) {
+    tlbLevel_t *level = &tlb->levels[id];
+
+    if (level->present
+            || !cacheCreate(&level->cache, setBits, associativity, 0, policy))
+        return false;
+    level->present = true;
+    return true;
+}
+
+/**
+ * Looks up the page holding address and fills the levels that missed.
+ */
+bool tlbTranslate(tlb_t *tlb, uint64_t address) {
+    uint64_t page = address >> tlb->pageBits, victim;
+    bool victimDirty, hit = false;
+    tlbLevelId_t id, i;
+
+    for (id = 0; id < TLB_LEVELS && tlb->levels[id].present; id++) {
+        if (cacheTouch(&tlb->levels[id].cache, page)) {
+            tlb->levels[id].hits++;
+            hit = true;
+            break;
+        }
+        tlb->levels[id].misses++;
+    }
+    for (i = id; i-- > 0;)
+        cacheInsert(&tlb->levels[i].cache, page, false, &victim,
+                &victimDirty);
+    tlb->walks += !hit;
+    return hit;
+}
+
+/**
+ * Returns the number of page-table reads of a walk.
+ */
+uint8_t tlbWalkSteps(const tlb_t *tlb) {
+    return 4 - (tlb->pageBits - 12) / 9;
+}
+
+/**
+ * Returns the address of the page-table entry read by one step of a walk:
+ * each step consumes 9 bits of the 48-bit virtual address.
+ */
+uint64_t tlbWalkAddress(uint64_t address, uint8_t step) {
+    uint64_t virtual = address & ((1ull << 48) - 1);
+
+    return TLB_TABLE_BASE + ((uint64_t) step << 40)
+            + (virtual >> (39 - 9 * step)) * 8;
+}
+
+/**
+ * Prints the counters of every level and of the walks.
+ */
+void tlbPrint(const tlb_t *tlb, FILE *stream) {
+    tlbLevelId_t id;
+
+    for (id = 0; id < TLB_LEVELS; id++)
+        if (tlb->levels[id].present)
+            fprintf(stream, "%-4s hits:%" PRIu64 " misses:%" PRIu64 "\n",
+                    tlbNames[id], tlb->levels[id].hits,
+                    tlb->levels[id].misses);
+    fprintf(stream, "WALK page:%s walks:%" PRIu64 " accesses:%" PRIu64
+            " cycles:%" PRIu64 " cycles/walk:%.1f\n",
+            tlb->pageBits == 30 ? "1G" : tlb->pageBits == 21 ? "2M" : "4K",
+            tlb->walks, tlb->walkAccesses, tlb->walkCycles,
+            tlb->walks ? (double) tlb->walkCycles / tlb->walks : 0.0);
+}
+
+/**
+ * Frees the levels of a TLB.
+ */
+void tlbFree(tlb_t *tlb) {
+    tlbLevelId_t id;
+
+    for (id = 0; id < TLB_LEVELS; id++) {
+        if (tlb->levels[id].present)
+            freeCacheTags(&tlb->levels[id].cache);
+        tlb->levels[id].present = false;
+    }
+}
@@ -0,0 +1,133 @@
+/*
+ * File:   tlb.h
+ * Author: Nathan Hernandez,
+ *         Alyssa Tyler
+ *
+ * LoginID: hernandeznp,
+ *          tylerae
+ *
+ * Data TLB: an L1 dTLB and an optional L2 TLB in front of the cache
+ * hierarchy, with 4K, 2M or 1G pages.
+ * <p>
+ * Each TLB level is a Cache of virtual page numbers with one-byte blocks, so
+ * it shares the replacement policies of the data caches. The L2 TLB is
+ * non-inclusive: a translation found there is filled into the L1 dTLB, and
+ * a walk fills both.
+ * <p>
+ * A walk reads one x86-64 page-table entry per level, from the PML4 down to
+ * the leaf: four reads for 4K pages, three for 2M and two for 1G. The
+ * tables live at TLB_TABLE_BASE, one 2^40 byte region per level, with the
+ * entries of neighboring pages adjacent, so walks for nearby pages share
+ * cache lines as they do on hardware. There are no paging-structure caches.
+ */
+
+#ifndef TLB_H
+#define TLB_H
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include "cache.h"
+
+/**
+ * Base address of the simulated page tables, above any user address.
+ */
+#define TLB_TABLE_BASE 0xffff800000000000ull
+
+/**
+ * TLB levels.
+ */
+typedef enum tlbLevelId_t {
+    TLB_L1,
+    TLB_L2,
+    TLB_LEVELS
+} tlbLevelId_t;
+
+/**
+ * TLB level definition
+ */
+typedef struct tlbLevel_t {
+    bool present;
+    Cache cache;
+    uint64_t hits;
+    uint64_t misses;
+} tlbLevel_t;
+
+/**
+ * TLB definition
+ */
+typedef struct tlb_t {
+    tlbLevel_t levels[TLB_LEVELS];
+    uint8_t pageBits;
+    uint64_t walks;
+    uint64_t walkAccesses;
+    uint64_t walkCycles;
+} tlb_t;
+
+/**
+ * Parses a page size name.
+ *
+ * @param name "4k", "2m" or "1g"
+ * @param pageBits receives the log2 of the page size
+ * @return true if the name is known
+ */
+bool tlbPageBits(const char *name, uint8_t *pageBits);
+
+/**
+ * Creates one level of a TLB. The TLB must have been zeroed first, and
+ * its pageBits set before the first tlbTranslate().
+ * <p>
+ * Be sure to call tlbFree() to free memory and avoid memory leaks.
+ *
+ * @param tlb the TLB the level belongs to
+ * @param id the level to create
+ * @param setBits number of set index bits
+ * @param associativity number of entries per set
+ * @param policy the replacement policy
+ * @return true on success
+ */
+bool tlbCreateLevel(tlb_t *tlb, tlbLevelId_t id, uint8_t setBits,
+        uint8_t associativity, cachePolicy_t policy);
+
+/**
+ * Looks up the page holding address and fills the levels that missed.
+ *
+ * @param tlb the TLB to look in
+ * @param address the virtual address
+ * @return true if a level held the translation, false if a walk is needed
+ */
+bool tlbTranslate(tlb_t *tlb, uint64_t address);
+
+/**
+ * Returns the number of page-table reads of a walk.
+ *
+ * @param tlb the TLB
+ * @return 4, 3 or 2 for 4K, 2M or 1G pages
+ */
+uint8_t tlbWalkSteps(const tlb_t *tlb);
+
+/**
+ * Returns the address of the page-table entry read by one step of a walk.
+ *
+ * @param address the virtual address being translated
+ * @param step 0 for the PML4 entry, up to tlbWalkSteps() - 1 for the leaf
+ * @return the address of the entry
+ */
+uint64_t tlbWalkAddress(uint64_t address, uint8_t step);
+
+/**
+ * Prints the counters of every level and of the walks.
+ *
+ * @param tlb the TLB to report on
+ * @param stream the stream to print to
+ */
+void tlbPrint(const tlb_t *tlb, FILE *stream);
+
+/**
+ * Frees the levels of a TLB.
+ *
+ * @param tlb the TLB to free
+ */
+void tlbFree(tlb_t *tlb);
+
+#endif  /* TLB_H */
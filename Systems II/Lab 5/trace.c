@@ -0,0 +1,436 @@
+/*
+ * File:   trace.c
+ * Author: Nathan Hernandez,
+ *         Alyssa Tyler
+ *
+ * LoginID: hernandeznp,
+ *          tylerae
+ *
+ * Trace ingestion layer. See trace.h.
+ */
+
+/**
+ * Includes
+ */
+#include "trace.h"
+#include "pack.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+/**
+ * Returns the current monotonic time in seconds.
+ */
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/**
+ * Converts a hex digit to its value.
+ *
+ * @param c the character to convert
+ * @return the value of the digit, or -1 if c is not a hex digit
+ */
+static inline int hexDigit(uint8_t c) {
+    if ((uint8_t) (c - '0') < 10)
+        return c - '0';
+    c |= 0x20;
+    if ((uint8_t) (c - 'a') < 6)
+        return c - 'a' + 10;
+    return -1;
+}
+
+/**
+ * Opens and memory-maps a valgrind or packed trace file, or prepares to
+ * stream a valgrind trace from stdin if path is "-".
+ */
+bool traceOpen(traceReader_t *reader, const char *path) {
+    struct stat info;
+
+    reader->fd = -1;
+    reader->data = NULL;
+    reader->length = 0;
+    reader->offset = 0;
+    reader->lines = 0;
+    reader->parseSeconds = 0;
+    reader->error = false;
+    reader->packed = false;
+    reader->blockRemaining = 0;
+    reader->blockEnd = 0;
+    reader->previous = 0;
+    reader->stream = false;
+    reader->eof = false;
+    reader->streamed = 0;
+    reader->sample = NULL;
+
+    if (strcmp(path, "-") == 0) {
+        reader->data = malloc(TRACE_STREAM_BUFFER);
+        if (reader->data == NULL)
+            return false;
+        reader->stream = true;
+        return true;
+    }
+
+    reader->fd = open(path, O_RDONLY);
+    if (reader->fd < 0 || fstat(reader->fd, &info) != 0) {
+        perror("Error opening file");
+        traceClose(reader);
+        return false;
+    }
+
+    reader->length = info.st_size;
+    if (reader->length == 0)
+        return true;
+
+    reader->data = mmap(NULL, reader->length, PROT_READ, MAP_PRIVATE,
+            reader->fd, 0);
+    if (reader->data == MAP_FAILED) {
+        perror("Error mapping file");
+        reader->data = NULL;
+        traceClose(reader);
+        return false;
+    }
+    madvise((void *) reader->data, reader->length, MADV_SEQUENTIAL);
+
+    if (packIsPacked(reader->data, reader->length)) {
+        reader->packed = true;
+        reader->offset = PACK_HEADER_SIZE;
+    }
+    return true;
+}
+
+/**
+ * Decodes the next batch of records from a packed trace.
+ * <p>
+ * When a block is entered the pages of the following block are requested
+ * from the kernel so they are read while this one is being decoded.
+ */
+static size_t traceNextPackedBatch(traceReader_t *reader, trace_t *batch,
+        size_t capacity) {
+    const uint8_t *base = (const uint8_t *) reader->data;
+    const uint8_t *p = base + reader->offset;
+    const uint8_t *end = base + reader->length;
+    size_t count = 0;
+    size_t page = sysconf(_SC_PAGESIZE);
+    size_t next, length, n;
+    uint32_t records, bytes;
+
+    while (count < capacity) {
+        if (reader->blockRemaining == 0) {
+            if (p == end)
+                break;
+            if ((size_t) (end - p) < PACK_BLOCK_HEADER_SIZE)
+                goto corrupt;
+            packBlockHeader(p, &records, &bytes);
+            p += PACK_BLOCK_HEADER_SIZE;
+            if (bytes > (size_t) (end - p))
+                goto corrupt;
+            reader->blockRemaining = records;
+            reader->blockEnd = p + bytes - base;
+            reader->previous = 0;
+
+            next = reader->blockEnd & ~(page - 1);
+            length = PACK_BLOCK_HEADER_SIZE + bytes + page;
+            if (next < reader->length) {
+                if (length > reader->length - next)
+                    length = reader->length - next;
+                madvise((void *) (base + next), length, MADV_WILLNEED);
+            }
+        }
+
+        n = capacity - count < reader->blockRemaining
+                ? capacity - count : reader->blockRemaining;
+        p = packDecode(p, base + reader->blockEnd, &reader->previous,
+                batch + count, n);
+        if (p == NULL)
+            goto corrupt;
+        count += n;
+        reader->lines += n;
+        reader->blockRemaining -= n;
+        if (reader->blockRemaining == 0 && p != base + reader->blockEnd)
+            goto corrupt;
+    }
+    reader->offset = p - base;
+    return count;
+
+corrupt:
+    fprintf(stderr, "Corrupt packed trace after record %" PRIu64 "\n",
+            reader->lines);
+    reader->error = true;
+    return 0;
+}
+
+/**
+ * Parses text records from data[offset] up to data[limit].
+ * <p>
+ * Lines have the form "[space]op address,size[ thread]". Blank lines and
+ * valgrind log lines ("==pid== ...") are skipped and anything after the
+ * optional thread id is ignored.
+ */
+static size_t traceParseText(traceReader_t *reader, trace_t *batch,
+        size_t capacity, size_t limit) {
+    const char *p = reader->data + reader->offset;
+    const char *end = reader->data + limit;
+    const char *digits;
+    size_t count = 0;
+    uint64_t address;
+    unsigned size, thread;
+    int digit;
+    char operation;
+
+    while (count < capacity && p < end) {
+        while (p < end && (*p == ' ' || *p == '\t'))
+            p++;
+        if (p == end)
+            break;
+        if (*p == '\n' || *p == '\r' || *p == '=') {
+            while (p < end && *p != '\n')
+                p++;
+            if (p < end)
+                p++;
+            continue;
+        }
+
+        operation = *p++;
+        while (p < end && *p == ' ')
+            p++;
+
+        address = 0;
+        digits = p;
+        while (p < end && (digit = hexDigit(*p)) >= 0) {
+            address = (address << 4) | digit;
+            p++;
+        }
+        if (p == digits || p == end || *p != ',')
+            goto malformed;
+        p++;
+
+        size = 0;
+        digits = p;
+        while (p < end && (uint8_t) (*p - '0') < 10)
+            size = size * 10 + (*p++ - '0');
+        if (p == digits)
+            goto malformed;
+
+        thread = 0;
+        while (p < end && (*p == ' ' || *p == '\t'))
+            p++;
+        while (p < end && (uint8_t) (*p - '0') < 10)
+            thread = thread * 10 + (*p++ - '0');
+
+        while (p < end && *p != '\n')
+            p++;
+        if (p < end)
+            p++;
+
+        switch (operation) {
+            case 'I':
+            case 'L':
+            case 'S':
+            case 'M':
+                break;
+            default:
+                goto malformed;
+        }
+
+        batch[count].address = address;
+        batch[count].operation = operation;
+        batch[count].size = size;
+        batch[count].thread = thread;
+        batch[count].sample = TRACE_MEASURE;
+        count++;
+        reader->lines++;
+    }
+    reader->offset = p - reader->data;
+    return count;
+
+malformed:
+    fprintf(stderr, "Malformed trace line %" PRIu64 "\n", reader->lines + 1);
+    reader->error = true;
+    reader->offset = p - reader->data;
+    return count;
+}
+
+/**
+ * Refills the stream buffer from stdin, keeping the unparsed tail.
+ *
+ * @return false on a read error
+ */
+static bool traceFill(traceReader_t *reader) {
+    char *buffer = (char *) reader->data;
+    size_t rest = reader->length - reader->offset;
+    ssize_t n;
+
+    memmove(buffer, buffer + reader->offset, rest);
+    reader->streamed += reader->offset;
+    reader->offset = 0;
+    reader->length = rest;
+
+    do {
+        n = read(STDIN_FILENO, buffer + reader->length,
+                TRACE_STREAM_BUFFER - reader->length);
+    } while (n < 0 && errno == EINTR);
+
+    if (n < 0) {
+        perror("Error reading stdin");
+        reader->error = true;
+        return false;
+    }
+    if (n == 0)
+        reader->eof = true;
+    reader->length += n;
+    return true;
+}
+
+/**
+ * Parses the next batch of records from stdin.
+ * <p>
+ * Only complete lines are parsed until the end of input is reached; a
+ * partial line waits in the buffer for the next read.
+ */
+static size_t traceNextStreamBatch(traceReader_t *reader, trace_t *batch,
+        size_t capacity) {
+    size_t limit, count;
+    double start;
+
+    for (;;) {
+        limit = reader->length;
+        if (!reader->eof)
+            while (limit > reader->offset && reader->data[limit - 1] != '\n')
+                limit--;
+
+        if (limit > reader->offset) {
+            start = now();
+            count = traceParseText(reader, batch, capacity, limit);
+            reader->parseSeconds += now() - start;
+            if (count || reader->error)
+                return count;
+            continue;
+        }
+
+        if (reader->eof)
+            return 0;
+        if (reader->length - reader->offset == TRACE_STREAM_BUFFER) {
+            fprintf(stderr, "Trace line %" PRIu64 " is too long\n",
+                    reader->lines + 1);
+            reader->error = true;
+            return 0;
+        }
+        if (!traceFill(reader))
+            return 0;
+    }
+}
+
+/**
+ * Checks whether set sampling keeps a set.
+ */
+bool traceSampleKeepsSet(const traceSample_t *sample, uint64_t set) {
+    uint64_t hash = set * 0x9e3779b97f4a7c15ull;
+
+    return sample->setRatio <= 1 || (hash >> 32) % sample->setRatio == 0;
+}
+
+/**
+ * Drops the records of a batch that sampling does not keep and marks the
+ * rest, in place.
+ *
+ * @return number of records kept
+ */
+static size_t traceSampleBatch(traceSample_t *sample, trace_t *batch,
+        size_t count) {
+    uint64_t setMask = ((uint64_t) 1 << sample->setBits) - 1;
+    uint64_t skip = sample->period - sample->warmup - sample->measure;
+    uint64_t phase;
+    size_t kept = 0, i;
+
+    for (i = 0; i < count; i++) {
+        if (batch[i].operation == 'I')
+            continue;
+        if (!traceSampleKeepsSet(sample,
+                batch[i].address >> sample->blockBits & setMask))
+            continue;
+
+        batch[kept] = batch[i];
+        batch[kept].sample = TRACE_MEASURE;
+        if (sample->period) {
+            phase = sample->position++ % sample->period;
+            if (phase < skip)
+                continue;
+            if (phase < skip + sample->warmup)
+                batch[kept].sample = TRACE_WARM;
+            else if (phase == skip + sample->warmup)
+                batch[kept].sample = TRACE_UNIT;
+        }
+        kept++;
+    }
+    return kept;
+}
+
+/**
+ * Parses the next batch of records from the trace.
+ */
+size_t traceNextBatch(traceReader_t *reader, trace_t *batch, size_t capacity) {
+    size_t count;
+    double start;
+
+    do {
+        if (reader->error)
+            return 0;
+        if (reader->stream) {
+            count = traceNextStreamBatch(reader, batch, capacity);
+        } else if (reader->data == NULL) {
+            return 0;
+        } else {
+            start = now();
+            if (reader->packed)
+                count = traceNextPackedBatch(reader, batch, capacity);
+            else
+                count = traceParseText(reader, batch, capacity,
+                        reader->length);
+            reader->parseSeconds += now() - start;
+        }
+        if (count == 0 || reader->sample == NULL)
+            return count;
+        count = traceSampleBatch(reader->sample, batch, count);
+    } while (count == 0);
+    return count;
+}
+
+/**
+ * Unmaps and closes the trace file.
+ */
+void traceClose(traceReader_t *reader) {
+    if (reader->stream)
+        free((void *) reader->data);
+    else if (reader->data != NULL)
+        munmap((void *) reader->data, reader->length);
+    if (reader->fd >= 0)
+        close(reader->fd);
+    reader->data = NULL;
+    reader->fd = -1;
+}
+
+/**
+ * Prints the parse throughput of the reader in lines/s and GB/s.
+ */
+void tracePrintThroughput(traceReader_t *reader, FILE *stream) {
+    double seconds = reader->parseSeconds > 0 ? reader->parseSeconds : 1e-9;
+    uint64_t bytes = reader->streamed + reader->offset;
+
+    fprintf(stream,
+            "Parsed %" PRIu64 " lines (%.1f MB) in %.3f s: "
+            "%.0f lines/s, %.2f GB/s\n",
+            reader->lines,
+            bytes / 1e6,
+            reader->parseSeconds,
+            reader->lines / seconds,
+            bytes / seconds / 1e9
+    );
+}
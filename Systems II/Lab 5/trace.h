@@ -0,0 +1,140 @@
+/*
+ * File:   trace.h
+ * Author: Nathan Hernandez,
+ *         Alyssa Tyler
+ *
+ * LoginID: hernandeznp,
+ *          tylerae
+ *
+ * Trace ingestion layer. Valgrind traces are memory-mapped and parsed in
+ * place into batches of trace_t records, with no per-line stdio calls.
+ * Packed binary traces (see pack.h) are detected and decoded the same way.
+ * A path of "-" streams the trace from stdin through a fixed-size buffer.
+ */
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+
+/**
+ * Number of trace_t records handed to the cache core at a time.
+ */
+#define TRACE_BATCH_SIZE 4096
+
+/**
+ * Size of the read buffer used when streaming from stdin.
+ */
+#define TRACE_STREAM_BUFFER (1 << 20)
+
+/**
+ * Sample marks of a record: counted, only warming the cache, or counted
+ * and starting a new time sampling unit.
+ */
+#define TRACE_MEASURE 0
+#define TRACE_WARM 1
+#define TRACE_UNIT 2
+
+/**
+ * Trace definition
+ * <p>
+ * thread is the full thread id of the optional last column, or 0.
+ */
+typedef struct trace_t {
+    uint64_t address;
+    char operation;
+    uint8_t size;
+    uint8_t sample;
+    uint32_t thread;
+} trace_t;
+
+/**
+ * Sampling applied by the reader. Set sampling keeps the data records of
+ * one set in setRatio, picked by a hash of the set index. Time sampling
+ * splits the kept data records into periods that end with warmup records
+ * marked TRACE_WARM followed by measure records; the rest of a period is
+ * dropped. Instruction records are always dropped.
+ */
+typedef struct traceSample_t {
+    uint8_t setBits;
+    uint8_t blockBits;
+    uint32_t setRatio;
+    uint64_t period;
+    uint64_t warmup;
+    uint64_t measure;
+    uint64_t position;
+} traceSample_t;
+
+/**
+ * Trace reader definition
+ */
+typedef struct traceReader_t {
+    int fd;
+    const char *data;
+    size_t length;
+    size_t offset;
+    uint64_t lines;
+    double parseSeconds;
+    bool error;
+    bool packed;
+    uint32_t blockRemaining;
+    size_t blockEnd;
+    uint64_t previous;
+    bool stream;
+    bool eof;
+    uint64_t streamed;
+    traceSample_t *sample;
+} traceReader_t;
+
+/**
+ * Opens and memory-maps a valgrind or packed trace file, or prepares to
+ * stream a valgrind trace from stdin if path is "-".
+ *
+ * @param reader the reader to initialize
+ * @param path path of the trace file
+ * @return true if the file was opened and mapped
+ */
+bool traceOpen(traceReader_t *reader, const char *path);
+
+/**
+ * Parses the next batch of records from the trace.
+ * <p>
+ * On a malformed line reader->error is set and the records parsed before it
+ * are returned. If reader->sample is set, records it drops never reach
+ * batch.
+ *
+ * @param reader the reader to parse from
+ * @param batch array receiving the parsed records
+ * @param capacity number of records batch can hold
+ * @return number of records written to batch, 0 at end of trace
+ */
+size_t traceNextBatch(traceReader_t *reader, trace_t *batch, size_t capacity);
+
+/**
+ * Checks whether set sampling keeps a set.
+ *
+ * @param sample the sampling to apply
+ * @param set the set index
+ * @return true if records of the set are kept
+ */
+bool traceSampleKeepsSet(const traceSample_t *sample, uint64_t set);
+
+/**
+ * Unmaps and closes the trace file.
+ *
+ * @param reader the reader to close
+ */
+void traceClose(traceReader_t *reader);
+
+/**
+ * Prints the parse throughput of the reader in lines/s and GB/s.
+ *
+ * @param reader the reader to report on
+ * @param stream the stream to print to
+ */
+void tracePrintThroughput(traceReader_t *reader, FILE *stream);
+
+#endif  /* TRACE_H */
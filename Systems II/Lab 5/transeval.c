@@ -0,0 +1,256 @@
+/*
+ * File:   transeval.c
+ * Author: Nathan Hernandez,
+ *         Alyssa Tyler
+ *
+ * LoginID: hernandeznp,
+ *          tylerae
+ *
+ * In-process transpose evaluation. See transeval.h.
+ */
+
+/**
+ * Includes
+ */
+#define _GNU_SOURCE
+#include "transeval.h"
+#include <errno.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <ucontext.h>
+#include <unistd.h>
+
+/**
+ * Bytes of one matrix.
+ */
+#define TRANS_MATRIX_BYTES (TRANS_MAX_DIM * TRANS_MAX_DIM * sizeof(int))
+
+/**
+ * Largest number of pages one instruction may have unprotected.
+ */
+#define TRANS_PENDING_PAGES 8
+
+/**
+ * Trap flag of EFLAGS.
+ */
+#define TRANS_TRAP_FLAG 0x100
+
+/**
+ * State shared with the signal handlers. Only one evaluation runs at a
+ * time.
+ */
+static struct {
+    char *matrices;
+    Cache *cache;
+    size_t page;
+    char *pending[TRANS_PENDING_PAGES];
+    volatile sig_atomic_t pendingCount;
+    volatile sig_atomic_t overflow;
+} tracer;
+
+#if defined(__x86_64__) && defined(__linux__)
+
+/**
+ * Fault handler: counts an access to A or B, opens its page and
+ * single-steps the instruction. Other faults are real crashes.
+ */
+static void transFault(int number, siginfo_t *info, void *context) {
+    ucontext_t *ucontext = context;
+    char *address = info->si_addr;
+    char *page = (char *) ((uintptr_t) address & ~(tracer.page - 1));
+
+    (void) number;
+    if (address < tracer.matrices
+            || address >= tracer.matrices + 2 * TRANS_MATRIX_BYTES) {
+        /* Not ours: fault again with the default action. */
+        signal(SIGSEGV, SIG_DFL);
+        return;
+    }
+    if (tracer.pendingCount == TRANS_PENDING_PAGES) {
+        /* Give up tracing and let the function finish untraced. */
+        tracer.overflow = true;
+        mprotect(tracer.matrices, 2 * TRANS_MATRIX_BYTES,
+                PROT_READ | PROT_WRITE);
+        return;
+    }
+
+    cacheAccess(tracer.cache, TRANS_SIM_BASE + (address - tracer.matrices));
+    mprotect(page, tracer.page, PROT_READ | PROT_WRITE);
+    tracer.pending[tracer.pendingCount++] = page;
+    ucontext->uc_mcontext.gregs[REG_EFL] |= TRANS_TRAP_FLAG;
+}
+
+/**
+ * Trap handler: protects the pages the stepped instruction used again.
+ */
+static void transTrap(int number, siginfo_t *info, void *context) {
+    ucontext_t *ucontext = context;
+
+    (void) number;
+    (void) info;
+    while (tracer.pendingCount > 0)
+        mprotect(tracer.pending[--tracer.pendingCount], tracer.page,
+                PROT_NONE);
+    ucontext->uc_mcontext.gregs[REG_EFL] &= ~TRANS_TRAP_FLAG;
+}
+
+/**
+ * Runs func with its matrices protected, tracing every access.
+ *
+ * @return true if every access was traced
+ */
+static bool transTrace(trans_func_t *func, int M, int N, int *A, int *B) {
+    struct sigaction fault, trap, oldFault, oldTrap;
+
+    memset(&fault, 0, sizeof(fault));
+    fault.sa_sigaction = transFault;
+    fault.sa_flags = SA_SIGINFO | SA_NODEFER;
+    sigemptyset(&fault.sa_mask);
+    trap = fault;
+    trap.sa_sigaction = transTrap;
+
+    tracer.pendingCount = 0;
+    tracer.overflow = false;
+    sigaction(SIGSEGV, &fault, &oldFault);
+    sigaction(SIGTRAP, &trap, &oldTrap);
+    mprotect(tracer.matrices, 2 * TRANS_MATRIX_BYTES, PROT_NONE);
+
+    func->func_ptr(M, N, (int (*)[M]) A, (int (*)[N]) B);
+
+    mprotect(tracer.matrices, 2 * TRANS_MATRIX_BYTES, PROT_READ | PROT_WRITE);
+    sigaction(SIGSEGV, &oldFault, NULL);
+    sigaction(SIGTRAP, &oldTrap, NULL);
+    return !tracer.overflow;
+}
+
+#else
+
+/**
+ * Tracing is not supported on this platform.
+ */
+static bool transTrace(trans_func_t *func, int M, int N, int *A, int *B) {
+    (void) func;
+    (void) M;
+    (void) N;
+    (void) A;
+    (void) B;
+    fprintf(stderr, "Transpose tracing needs x86-64 Linux\n");
+    return false;
+}
+
+#endif
+
+/**
+ * Evaluates a transpose function on an N x M matrix.
+ */
+bool transEvaluate(trans_func_t *func, int M, int N, uint8_t setBits,
+        uint8_t associativity, uint8_t blockBits, cachePolicy_t policy) {
+    static int reference[TRANS_MAX_DIM * TRANS_MAX_DIM];
+    Cache cache;
+    int *A, *B;
+    bool traced;
+
+    if (M < 1 || N < 1 || M > TRANS_MAX_DIM || N > TRANS_MAX_DIM)
+        return false;
+    if (tracer.matrices == NULL) {
+        tracer.page = sysconf(_SC_PAGESIZE);
+        tracer.matrices = mmap(NULL, 2 * TRANS_MATRIX_BYTES,
+                PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (tracer.matrices == MAP_FAILED) {
+            tracer.matrices = NULL;
+            perror("Error mapping matrices");
+            return false;
+        }
+    }
+    if (!cacheCreate(&cache, setBits, associativity, blockBits, policy))
+        return false;
+
+    A = (int *) tracer.matrices;
+    B = (int *) (tracer.matrices + TRANS_MATRIX_BYTES);
+    memset(B, 0, TRANS_MATRIX_BYTES);
+    initMatrix(M, N, (int (*)[M]) A, (int (*)[N]) B);
+    correctTrans(M, N, (int (*)[M]) A, (int (*)[N]) reference);
+
+    tracer.cache = &cache;
+    traced = transTrace(func, M, N, A, B);
+    tracer.cache = NULL;
+
+    func->correct = memcmp(B, reference, (size_t) M * N * sizeof(int)) == 0;
+    func->num_hits = cache.hits;
+    func->num_misses = cache.misses;
+    func->num_evictions = cache.evictions;
+    freeCacheTags(&cache);
+    return traced;
+}
+
+/**
+ * Parses the value of a -s, -E or -b option.
+ */
+bool transParseGeometry(const char *program, int option, const char *text,
+        uint8_t *setBits, uint8_t *associativity, uint8_t *blockBits) {
+    long min = option == 'E', max, value;
+    uint8_t *field;
+    char *end;
+
+    if (option == 's') {
+        max = CACHE_MAX_SET_BITS;
+        field = setBits;
+    } else if (option == 'E') {
+        max = CACHE_MAX_WAYS;
+        field = associativity;
+    } else {
+        max = 63;
+        field = blockBits;
+    }
+    errno = 0;
+    value = strtol(text, &end, 10);
+    if (end == text || *end != '\0' || errno != 0 || value < min
+            || value > max) {
+        fprintf(stderr, "%s: -%c takes %ld-%ld, not %s\n", program, option,
+                min, max, text);
+        return false;
+    }
+    *field = value;
+    return true;
+}
+
+/**
+ * Checks that s + b is below 64.
+ */
+bool transCheckGeometry(const char *program, uint8_t setBits,
+        uint8_t blockBits) {
+    if (setBits + blockBits < 64)
+        return true;
+    fprintf(stderr, "%s: s + b must be below 64\n", program);
+    return false;
+}
+
+/**
+ * Parses a list of MxN sizes.
+ */
+size_t transParseSizes(const char *text, int *columns, int *rows,
+        size_t limit) {
+    size_t count = 0;
+    char *end;
+
+    while (count < limit) {
+        columns[count] = strtol(text, &end, 10);
+        if (end == text || (*end != 'x' && *end != 'X'))
+            return 0;
+        text = end + 1;
+        rows[count] = strtol(text, &end, 10);
+        if (end == text || columns[count] < 1 || rows[count] < 1)
+            return 0;
+        count++;
+        if (*end == '\0')
+            return count;
+        if (*end != ',')
+            return 0;
+        text = end + 1;
+    }
+    return 0;
+}
@@ -0,0 +1,103 @@
+/*
+ * File:   transeval.h
+ * Author: Nathan Hernandez,
+ *         Alyssa Tyler
+ *
+ * LoginID: hernandeznp,
+ *          tylerae
+ *
+ * In-process evaluation of registered transpose functions against the
+ * cache model, without valgrind.
+ * <p>
+ * A and B live on their own pages, which are protected while the function
+ * runs. Every access to them faults; the fault handler feeds the address
+ * (rebased to where tracegen's static int A[256][256], B[256][256] sit)
+ * straight into the cache, unprotects the page and single-steps the
+ * instruction, and the trap that follows protects the page again. Only
+ * accesses to A and B are counted, as locals are expected to live in
+ * registers, and an access counts once at the first byte it touches.
+ * <p>
+ * Tracing needs x86-64 Linux, for the trap flag.
+ */
+
+#ifndef TRANSEVAL_H
+#define TRANSEVAL_H
+
+#include <stdbool.h>
+#include "cache.h"
+#include "cachelab.h"
+
+/**
+ * Largest matrix dimension, as in tracegen.
+ */
+#define TRANS_MAX_DIM 256
+
+/**
+ * Largest number of sizes in a size list.
+ */
+#define TRANS_MAX_SIZES 32
+
+/**
+ * Simulated address of A[0][0]; B follows A as in tracegen.
+ */
+#define TRANS_SIM_BASE 0x10d080
+
+/**
+ * Runs a transpose function on an N x M matrix, checks it against
+ * correctTrans() and fills in func->correct, num_hits, num_misses and
+ * num_evictions for a cold cache of the given geometry. M and N must be
+ * 1-TRANS_MAX_DIM.
+ *
+ * @param func the function to evaluate
+ * @param M number of columns of A
+ * @param N number of rows of A
+ * @param setBits number of set index bits
+ * @param associativity number of lines per set
+ * @param blockBits number of block offset bits
+ * @param policy replacement policy
+ * @return true if the function was traced
+ */
+bool transEvaluate(trans_func_t *func, int M, int N, uint8_t setBits,
+        uint8_t associativity, uint8_t blockBits, cachePolicy_t policy);
+
+/**
+ * Parses the value of a -s, -E or -b command-line option into the matching
+ * geometry field, range-checking it before it is narrowed to uint8_t.
+ *
+ * @param program name of the program, for the error message
+ * @param option 's', 'E' or 'b'
+ * @param text the value
+ * @param setBits receives s, 0-CACHE_MAX_SET_BITS, for -s
+ * @param associativity receives E, 1-CACHE_MAX_WAYS, for -E
+ * @param blockBits receives b, 0-63, for -b
+ * @return true if the value is valid
+ */
+bool transParseGeometry(const char *program, int option, const char *text,
+        uint8_t *setBits, uint8_t *associativity, uint8_t *blockBits);
+
+/**
+ * Checks that s + b of a parsed geometry is below 64.
+ *
+ * @param program name of the program, for the error message
+ * @param setBits number of set index bits
+ * @param blockBits number of block offset bits
+ * @return true if the geometry can be simulated
+ */
+bool transCheckGeometry(const char *program, uint8_t setBits,
+        uint8_t blockBits);
+
+/**
+ * Parses a comma separated list of MxN sizes, e.g. "32x32,61x67". Sizes
+ * above TRANS_MAX_DIM are accepted for timing, but transEvaluate() rejects
+ * them, so callers that evaluate must check the sizes themselves.
+ *
+ * @param text the list
+ * @param columns where the M of every size is stored
+ * @param rows where the N of every size is stored
+ * @param limit largest number of sizes
+ * @return the number of sizes, or 0 on error
+ */
+size_t transParseSizes(const char *text, int *columns, int *rows,
+        size_t limit);
+
+#endif  /* TRANSEVAL_H */
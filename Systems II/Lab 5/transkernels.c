@@ -0,0 +1,271 @@
+/*
+ * File:   transkernels.c
+ * Author: Nathan Hernandez,
+ *         Alyssa Tyler
+ *
+ * LoginID: hernandeznp,
+ *          tylerae
+ *
+ * Transpose kernel library. See transkernels.h.
+ */
+
+/**
+ * Includes
+ */
+#include "transkernels.h"
+#include <stdint.h>
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+/**
+ * Side of the tiles of the vector kernels, in elements.
+ */
+#define TRANS_TILE 32
+
+/**
+ * Largest side of a leaf of the recursive kernel.
+ */
+#define TRANS_LEAF 16
+
+/**
+ * All kernels.
+ */
+const transKernel_t transKernels[] = {
+    { "naive", transNaive },
+    { "blocked", transBlocked },
+    { "recursive", transRecursive },
+    { "sse4x4", transSse4x4 },
+    { "avx8x8", transAvx8x8 },
+    { "stream", transStream }
+};
+const size_t transKernelCount = sizeof(transKernels) / sizeof(transKernels[0]);
+
+/**
+ * Transposes rows [row, rowEnd) and columns [column, columnEnd) of A.
+ */
+static inline void transScalar(int M, int N, int A[N][M], int B[M][N],
+        int row, int rowEnd, int column, int columnEnd) {
+    int i, j;
+
+    for (i = row; i < rowEnd; i++)
+        for (j = column; j < columnEnd; j++)
+            B[j][i] = A[i][j];
+}
+
+/**
+ * Row by row.
+ */
+void transNaive(int M, int N, int A[N][M], int B[M][N]) {
+    transScalar(M, N, A, B, 0, N, 0, M);
+}
+
+/**
+ * 8x8 scalar tiles.
+ */
+void transBlocked(int M, int N, int A[N][M], int B[M][N]) {
+    int row, column;
+
+    for (row = 0; row < N; row += 8)
+        for (column = 0; column < M; column += 8)
+            transScalar(M, N, A, B, row, row + 8 < N ? row + 8 : N,
+                    column, column + 8 < M ? column + 8 : M);
+}
+
+/**
+ * Transposes a rows x columns block by halving its longer side.
+ */
+static void transRecurse(int M, int N, int A[N][M], int B[M][N],
+        int row, int rows, int column, int columns) {
+    if (rows <= TRANS_LEAF && columns <= TRANS_LEAF) {
+        transScalar(M, N, A, B, row, row + rows, column, column + columns);
+    } else if (rows >= columns) {
+        transRecurse(M, N, A, B, row, rows / 2, column, columns);
+        transRecurse(M, N, A, B, row + rows / 2, rows - rows / 2, column,
+                columns);
+    } else {
+        transRecurse(M, N, A, B, row, rows, column, columns / 2);
+        transRecurse(M, N, A, B, row, rows, column + columns / 2,
+                columns - columns / 2);
+    }
+}
+
+/**
+ * Cache-oblivious recursion.
+ */
+void transRecursive(int M, int N, int A[N][M], int B[M][N]) {
+    transRecurse(M, N, A, B, 0, N, 0, M);
+}
+
+#if defined(__SSE2__)
+
+/**
+ * Transposes the 4x4 tile at A[row][column] in registers: c[k] is column
+ * column + k of the tile.
+ */
+static inline void transLoad4x4(int M, int N, int A[N][M], int row,
+        int column, __m128i c[4]) {
+    __m128i r0 = _mm_loadu_si128((const __m128i *) &A[row][column]);
+    __m128i r1 = _mm_loadu_si128((const __m128i *) &A[row + 1][column]);
+    __m128i r2 = _mm_loadu_si128((const __m128i *) &A[row + 2][column]);
+    __m128i r3 = _mm_loadu_si128((const __m128i *) &A[row + 3][column]);
+    __m128i t0 = _mm_unpacklo_epi32(r0, r1);
+    __m128i t1 = _mm_unpacklo_epi32(r2, r3);
+    __m128i t2 = _mm_unpackhi_epi32(r0, r1);
+    __m128i t3 = _mm_unpackhi_epi32(r2, r3);
+
+    (void) N;
+    c[0] = _mm_unpacklo_epi64(t0, t1);
+    c[1] = _mm_unpackhi_epi64(t0, t1);
+    c[2] = _mm_unpacklo_epi64(t2, t3);
+    c[3] = _mm_unpackhi_epi64(t2, t3);
+}
+
+/**
+ * 4x4 SSE tiles.
+ */
+void transSse4x4(int M, int N, int A[N][M], int B[M][N]) {
+    int row, column, i, j, k, rowEnd, columnEnd, fullRows, fullColumns;
+    __m128i c[4];
+
+    for (row = 0; row < N; row += TRANS_TILE)
+    for (column = 0; column < M; column += TRANS_TILE) {
+        rowEnd = row + TRANS_TILE < N ? row + TRANS_TILE : N;
+        columnEnd = column + TRANS_TILE < M ? column + TRANS_TILE : M;
+        fullRows = row + (rowEnd - row) / 4 * 4;
+        fullColumns = column + (columnEnd - column) / 4 * 4;
+        for (i = row; i < fullRows; i += 4)
+            for (j = column; j < fullColumns; j += 4) {
+                transLoad4x4(M, N, A, i, j, c);
+                for (k = 0; k < 4; k++)
+                    _mm_storeu_si128((__m128i *) &B[j + k][i], c[k]);
+            }
+        transScalar(M, N, A, B, row, fullRows, fullColumns, columnEnd);
+        transScalar(M, N, A, B, fullRows, rowEnd, column, columnEnd);
+    }
+}
+
+/**
+ * Non-temporal stores. Strips of 16 rows x 4 columns are transposed in
+ * registers and every row of B gets its 64 bytes in consecutive stores,
+ * so the write-combining buffers fill whole lines. B rows must be 16 byte
+ * aligned; otherwise this is sse4x4.
+ */
+void transStream(int M, int N, int A[N][M], int B[M][N]) {
+    int row, column, i, j, k, l, t, rowEnd, columnEnd, fullRows,
+            fullColumns;
+    __m128i c[4][4];
+
+    if ((uintptr_t) B % 16 != 0 || N % 4 != 0) {
+        transSse4x4(M, N, A, B);
+        return;
+    }
+    for (row = 0; row < N; row += TRANS_TILE)
+    for (column = 0; column < M; column += TRANS_TILE) {
+        rowEnd = row + TRANS_TILE < N ? row + TRANS_TILE : N;
+        columnEnd = column + TRANS_TILE < M ? column + TRANS_TILE : M;
+        fullRows = row + (rowEnd - row) / 4 * 4;
+        fullColumns = column + (columnEnd - column) / 4 * 4;
+        for (j = column; j < fullColumns; j += 4)
+            for (i = row; i < fullRows; i += 4 * t) {
+                for (t = 0; t < 4 && i + 4 * t < fullRows; t++)
+                    transLoad4x4(M, N, A, i + 4 * t, j, c[t]);
+                for (k = 0; k < 4; k++)
+                    for (l = 0; l < t; l++)
+                        _mm_stream_si128((__m128i *) &B[j + k][i + 4 * l],
+                                c[l][k]);
+            }
+        transScalar(M, N, A, B, row, fullRows, fullColumns, columnEnd);
+        transScalar(M, N, A, B, fullRows, rowEnd, column, columnEnd);
+    }
+    _mm_sfence();
+}
+
+#else
+
+/**
+ * Without SSE2: 8x8 scalar tiles.
+ */
+void transSse4x4(int M, int N, int A[N][M], int B[M][N]) {
+    transBlocked(M, N, A, B);
+}
+
+/**
+ * Without SSE2: 8x8 scalar tiles.
+ */
+void transStream(int M, int N, int A[N][M], int B[M][N]) {
+    transBlocked(M, N, A, B);
+}
+
+#endif
+
+#if defined(__AVX2__)
+
+/**
+ * Transposes the 8x8 tile at A[row][column] in registers.
+ */
+static inline void transTile8x8(int M, int N, int A[N][M], int B[M][N],
+        int row, int column) {
+    __m256i r[8], t[8], u[8];
+    int k;
+
+    for (k = 0; k < 8; k++)
+        r[k] = _mm256_loadu_si256((const __m256i *) &A[row + k][column]);
+    for (k = 0; k < 8; k += 2) {
+        t[k] = _mm256_unpacklo_epi32(r[k], r[k + 1]);
+        t[k + 1] = _mm256_unpackhi_epi32(r[k], r[k + 1]);
+    }
+    for (k = 0; k < 8; k += 4) {
+        u[k] = _mm256_unpacklo_epi64(t[k], t[k + 2]);
+        u[k + 1] = _mm256_unpackhi_epi64(t[k], t[k + 2]);
+        u[k + 2] = _mm256_unpacklo_epi64(t[k + 1], t[k + 3]);
+        u[k + 3] = _mm256_unpackhi_epi64(t[k + 1], t[k + 3]);
+    }
+    for (k = 0; k < 4; k++) {
+        _mm256_storeu_si256((__m256i *) &B[column + k][row],
+                _mm256_permute2x128_si256(u[k], u[k + 4], 0x20));
+        _mm256_storeu_si256((__m256i *) &B[column + k + 4][row],
+                _mm256_permute2x128_si256(u[k], u[k + 4], 0x31));
+    }
+}
+
+/**
+ * 8x8 AVX2 tiles.
+ */
+void transAvx8x8(int M, int N, int A[N][M], int B[M][N]) {
+    int row, column, i, j, rowEnd, columnEnd, fullRows, fullColumns;
+
+    for (row = 0; row < N; row += TRANS_TILE)
+    for (column = 0; column < M; column += TRANS_TILE) {
+        rowEnd = row + TRANS_TILE < N ? row + TRANS_TILE : N;
+        columnEnd = column + TRANS_TILE < M ? column + TRANS_TILE : M;
+        fullRows = row + (rowEnd - row) / 8 * 8;
+        fullColumns = column + (columnEnd - column) / 8 * 8;
+        for (i = row; i < fullRows; i += 8)
+            for (j = column; j < fullColumns; j += 8)
+                transTile8x8(M, N, A, B, i, j);
+        transScalar(M, N, A, B, row, fullRows, fullColumns, columnEnd);
+        transScalar(M, N, A, B, fullRows, rowEnd, column, columnEnd);
+    }
+}
+
+#else
+
+/**
+ * Without AVX2: 4x4 SSE tiles.
+ */
+void transAvx8x8(int M, int N, int A[N][M], int B[M][N]) {
+    transSse4x4(M, N, A, B);
+}
+
+#endif
+
+/**
+ * Registers every kernel.
+ */
+void transRegisterKernels(void) {
+    size_t i;
+
+    for (i = 0; i < transKernelCount; i++)
+        registerTransFunction(transKernels[i].func_ptr, transKernels[i].name);
+}
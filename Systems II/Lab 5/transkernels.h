@@ -0,0 +1,59 @@
+/*
+ * File:   transkernels.h
+ * Author: Nathan Hernandez,
+ *         Alyssa Tyler
+ *
+ * LoginID: hernandeznp,
+ *          tylerae
+ *
+ * Library of transpose kernels with the registerTransFunction() signature.
+ * <pre>
+ *   naive      row by row, the cachelab baseline
+ *   blocked    8x8 tiles, scalar
+ *   recursive  cache-oblivious: halves the longer side down to 16x16
+ *   sse4x4     4x4 tiles transposed in SSE registers
+ *   avx8x8     8x8 tiles transposed in AVX2 registers
+ *   stream     4x4 SSE tiles with non-temporal stores to B
+ * </pre>
+ * The vector kernels are chosen at compile time like cacheMatch(): avx8x8
+ * needs -mavx2 and falls back to sse4x4, and sse4x4 and stream fall back
+ * to blocked without SSE2. Edges that do not fill a tile are done scalar.
+ */
+
+#ifndef TRANSKERNELS_H
+#define TRANSKERNELS_H
+
+#include <stddef.h>
+#include "cachelab.h"
+
+/**
+ * A transpose kernel.
+ */
+typedef struct transKernel_t {
+    char *name;
+    void (*func_ptr)(int M, int N, int A[N][M], int B[M][N]);
+} transKernel_t;
+
+/**
+ * All kernels, naive first.
+ */
+extern const transKernel_t transKernels[];
+
+/**
+ * Number of kernels in transKernels.
+ */
+extern const size_t transKernelCount;
+
+void transNaive(int M, int N, int A[N][M], int B[M][N]);
+void transBlocked(int M, int N, int A[N][M], int B[M][N]);
+void transRecursive(int M, int N, int A[N][M], int B[M][N]);
+void transSse4x4(int M, int N, int A[N][M], int B[M][N]);
+void transAvx8x8(int M, int N, int A[N][M], int B[M][N]);
+void transStream(int M, int N, int A[N][M], int B[M][N]);
+
+/**
+ * Registers every kernel with registerTransFunction().
+ */
+void transRegisterKernels(void);
+
+#endif  /* TRANSKERNELS_H */
@@ -0,0 +1,223 @@
+/*
+ * File:   transtune.c
+ * Author: Nathan Hernandez,
+ *         Alyssa Tyler
+ *
+ * LoginID: hernandeznp,
+ *          tylerae
+ *
+ * Blocked transpose auto-tuner. See transtune.h.
+ */
+
+/**
+ * Includes
+ */
+#include "transtune.h"
+#include <stdio.h>
+
+/**
+ * Tile sizes searched for both tile dimensions.
+ */
+static const uint16_t tileSizes[] = { 4, 8, 16, 32 };
+
+/**
+ * Register-blocking depths searched; each has its own unrolled kernel.
+ */
+static const uint8_t depths[] = { 1, 2, 4, 8 };
+
+/**
+ * Diagonal handling names indexed by transDiagonal_t.
+ */
+static const char *diagonalNames[TRANS_DIAGONALS] = {
+    [TRANS_DIAGONAL_NONE] = "plain",
+    [TRANS_DIAGONAL_DEFER] = "defer"
+};
+
+/**
+ * Variant used for untuned shapes: 8x8 tiles, deferred diagonal.
+ */
+static transVariant_t current = { 8, 8, TRANS_DIAGONAL_DEFER, 1, 0, 0, 0 };
+
+/**
+ * Best variant of every tuned shape.
+ */
+static struct {
+    int M;
+    int N;
+    transVariant_t variant;
+} tuned[TRANS_TUNE_SHAPES];
+static size_t tunedCount;
+
+/**
+ * Whether transTune() is running, when current is always used.
+ */
+static bool tuning;
+
+/**
+ * Returns the variant for a shape.
+ */
+static const transVariant_t *transVariantFor(int M, int N) {
+    size_t i;
+
+    for (i = 0; !tuning && i < tunedCount; i++)
+        if (tuned[i].M == M && tuned[i].N == N)
+            return &tuned[i].variant;
+    return &current;
+}
+
+/**
+ * Loads element k of a group into the scalar local v<k>.
+ */
+#define TRANS_LOAD(k) int v##k = A[i][j + k];
+
+/**
+ * Stores v<k> to B, or holds it back if it is on the diagonal.
+ */
+#define TRANS_STORE(k) \
+    if (defer && j + k == i) { \
+        diagonal = v##k; \
+        held = true; \
+    } else { \
+        B[j + k][i] = v##k; \
+    }
+
+/**
+ * Expands step for every element of a group of 1, 2, 4 or 8.
+ */
+#define TRANS_GROUP1(step) step(0)
+#define TRANS_GROUP2(step) TRANS_GROUP1(step) step(1)
+#define TRANS_GROUP4(step) TRANS_GROUP2(step) step(2) step(3)
+#define TRANS_GROUP8(step) TRANS_GROUP4(step) step(4) step(5) step(6) step(7)
+
+/**
+ * Defines transBlocked<depth>(), the blocked kernel with its groups
+ * unrolled into depth scalar locals. The elements of a tile row left over
+ * after its last whole group are copied one at a time.
+ */
+#define TRANS_BLOCKED(depth) \
+static void transBlocked##depth(const transVariant_t *variant, int M, \
+        int N, int A[N][M], int B[M][N]) { \
+    int row, column, i, j, rowEnd, columnEnd, diagonal, value; \
+    bool defer = variant->diagonal == TRANS_DIAGONAL_DEFER, held; \
+\
+    for (row = 0; row < N; row += variant->blockRows) \
+    for (column = 0; column < M; column += variant->blockColumns) { \
+        rowEnd = row + variant->blockRows < N \
+                ? row + variant->blockRows : N; \
+        columnEnd = column + variant->blockColumns < M \
+                ? column + variant->blockColumns : M; \
+        for (i = row; i < rowEnd; i++) { \
+            held = false; \
+            diagonal = 0; \
+            for (j = column; j + depth <= columnEnd; j += depth) { \
+                TRANS_GROUP##depth(TRANS_LOAD) \
+                TRANS_GROUP##depth(TRANS_STORE) \
+            } \
+            for (; j < columnEnd; j++) { \
+                value = A[i][j]; \
+                if (defer && j == i) { \
+                    diagonal = value; \
+                    held = true; \
+                } else { \
+                    B[j][i] = value; \
+                } \
+            } \
+            if (held) \
+                B[i][i] = diagonal; \
+        } \
+    } \
+}
+
+TRANS_BLOCKED(1)
+TRANS_BLOCKED(2)
+TRANS_BLOCKED(4)
+TRANS_BLOCKED(8)
+
+/**
+ * The blocked transpose kernel; picks the unrolled kernel of the depth.
+ */
+void transTuned(int M, int N, int A[N][M], int B[M][N]) {
+    const transVariant_t *variant = transVariantFor(M, N);
+
+    if (variant->depth >= 8)
+        transBlocked8(variant, M, N, A, B);
+    else if (variant->depth >= 4)
+        transBlocked4(variant, M, N, A, B);
+    else if (variant->depth >= 2)
+        transBlocked2(variant, M, N, A, B);
+    else
+        transBlocked1(variant, M, N, A, B);
+}
+
+/**
+ * Sets the variant used for untuned shapes.
+ */
+void transVariantUse(const transVariant_t *variant) {
+    current = *variant;
+}
+
+/**
+ * Describes a variant.
+ */
+void transVariantName(const transVariant_t *variant, char *buffer,
+        size_t size) {
+    snprintf(buffer, size, "%ux%u %s depth %u", variant->blockRows,
+            variant->blockColumns, diagonalNames[variant->diagonal],
+            variant->depth);
+}
+
+/**
+ * Scores every variant on a shape and keeps the best.
+ */
+bool transTune(int M, int N, uint8_t setBits, uint8_t associativity,
+        uint8_t blockBits, cachePolicy_t policy, transTuneReport_t report,
+        transVariant_t *best) {
+    char description[64];
+    trans_func_t func = { transTuned, description, 0, 0, 0, 0 };
+    transVariant_t saved = current, variant;
+    size_t r, c, d, i;
+    bool found = false;
+
+    tuning = true;
+    for (r = 0; r < sizeof(tileSizes) / sizeof(tileSizes[0]); r++)
+    for (c = 0; c < sizeof(tileSizes) / sizeof(tileSizes[0]); c++)
+    for (d = 0; d < TRANS_DIAGONALS; d++)
+    for (i = 0; i < sizeof(depths) / sizeof(depths[0]); i++) {
+        if (depths[i] > tileSizes[c])
+            continue;
+        variant = (transVariant_t) { tileSizes[r], tileSizes[c], d,
+                depths[i], 0, 0, 0 };
+        transVariantName(&variant, description, sizeof(description));
+
+        // A variant that cannot be traced or transposes wrongly is skipped.
+        current = variant;
+        if (!transEvaluate(&func, M, N, setBits, associativity, blockBits,
+                policy) || !func.correct)
+            continue;
+        variant.hits = func.num_hits;
+        variant.misses = func.num_misses;
+        variant.evictions = func.num_evictions;
+        if (report != NULL)
+            report(&variant);
+        if (!found || variant.misses < best->misses) {
+            *best = variant;
+            found = true;
+        }
+    }
+    current = saved;
+    tuning = false;
+    if (!found)
+        return false;
+
+    for (i = 0; i < tunedCount; i++)
+        if (tuned[i].M == M && tuned[i].N == N)
+            break;
+    if (i == TRANS_TUNE_SHAPES)
+        return true;
+    if (i == tunedCount)
+        tunedCount++;
+    tuned[i].M = M;
+    tuned[i].N = N;
+    tuned[i].variant = *best;
+    return true;
+}
@@ -0,0 +1,112 @@
+/*
+ * File:   transtune.h
+ * Author: Nathan Hernandez,
+ *         Alyssa Tyler
+ *
+ * LoginID: hernandeznp,
+ *          tylerae
+ *
+ * Auto-tuner for blocked transpose kernels.
+ * <p>
+ * Every variant runs the same blocked kernel, transTuned(), which walks A
+ * in blockRows x blockColumns tiles and copies each tile row in groups of
+ * depth elements: depth loads from A into scalar locals, then depth stores
+ * to B. Each depth (1, 2, 4 or 8) has its own unrolled copy of the kernel,
+ * picked once per call, so the locals can live in registers; the elements
+ * left over after the last whole group of a tile row are copied one at a
+ * time.
+ * With TRANS_DIAGONAL_DEFER, the element on the diagonal is held back and
+ * stored after the rest of its row, so A and B do not evict each other on
+ * diagonal tiles.
+ * <p>
+ * transTune() scores every variant with transEvaluate() for one shape and
+ * cache, skipping variants that cannot be traced or are not correct, and
+ * remembers the correct variant with the fewest misses. Once
+ * tuned, transTuned() can be registered like any transpose function and
+ * picks the remembered variant for the shape it is called with.
+ */
+
+#ifndef TRANSTUNE_H
+#define TRANSTUNE_H
+
+#include "transeval.h"
+
+/**
+ * Largest register-blocking depth (scalar locals used per group).
+ */
+#define TRANS_MAX_DEPTH 8
+
+/**
+ * Number of shapes whose best variant is remembered.
+ */
+#define TRANS_TUNE_SHAPES 32
+
+/**
+ * Diagonal handling.
+ */
+typedef enum transDiagonal_t {
+    TRANS_DIAGONAL_NONE,
+    TRANS_DIAGONAL_DEFER,
+    TRANS_DIAGONALS
+} transDiagonal_t;
+
+/**
+ * One variant of the blocked kernel and its score.
+ */
+typedef struct transVariant_t {
+    uint16_t blockRows;
+    uint16_t blockColumns;
+    transDiagonal_t diagonal;
+    uint8_t depth;
+    uint32_t hits;
+    uint32_t misses;
+    uint32_t evictions;
+} transVariant_t;
+
+/**
+ * Called for every variant scored by transTune().
+ */
+typedef void (*transTuneReport_t)(const transVariant_t *variant);
+
+/**
+ * The blocked transpose kernel. It uses the variant transTune() kept for
+ * the shape, or the one last set with transVariantUse().
+ */
+void transTuned(int M, int N, int A[N][M], int B[M][N]);
+
+/**
+ * Sets the variant transTuned() uses for shapes that were not tuned.
+ *
+ * @param variant the variant to use
+ */
+void transVariantUse(const transVariant_t *variant);
+
+/**
+ * Describes a variant, e.g. "8x8 defer depth 4".
+ *
+ * @param variant the variant
+ * @param buffer where the description is written
+ * @param size size of buffer
+ */
+void transVariantName(const transVariant_t *variant, char *buffer,
+        size_t size);
+
+/**
+ * Scores every variant on an N x M matrix and keeps the best for the
+ * shape.
+ *
+ * @param M number of columns of A
+ * @param N number of rows of A
+ * @param setBits number of set index bits
+ * @param associativity number of lines per set
+ * @param blockBits number of block offset bits
+ * @param policy replacement policy
+ * @param report called with every scored variant, or NULL
+ * @param best where the best variant is stored
+ * @return true if a correct variant was found
+ */
+bool transTune(int M, int N, uint8_t setBits, uint8_t associativity,
+        uint8_t blockBits, cachePolicy_t policy, transTuneReport_t report,
+        transVariant_t *best);
+
+#endif  /* TRANSTUNE_H */